@@ -74,6 +74,10 @@
 
 #include "Copter.h"
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#include <AP_HAL_Linux/Scheduler.h>
+#endif
+
 #define SCHED_TASK(func, rate_hz, max_time_micros) SCHED_TASK_CLASS(Copter, &copter, func, rate_hz, max_time_micros)
 
 /*
@@ -197,15 +201,63 @@ void Copter::barometer_accumulate(void)
 
 void Copter::perf_update(void)
 {
-    if (should_log(MASK_LOG_PM))
+    LatencyHistogram latency_now, latency;
+    motors->get_output_latency(latency_now);
+    latency.delta(latency_now, output_latency);
+    output_latency = latency_now;
+
+    if (should_log(MASK_LOG_PM)) {
         Log_Write_Performance();
+        Log_Write_Latency(latency);
+        // let the GCS plot the latency without enabling SCHED_DEBUG
+        GCS_MAVLINK::send_named_value_int_all("LAT_AVG", latency.average_us());
+        GCS_MAVLINK::send_named_value_int_all("LAT_MAX", latency.max_us);
+    }
     if (scheduler.debug()) {
         gcs_send_text_fmt(MAV_SEVERITY_WARNING, "PERF: %u/%u %lu %lu\n",
                           (unsigned)perf_info_get_num_long_running(),
                           (unsigned)perf_info_get_num_loops(),
                           (unsigned long)perf_info_get_max_time(),
                           (unsigned long)perf_info_get_min_time());
+        gcs_send_text_fmt(MAV_SEVERITY_WARNING, "LAT: %lu %lu %lu %lu/%lu/%lu/%lu/%lu/%lu/%lu/%lu\n",
+                          (unsigned long)latency.count,
+                          (unsigned long)latency.average_us(),
+                          (unsigned long)latency.max_us,
+                          (unsigned long)latency.bins[0],
+                          (unsigned long)latency.bins[1],
+                          (unsigned long)latency.bins[2],
+                          (unsigned long)latency.bins[3],
+                          (unsigned long)latency.bins[4],
+                          (unsigned long)latency.bins[5],
+                          (unsigned long)latency.bins[6],
+                          (unsigned long)latency.bins[7]);
+    }
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+    // wakeup latency of the periodic HAL threads
+    const char *name;
+    Linux::PeriodicThread::Stats stats;
+    for (uint8_t i = 0; Linux::Scheduler::from(hal.scheduler)->get_thread_stats(i, name, stats); i++) {
+        if (name[0] == '\0') {
+            continue;
+        }
+        if (should_log(MASK_LOG_PM)) {
+            Log_Write_Thread(name, stats.count, stats.overruns, stats.max_latency_usec, stats.avg_latency_usec);
+            // thread names are "ap-<name>", only the <name> fits the message
+            const char *short_name = strncmp(name, "ap-", 3) == 0 ? name + 3 : name;
+            GCS_MAVLINK::send_named_value_int_all(short_name, stats.max_latency_usec);
+        }
+        if (scheduler.debug()) {
+            gcs_send_text_fmt(MAV_SEVERITY_WARNING, "THRD: %s %lu %lu %lu %.0f\n",
+                              name,
+                              (unsigned long)stats.count,
+                              (unsigned long)stats.overruns,
+                              (unsigned long)stats.max_latency_usec,
+                              (double)stats.avg_latency_usec);
+        }
     }
+#endif
+
     perf_info_reset();
     pmTest1 = 0;
 }
@@ -260,16 +312,41 @@ void Copter::fast_loop()
     // --------------------
     read_AHRS();
 
+    // the rate controllers and the motors are shared with the rate thread
+    rate_thread_lock();
+
     // run low level rate controllers that only require IMU data
+#if RATE_THREAD == ENABLED
+    // run them here too if the rate thread stopped sending the outputs
+    rate_thread_driving = rate_thread_active && rate_thread_check_output();
+    if (rate_thread_driving) {
+        // the rate thread runs them, only update the throttle mix here
+        static_cast<AC_AttitudeControl_Multi *>(attitude_control)->rate_controller_update();
+    } else {
+        attitude_control->rate_controller_run();
+    }
+#else
     attitude_control->rate_controller_run();
+#endif
     
 #if FRAME_CONFIG == HELI_FRAME
     update_heli_control_dynamics();
 #endif //HELI_FRAME
 
+    // the outputs are computed from the gyro sample read by ins.update()
+#if RATE_THREAD == ENABLED
+    if (!rate_thread_driving) {
+        motors->set_input_sample_us(ins.get_gyro_sample_us());
+    }
+#else
+    motors->set_input_sample_us(ins.get_gyro_sample_us());
+#endif
+
     // send outputs to the motors library
     motors_output();
 
+    rate_thread_unlock();
+
     // Inertial Nav
     // --------------------
     read_inertia();
@@ -277,15 +354,22 @@ void Copter::fast_loop()
     // check if ekf has reset target heading or position
     check_ekf_reset();
 
+    rate_thread_lock();
+
     // run the attitude controllers
     update_flight_mode();
 
+    // hand the new rate targets over to the rate thread
+    rate_thread_post_targets();
+
     // update home from EKF if necessary
     update_home_from_EKF();
 
     // check if we've landed or crashed
     update_land_and_crash_detectors();
 
+    rate_thread_unlock();
+
 #if MOUNT == ENABLED
     // camera mount's fast update
     camera_mount.update_fast();
@@ -490,6 +574,8 @@ void Copter::one_hz_loop()
 
         update_using_interlock();
 
+        rate_thread_lock();
+
         // check the user hasn't updated the frame class or type
         motors->set_frame_class_and_type((AP_Motors::motor_frame_class)g2.frame_class.get(), (AP_Motors::motor_frame_type)g.frame_type.get());
 
@@ -497,6 +583,8 @@ void Copter::one_hz_loop()
         // set all throttle channel settings
         motors->set_throttle_range(channel_throttle->get_radio_min(), channel_throttle->get_radio_max());
 #endif
+
+        rate_thread_unlock();
     }
 
     // update assigned functions and enable auxiliary servos
@@ -496,6 +496,8 @@ private:
 
     // Performance monitoring
     int16_t pmTest1;
+    // latency from gyro samples to motor outputs at the previous perf_update()
+    LatencyHistogram output_latency;
 
     // System Timers
     // --------------
@@ -503,6 +505,12 @@ private:
     uint32_t fast_loopTimer;
     // Counter of main loop executions.  Used for performance monitoring and failsafe processing
     uint16_t mainLoop_count;
+#if RATE_THREAD == ENABLED
+    // true once the rate controllers and motor outputs run on the rate thread
+    bool rate_thread_active;
+    // true if the rate thread sent the motor outputs during the last loop
+    bool rate_thread_driving;
+#endif
     // Loiter timer - Records how long we have been in loiter
     uint32_t rtl_loiter_start_time;
     // arm_time_ms - Records when vehicle was armed. Will be Zero if we are disarmed.
@@ -726,6 +734,8 @@ private:
     void Log_Write_Throw(ThrowModeStage stage, float velocity, float velocity_z, float accel, float ef_accel_z, bool throw_detect, bool attitude_ok, bool height_ok, bool position_ok);
     void Log_Write_Proximity();
     void Log_Write_Beacon();
+    void Log_Write_Latency(const LatencyHistogram &latency);
+    void Log_Write_Thread(const char *name, uint32_t count, uint32_t overruns, uint32_t max_us, float avg_us);
     void Log_Write_Vehicle_Startup_Messages();
     void Log_Read(uint16_t log_num, uint16_t start_page, uint16_t end_page);
     void start_logging() ;
@@ -979,6 +989,16 @@ private:
     bool init_arm_motors(bool arming_from_gcs);
     void init_disarm_motors();
     void motors_output();
+    void rate_thread_lock();
+    void rate_thread_unlock();
+    void rate_thread_post_targets();
+#if RATE_THREAD == ENABLED
+    void rate_thread_init();
+    void rate_thread_gyro_sample(const Vector3f &gyro, uint64_t sample_us);
+    void rate_thread_update();
+    void rate_thread_set_pid_dt(float dt);
+    bool rate_thread_check_output();
+#endif
     void lost_vehicle_check();
     void run_nav_updates(void);
     void calc_distance_and_bearing();
@@ -1081,6 +1101,7 @@ private:
     bool do_guided(const AP_Mission::Mission_Command& cmd);
     void do_takeoff(const AP_Mission::Mission_Command& cmd);
     void do_nav_wp(const AP_Mission::Mission_Command& cmd);
+    void do_nav_wp_lookahead(const AP_Mission::Mission_Command& cmd);
     void do_land(const AP_Mission::Mission_Command& cmd);
     void do_loiter_unlimited(const AP_Mission::Mission_Command& cmd);
     void do_circle(const AP_Mission::Mission_Command& cmd);
@@ -850,6 +850,55 @@ void Copter::Log_Write_Beacon()
     DataFlash.WriteBlock(&pkt, sizeof(pkt));
 }
 
+struct PACKED log_Latency {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint32_t count;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t bins[LatencyHistogram::NUM_BINS];
+};
+
+// Write the histogram of the latency from the gyro samples to the motor outputs
+void Copter::Log_Write_Latency(const LatencyHistogram &latency)
+{
+    struct log_Latency pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_LATENCY_MSG),
+        time_us         : AP_HAL::micros64(),
+        count           : latency.count,
+        avg_us          : latency.average_us(),
+        max_us          : latency.max_us,
+    };
+    memcpy(pkt.bins, latency.bins, sizeof(pkt.bins));
+    DataFlash.WriteBlock(&pkt, sizeof(pkt));
+}
+
+struct PACKED log_Thread {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint32_t count;
+    uint32_t overruns;
+    uint32_t max_us;
+    float avg_us;
+};
+
+// Write the wakeup latency of a periodic HAL thread
+void Copter::Log_Write_Thread(const char *name, uint32_t count, uint32_t overruns, uint32_t max_us, float avg_us)
+{
+    struct log_Thread pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_THREAD_MSG),
+        time_us         : AP_HAL::micros64(),
+        name            : {},
+        count           : count,
+        overruns        : overruns,
+        max_us          : max_us,
+        avg_us          : avg_us,
+    };
+    strncpy(pkt.name, name, sizeof(pkt.name));
+    DataFlash.WriteBlock(&pkt, sizeof(pkt));
+}
+
 const struct LogStructure Copter::log_structure[] = {
     LOG_COMMON_STRUCTURES,
 #if AUTOTUNE_ENABLED == ENABLED
@@ -896,6 +945,10 @@ const struct LogStructure Copter::log_structure[] = {
       "PRX",   "QBffffffffff","TimeUS,Health,D0,D45,D90,D135,D180,D225,D270,D315,CAng,CDist" },
     { LOG_BEACON_MSG, sizeof(log_Beacon),
       "BCN",   "QBBfffffff",  "TimeUS,Health,Cnt,D0,D1,D2,D3,PosX,PosY,PosZ" },
+    { LOG_LATENCY_MSG, sizeof(log_Latency),
+      "LAT",   "QIIIIIIIIIII", "TimeUS,N,Avg,Max,B250,B500,B1k,B2k,B4k,B8k,B16k,BInf" },
+    { LOG_THREAD_MSG, sizeof(log_Thread),
+      "THRD",  "QNIIIf",      "TimeUS,Name,N,Ovr,Max,Avg" },
 };
 
 #if CLI_ENABLED == ENABLED
@@ -999,6 +1052,8 @@ void Copter::Log_Sensor_Health() {}
 void Copter::Log_Write_GuidedTarget(uint8_t target_type, const Vector3f& pos_target, const Vector3f& vel_target) {}
 void Copter::Log_Write_Proximity() {}
 void Copter::Log_Write_Beacon() {}
+void Copter::Log_Write_Latency(const LatencyHistogram &latency) {}
+void Copter::Log_Write_Thread(const char *name, uint32_t count, uint32_t overruns, uint32_t max_us, float avg_us) {}
 void Copter::Log_Write_Precland() {}
 void Copter::Log_Write_Throw(ThrowModeStage stage, float velocity, float velocity_z, float accel, float ef_accel_z, bool throw_detect, bool attitude_ok, bool height_ok, bool pos_ok) {}
 
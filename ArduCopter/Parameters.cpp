@@ -996,7 +996,19 @@ const AP_Param::GroupInfo ParametersG2::var_info[] = {
     // @Group: RC
     // @Path: ../libraries/RC_Channel/RC_Channel.cpp
     AP_SUBGROUPINFO(rc_channels, "RC", 17, ParametersG2, RC_Channels),
-    
+
+#if RATE_THREAD == ENABLED
+    // @Param: RATE_THREAD_HZ
+    // @DisplayName: Rate controller thread rate
+    // @Description: When non-zero the rate controllers and the motor outputs run on their own high priority thread, woken up by the primary gyro samples, at up to this rate instead of at the main loop rate. The flight modes, angle controllers and EKF keep running in the main loop. Requires a reboot to take effect. It should not be set above the gyro sample rate.
+    // @Units: Hz
+    // @Range: 0 2000
+    // @Values: 0:Disabled,1000:1kHz,2000:2kHz
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("RATE_THREAD_HZ", 18, ParametersG2, rate_thread_hz, 0),
+#endif
+
     AP_GROUPEND
 };
 
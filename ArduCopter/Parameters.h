@@ -564,6 +564,11 @@ public:
     
     // control over servo output ranges
     SRV_Channels servo_channels;
+
+#if RATE_THREAD == ENABLED
+    // rate of the rate controller thread, 0 to run it in the main loop
+    AP_Int16 rate_thread_hz;
+#endif
 };
 
 extern const AP_Param::Info        var_info[];
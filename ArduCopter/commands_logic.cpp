@@ -337,9 +337,43 @@ void Copter::do_nav_wp(const AP_Mission::Mission_Command& cmd)
     // if no delay set the waypoint as "fast"
     if (loiter_time_max == 0 ) {
         wp_nav->set_fast_waypoint(true);
+        do_nav_wp_lookahead(cmd);
     }
 }
 
+// do_nav_wp_lookahead - plan the speed through a fast waypoint from the waypoints following it in the mission
+void Copter::do_nav_wp_lookahead(const AP_Mission::Mission_Command& cmd)
+{
+    Location_Class next_destinations[WPNAV_LOOKAHEAD_MAX];
+    uint8_t num_destinations = 0;
+    bool stop_at_end = false;
+    AP_Mission::Mission_Command next_cmd;
+    uint16_t index = cmd.index + 1;
+
+    while (num_destinations < WPNAV_LOOKAHEAD_MAX) {
+        if (!mission.get_next_nav_cmd(index, next_cmd)) {
+            // end of the mission, the vehicle will stop at the last waypoint
+            stop_at_end = true;
+            break;
+        }
+        // only plain waypoints with a position known in advance can be planned through
+        if (next_cmd.id != MAV_CMD_NAV_WAYPOINT ||
+            (next_cmd.content.location.lat == 0 && next_cmd.content.location.lng == 0) ||
+            next_cmd.content.location.alt == 0) {
+            break;
+        }
+        next_destinations[num_destinations++] = next_cmd.content.location;
+        // the vehicle stops at waypoints with a delay
+        if (next_cmd.p1 != 0) {
+            stop_at_end = true;
+            break;
+        }
+        index = next_cmd.index + 1;
+    }
+
+    wp_nav->set_wp_lookahead(next_destinations, num_destinations, stop_at_end);
+}
+
 // terrain_adjusted_location: returns a Location with lat/lon from cmd
 // and altitude from our current altitude adjusted for location
 Location_Class Copter::terrain_adjusted_location(const AP_Mission::Mission_Command& cmd) const
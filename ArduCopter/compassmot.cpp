@@ -131,6 +131,10 @@ MAV_RESULT Copter::mavlink_compassmot(mavlink_channel_t chan)
         interference_pct[i] = 0.0f;
     }
 
+    // the throttle is passed through to the motors until they stop: keep
+    // the rate thread off them
+    rate_thread_lock();
+
     // enable motors and pass through throttle
     init_rc_out();
     enable_motor_output();
@@ -240,6 +244,8 @@ MAV_RESULT Copter::mavlink_compassmot(mavlink_channel_t chan)
     motors->output_min();
     motors->armed(false);
 
+    rate_thread_unlock();
+
     // set and save motor compensation
     if (updated) {
         compass.motor_compensation_type(comp_type);
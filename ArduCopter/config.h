@@ -127,6 +127,19 @@
  # define PROXIMITY_ENABLED ENABLED
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+// Rate controller thread
+//
+// run the rate controllers and motor outputs on their own thread, woken up
+// by the gyro samples. Only available for multicopters on Linux boards
+#ifndef RATE_THREAD
+ # if CONFIG_HAL_BOARD == HAL_BOARD_LINUX && FRAME_CONFIG != HELI_FRAME
+  # define RATE_THREAD ENABLED
+ # else
+  # define RATE_THREAD DISABLED
+ # endif
+#endif
+
 #ifndef MAV_SYSTEM_ID
  # define MAV_SYSTEM_ID          1
 #endif
@@ -318,6 +318,8 @@ enum DevOptions {
 #define LOG_THROW_MSG                   0x23
 #define LOG_PROXIMITY_MSG               0x24
 #define LOG_BEACON_MSG                  0x25
+#define LOG_LATENCY_MSG                 0x26
+#define LOG_THREAD_MSG                  0x27
 
 #define MASK_LOG_ATTITUDE_FAST          (1<<0)
 #define MASK_LOG_ATTITUDE_MED           (1<<1)
@@ -24,6 +24,9 @@ bool Copter::set_mode(control_mode_t mode, mode_reason_t reason)
         return true;
     }
 
+    // the mode init resets the controllers the rate thread runs
+    rate_thread_lock();
+
     switch (mode) {
         case ACRO:
             #if FRAME_CONFIG == HELI_FRAME
@@ -150,6 +153,8 @@ bool Copter::set_mode(control_mode_t mode, mode_reason_t reason)
         notify_flight_mode(control_mode);
     }
 
+    rate_thread_unlock();
+
     // return success or failure
     return success;
 }
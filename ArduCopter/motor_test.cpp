@@ -108,7 +108,8 @@ uint8_t Copter::mavlink_motor_test_start(mavlink_channel_t chan, uint8_t motor_s
         if (!mavlink_motor_test_check(chan, throttle_type != 1)) {
             return MAV_RESULT_FAILED;
         } else {
-            // start test
+            // start test, taking the outputs over from the rate thread
+            rate_thread_lock();
             ap.motor_test = true;
 
             // enable and arm motors
@@ -117,6 +118,7 @@ uint8_t Copter::mavlink_motor_test_start(mavlink_channel_t chan, uint8_t motor_s
                 enable_motor_output();
                 motors->armed(true);
             }
+            rate_thread_unlock();
 
             // disable throttle, battery and gps failsafe
             g.failsafe_throttle = FS_THR_DISABLED;
@@ -149,12 +151,16 @@ void Copter::motor_test_stop()
         return;
     }
 
+    rate_thread_lock();
+
     // flag test is complete
     ap.motor_test = false;
 
     // disarm motors
     motors->armed(false);
 
+    rate_thread_unlock();
+
     // reset timeout
     motor_test_start_ms = 0;
     motor_test_timeout_ms = 0;
@@ -188,12 +188,16 @@ bool Copter::init_arm_motors(bool arming_from_gcs)
     sprayer.test_pump(false);
 #endif
 
+    rate_thread_lock();
+
     // enable output to motors
     enable_motor_output();
 
     // finally actually arm the motors
     motors->armed(true);
 
+    rate_thread_unlock();
+
     // log arming to dataflash
     Log_Write_Event(DATA_ARMED);
 
@@ -254,7 +258,9 @@ void Copter::init_disarm_motors()
     Log_Write_Event(DATA_DISARMED);
 
     // send disarm command to motors
+    rate_thread_lock();
     motors->armed(false);
+    rate_thread_unlock();
 
     // reset the mission
     mission.reset();
@@ -303,6 +309,13 @@ void Copter::motors_output()
             Log_Write_Event(DATA_MOTORS_INTERLOCK_DISABLED);
         }
 
+#if RATE_THREAD == ENABLED
+        // the rate thread sends them as soon as the rate controllers ran
+        if (rate_thread_driving) {
+            return;
+        }
+#endif
+
         // send output signals to motors
         motors->output();
     }
@@ -0,0 +1,309 @@
+#include "Copter.h"
+
+/*
+  rate controller thread
+
+  When RATE_THREAD_HZ is set, the rate controllers and the motor outputs
+  run on their own thread instead of in fast_loop(). The thread is woken up
+  by the primary gyro samples as soon as they are filtered on the sensor
+  bus thread, so the delay from a gyro sample to the motor outputs using it
+  is only the time taken by the rate controllers and the mixer, not the
+  time to the next main loop. The flight modes, angle controllers and EKF
+  stay in the main loop. If the thread sends nothing during a main loop,
+  the main loop runs the rate controllers and sends the outputs itself.
+
+  The motors and the rate PIDs are shared with the main loop. Both sides
+  only touch them holding rate_thread_lock, and only for as long as they
+  do: the rate thread for one run of the rate controllers and the mixer,
+  the main loop around the rate controllers and motors_output(), the
+  flight modes and the land and crash detectors, and around arming,
+  disarming, mode changes, the motor test, compassmot and frame changes.
+  The main loop may take it again while holding it. The thread never sends
+  outputs while the main loop drives them for the motor test or the AFS
+  termination: that's decided under the same lock.
+
+  The rate targets and the AHRS gyro drift are posted to the thread
+  through a mailbox once the flight mode ran, so the thread reads them
+  without the lock. Scalar settings the scheduler tasks write (battery
+  voltage and current, air density, throttle hover, tuned gains) and the
+  values the logging reads are single aligned words and are left unlocked.
+ */
+
+#if RATE_THREAD == ENABLED
+
+#include <atomic>
+#include <semaphore.h>
+#include <time.h>
+
+#include <AP_HAL/utility/Mailbox.h>
+#include <AP_HAL_Linux/Scheduler.h>
+#include <AP_HAL_Linux/Semaphores.h>
+#include <AP_HAL_Linux/Thread.h>
+
+#define RATE_THREAD_PRIO        (AP_LINUX_SENSORS_SCHED_PRIO + 1)
+#define RATE_THREAD_TIMEOUT_NS  5000000
+
+// gyro sample handed from the sensor thread to the rate thread
+struct rate_thread_gyro {
+    Vector3f gyro;
+    uint64_t sample_us;
+};
+
+// rate targets handed from the main loop to the rate thread
+struct rate_thread_targets {
+    Vector3f rate_bf_targets;
+    Vector3f gyro_drift;
+};
+
+static sem_t rate_thread_sem;
+static uint32_t rate_thread_period_us;
+
+// the gyro samples have a single producer: rate_thread_gyro_sample() is
+// only ever run by one sensor thread at a time, which it enforces, and
+// these are only touched there
+static std::atomic_flag rate_thread_producer_busy = ATOMIC_FLAG_INIT;
+static uint64_t rate_thread_next_sample_us;
+static ObjectMailbox<rate_thread_gyro> rate_thread_gyro_mailbox;
+
+// only touched by the rate thread
+static uint64_t rate_thread_last_sample_us;
+
+// posted by the main loop only
+static ObjectMailbox<rate_thread_targets> rate_thread_targets_mailbox;
+
+// set by the rate thread each time it sends the motor outputs, cleared by
+// the main loop checking it
+static std::atomic<bool> rate_thread_output_done;
+
+// the rate thread has a higher priority than the main loop: let the main
+// loop run at its priority while it holds the lock
+static Linux::Semaphore rate_thread_lock_sem{true};
+
+// times the main loop took the lock without giving it. Main loop only
+static uint8_t rate_thread_lock_depth;
+
+/*
+  thread running the task until stopped, woken up by the gyro samples
+ */
+class RateThread : public Linux::Thread {
+public:
+    RateThread(Linux::Thread::task_t t)
+        : Thread(t)
+    { }
+
+    bool stop() override
+    {
+        if (!is_started()) {
+            return false;
+        }
+        _should_exit = true;
+        sem_post(&rate_thread_sem);
+        return true;
+    }
+
+protected:
+    bool _run() override
+    {
+        while (!_should_exit) {
+            _task();
+        }
+        _started = false;
+        _should_exit = false;
+        return true;
+    }
+};
+
+static RateThread *rate_thread;
+
+// start the rate thread if enabled. Called once the sensors are running
+void Copter::rate_thread_init()
+{
+    const uint16_t rate_hz = g2.rate_thread_hz;
+    if (rate_hz == 0 || rate_thread != nullptr) {
+        return;
+    }
+    if (rate_hz < scheduler.get_loop_rate_hz()) {
+        gcs_send_text(MAV_SEVERITY_WARNING, "Rate thread: RATE_THREAD_HZ below loop rate");
+        return;
+    }
+
+    if (sem_init(&rate_thread_sem, 0, 0) != 0) {
+        return;
+    }
+
+    rate_thread = new RateThread(FUNCTOR_BIND_MEMBER(&Copter::rate_thread_update, void));
+    if (rate_thread == nullptr) {
+        sem_destroy(&rate_thread_sem);
+        return;
+    }
+
+    rate_thread_period_us = 1000000UL / rate_hz;
+
+    // the motors filters and ramps now step at the thread rate. The rate
+    // PIDs get the time between the samples they run on
+    motors->set_loop_rate(rate_hz);
+
+    // from now on the main loop only touches the shared state holding the
+    // lock
+    rate_thread_active = true;
+
+    int prio = RATE_THREAD_PRIO;
+    int cpu = -1;
+    Linux::Scheduler *linux_scheduler = Linux::Scheduler::from(hal.scheduler);
+    linux_scheduler->get_thread_params("ap-rate", prio, cpu);
+    rate_thread->set_cpu_affinity(cpu);
+    rate_thread->start("ap-rate", SCHED_FIFO, prio);
+    linux_scheduler->register_thread(rate_thread);
+
+    ins.set_gyro_sample_callback(FUNCTOR_BIND_MEMBER(&Copter::rate_thread_gyro_sample, void, const Vector3f &, uint64_t));
+}
+
+/*
+  take and give the lock serialising the main loop with the rate thread.
+  Only called from the main loop, which may nest them
+ */
+void Copter::rate_thread_lock()
+{
+    if (!rate_thread_active) {
+        return;
+    }
+    if (rate_thread_lock_depth++ == 0 && !rate_thread_lock_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        AP_HAL::panic("Rate thread: failed to take lock");
+    }
+}
+
+void Copter::rate_thread_unlock()
+{
+    if (!rate_thread_active || rate_thread_lock_depth == 0) {
+        return;
+    }
+    if (--rate_thread_lock_depth == 0) {
+        rate_thread_lock_sem.give();
+    }
+}
+
+// hand the rate targets set by the flight mode over to the rate thread
+void Copter::rate_thread_post_targets()
+{
+    if (rate_thread_active) {
+        rate_thread_targets_mailbox.post({ attitude_control->rate_bf_targets(), ahrs.get_gyro_drift() });
+    }
+}
+
+// set the time step of the rate PIDs
+void Copter::rate_thread_set_pid_dt(float dt)
+{
+    AC_AttitudeControl_Multi *attitude_control_multi = static_cast<AC_AttitudeControl_Multi *>(attitude_control);
+    attitude_control_multi->get_rate_roll_pid().set_dt(dt);
+    attitude_control_multi->get_rate_pitch_pid().set_dt(dt);
+    attitude_control_multi->get_rate_yaw_pid().set_dt(dt);
+}
+
+/*
+  called from fast_loop(): true if the rate thread sent the motor outputs
+  since the last call. If it didn't, e.g. because the gyro samples stopped
+  coming, fast_loop() runs the rate controllers and sends the outputs
+  itself so that disarming, the spool down and the failsafes still reach
+  the motors. The rate PIDs then step at the main loop rate again
+ */
+bool Copter::rate_thread_check_output()
+{
+    if (rate_thread_output_done.exchange(false, std::memory_order_acquire)) {
+        return true;
+    }
+    rate_thread_set_pid_dt(MAIN_LOOP_SECONDS);
+    return false;
+}
+
+/*
+  called from the sensor thread for each filtered sample of the primary
+  gyro. Wake the rate thread up at most at RATE_THREAD_HZ.
+
+  The mailbox takes a single producer. That's normally the bus thread of
+  the primary gyro, but another one takes over if the primary gyro
+  changes: a sample arriving while another thread is still in here is
+  dropped
+ */
+void Copter::rate_thread_gyro_sample(const Vector3f &gyro, uint64_t sample_us)
+{
+    if (rate_thread_producer_busy.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+
+    if (sample_us >= rate_thread_next_sample_us) {
+        rate_thread_next_sample_us += rate_thread_period_us;
+        if (rate_thread_next_sample_us <= sample_us) {
+            // first sample or samples missing: start over from this one
+            rate_thread_next_sample_us = sample_us + rate_thread_period_us;
+        }
+
+        rate_thread_gyro_mailbox.post({ gyro, sample_us });
+        sem_post(&rate_thread_sem);
+    }
+
+    rate_thread_producer_busy.clear(std::memory_order_release);
+}
+
+// one run of the rate thread: wait for a gyro sample and run on it
+void Copter::rate_thread_update()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += RATE_THREAD_TIMEOUT_NS;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    const bool woken = sem_timedwait(&rate_thread_sem, &ts) == 0;
+
+    rate_thread_gyro sample;
+    if (!woken || !rate_thread_gyro_mailbox.fetch(sample)) {
+        // no new gyro sample: the controller outputs are stale, leave the
+        // motors with the last ones sent rather than send them again
+        return;
+    }
+
+    // the wakeups are quantised to the gyro samples and some may be
+    // missed: run the PIDs over the time actually elapsed between the
+    // samples, bounded for the first one and after a stall
+    float dt = rate_thread_period_us * 1.0e-6f;
+    if (rate_thread_last_sample_us != 0 && sample.sample_us > rate_thread_last_sample_us) {
+        dt = MIN(sample.sample_us - rate_thread_last_sample_us, (uint64_t)RATE_THREAD_TIMEOUT_NS / 1000) * 1.0e-6f;
+    }
+    rate_thread_last_sample_us = sample.sample_us;
+
+    // the latest targets from the main loop, zero until it posts some
+    rate_thread_targets targets;
+    rate_thread_targets_mailbox.fetch(targets);
+
+    if (!rate_thread_lock_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
+
+    bool output_motors = !ap.motor_test;
+#if ADVANCED_FAILSAFE == ENABLED
+    output_motors = output_motors && !g2.afs.should_crash_vehicle();
+#endif
+
+    // the main loop drives the outputs for the motor test and the AFS
+    // termination. It set that up holding the lock, so it's seen here
+    // before the thread could send anything over its outputs
+    if (output_motors) {
+        rate_thread_set_pid_dt(dt);
+        static_cast<AC_AttitudeControl_Multi *>(attitude_control)->rate_controller_run(targets.rate_bf_targets, sample.gyro + targets.gyro_drift);
+        motors->set_input_sample_us(sample.sample_us);
+        motors->output();
+        rate_thread_output_done.store(true, std::memory_order_release);
+    }
+
+    rate_thread_lock_sem.give();
+}
+
+#else // RATE_THREAD == ENABLED
+
+// the rate controllers run in fast_loop(), nothing to serialise with
+void Copter::rate_thread_lock() {}
+void Copter::rate_thread_unlock() {}
+void Copter::rate_thread_post_targets() {}
+
+#endif // RATE_THREAD == ENABLED
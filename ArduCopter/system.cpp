@@ -307,6 +307,11 @@ void Copter::init_ardupilot()
     ins.set_raw_logging(should_log(MASK_LOG_IMU_RAW));
     ins.set_dataflash(&DataFlash);
 
+#if RATE_THREAD == ENABLED
+    // start the rate thread now that the sensors are running
+    rate_thread_init();
+#endif
+
     cliSerial->print("\nReady to FLY ");
 
     // flag that initialisation has completed
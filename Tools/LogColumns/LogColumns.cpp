@@ -0,0 +1,349 @@
+#include "LogColumns.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+static uint64_t align8(uint64_t ofs)
+{
+    return (ofs + 7) & ~7ULL;
+}
+
+uint8_t log_columns_field_size(char c)
+{
+    switch (c) {
+    case 'b': case 'B': case 'M':
+        return 1;
+    case 'c': case 'C': case 'h': case 'H':
+        return 2;
+    case 'e': case 'E': case 'f': case 'i': case 'I': case 'L': case 'n':
+        return 4;
+    case 'd': case 'q': case 'Q':
+        return 8;
+    case 'N':
+        return 16;
+    case 'Z':
+        return 64;
+    }
+    return 0;
+}
+
+// copy label number i of a comma separated list into buf
+static void label_at(const char *labels, uint8_t labels_len, uint8_t i, char *buf, uint8_t buflen)
+{
+    uint8_t n = 0;
+    uint8_t len = 0;
+    for (uint8_t j = 0; j < labels_len && labels[j] != 0; j++) {
+        if (labels[j] == ',') {
+            if (n++ == i) {
+                break;
+            }
+            continue;
+        }
+        if (n == i && len < buflen - 1) {
+            buf[len++] = labels[j];
+        }
+    }
+    buf[len] = 0;
+}
+
+bool LogColumnsWriter::handle_log_format_msg(const struct log_Format &f)
+{
+    struct column_set &c = columns[f.type];
+
+    if (!c.time.empty()) {
+        ::printf("Format of %.4s redefined, dropping %u earlier messages\n",
+                 f.name, (unsigned)c.time.size());
+        c.time.clear();
+        for (uint8_t i = 0; i < LOG_COLUMNS_MAX_FIELDS; i++) {
+            c.data[i].clear();
+        }
+    }
+
+    c.valid = false;
+    c.num_fields = 0;
+    c.time_field = -1;
+    c.time_ms = false;
+
+    uint16_t ofs = LOG_PACKET_HEADER_LEN;
+    for (uint8_t i = 0; i < sizeof(f.format) && f.format[i] != 0; i++) {
+        const uint8_t size = log_columns_field_size(f.format[i]);
+        if (size == 0) {
+            ::printf("Unknown field type '%c' in %.4s, skipping it\n", f.format[i], f.name);
+            return true;
+        }
+        char label[17];
+        label_at(f.labels, sizeof(f.labels), i, label, sizeof(label));
+        if (c.time_field == -1 && f.format[i] == 'Q' && strcmp(label, "TimeUS") == 0) {
+            c.time_field = i;
+        } else if (c.time_field == -1 && f.format[i] == 'I' && strcmp(label, "TimeMS") == 0) {
+            c.time_field = i;
+            c.time_ms = true;
+        }
+        c.field_size[i] = size;
+        c.field_offset[i] = ofs;
+        ofs += size;
+        c.num_fields++;
+    }
+    if (ofs > f.length) {
+        ::printf("Fields of %.4s longer than the message, skipping it\n", f.name);
+        return true;
+    }
+
+    c.valid = true;
+    return true;
+}
+
+bool LogColumnsWriter::handle_msg(const struct log_Format &f, uint8_t *msg)
+{
+    struct column_set &c = columns[f.type];
+    if (!c.valid) {
+        return true;
+    }
+
+    if (c.time_field != -1) {
+        const uint8_t *p = &msg[c.field_offset[c.time_field]];
+        if (c.time_ms) {
+            uint32_t t_ms;
+            memcpy(&t_ms, p, sizeof(t_ms));
+            last_time_us = t_ms * 1000ULL;
+        } else {
+            memcpy(&last_time_us, p, sizeof(last_time_us));
+        }
+    }
+    c.time.push_back(last_time_us);
+
+    for (uint8_t i = 0; i < c.num_fields; i++) {
+        const uint8_t *p = &msg[c.field_offset[i]];
+        c.data[i].insert(c.data[i].end(), p, p + c.field_size[i]);
+    }
+    return true;
+}
+
+bool LogColumnsWriter::write_type(const char *dir, const struct log_Format &f, const struct column_set &c)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%.4s.col", dir, f.name);
+    int fd = ::open(path, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0644);
+    if (fd == -1) {
+        ::printf("Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct log_columns_header hdr {};
+    memcpy(hdr.magic, LOG_COLUMNS_MAGIC, sizeof(hdr.magic));
+    hdr.version = LOG_COLUMNS_VERSION;
+    hdr.rows = c.time.size();
+    hdr.format = f;
+    hdr.num_fields = c.num_fields;
+    memcpy(hdr.field_size, c.field_size, sizeof(hdr.field_size));
+
+    uint64_t ofs = align8(sizeof(hdr));
+    hdr.time_offset = ofs;
+    ofs += hdr.rows * sizeof(uint64_t);
+    for (uint8_t i = 0; i < c.num_fields; i++) {
+        ofs = align8(ofs);
+        hdr.field_offset[i] = ofs;
+        ofs += c.data[i].size();
+    }
+
+    bool ok = ::pwrite(fd, &hdr, sizeof(hdr), 0) == sizeof(hdr);
+    const size_t time_len = c.time.size() * sizeof(uint64_t);
+    ok = ok && ::pwrite(fd, c.time.data(), time_len, hdr.time_offset) == (ssize_t)time_len;
+    for (uint8_t i = 0; ok && i < c.num_fields; i++) {
+        ok = ::pwrite(fd, c.data[i].data(), c.data[i].size(), hdr.field_offset[i]) == (ssize_t)c.data[i].size();
+    }
+    ok = ok && ::ftruncate(fd, align8(ofs)) == 0;
+    if (!ok) {
+        ::printf("Failed to write %s: %s\n", path, strerror(errno));
+    }
+    ::close(fd);
+    return ok;
+}
+
+bool LogColumnsWriter::write(const char *dir)
+{
+    if (::mkdir(dir, 0777) == -1 && errno != EEXIST) {
+        ::printf("Failed to create %s: %s\n", dir, strerror(errno));
+        return false;
+    }
+    for (uint16_t type = 0; type < LOGREADER_MAX_FORMATS; type++) {
+        const struct column_set &c = columns[type];
+        if (!c.valid || c.time.empty()) {
+            continue;
+        }
+        if (!write_type(dir, formats[type], c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LogColumnsReader::~LogColumnsReader()
+{
+    if (_map != nullptr) {
+        ::munmap((void *)_map, _size);
+    }
+    if (_fd != -1) {
+        ::close(_fd);
+    }
+}
+
+bool LogColumnsReader::open(const char *dir, const char *name)
+{
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s.col", dir, name);
+    _fd = ::open(path, O_RDONLY|O_CLOEXEC);
+    if (_fd == -1) {
+        ::printf("Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (::fstat(_fd, &st) != 0 || (size_t)st.st_size < sizeof(struct log_columns_header)) {
+        ::printf("Bad columns file %s\n", path);
+        return false;
+    }
+    _size = st.st_size;
+    void *map = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, _fd, 0);
+    if (map == MAP_FAILED) {
+        ::printf("Failed to map %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    _map = (const uint8_t *)map;
+    _hdr = (const struct log_columns_header *)_map;
+
+    if (memcmp(_hdr->magic, LOG_COLUMNS_MAGIC, sizeof(_hdr->magic)) != 0 ||
+        _hdr->version != LOG_COLUMNS_VERSION ||
+        _hdr->num_fields > LOG_COLUMNS_MAX_FIELDS ||
+        _hdr->time_offset + _hdr->rows * sizeof(uint64_t) > _size) {
+        ::printf("Bad columns file %s\n", path);
+        return false;
+    }
+    for (uint8_t i = 0; i < _hdr->num_fields; i++) {
+        if (_hdr->field_offset[i] + (uint64_t)_hdr->rows * _hdr->field_size[i] > _size) {
+            ::printf("Bad columns file %s\n", path);
+            return false;
+        }
+    }
+    _time = (const uint64_t *)&_map[_hdr->time_offset];
+    return true;
+}
+
+int8_t LogColumnsReader::find_field(const char *label) const
+{
+    char buf[17];
+    for (uint8_t i = 0; i < _hdr->num_fields; i++) {
+        field_label(i, buf, sizeof(buf));
+        if (strcmp(buf, label) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void LogColumnsReader::field_label(uint8_t i, char *buf, uint8_t buflen) const
+{
+    label_at(_hdr->format.labels, sizeof(_hdr->format.labels), i, buf, buflen);
+}
+
+uint32_t LogColumnsReader::lower_bound(uint64_t t_us) const
+{
+    uint32_t lo = 0, hi = _hdr->rows;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (_time[mid] < t_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+uint32_t LogColumnsReader::upper_bound(uint64_t t_us) const
+{
+    uint32_t lo = 0, hi = _hdr->rows;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (_time[mid] <= t_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+template <typename T>
+static T value_at(const uint8_t *p)
+{
+    T v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+void LogColumnsReader::print_field(FILE *f, uint8_t i, uint32_t row) const
+{
+    const uint8_t size = _hdr->field_size[i];
+    const uint8_t *p = &_map[_hdr->field_offset[i] + (uint64_t)row * size];
+
+    switch (_hdr->format.format[i]) {
+    case 'b':
+        fprintf(f, "%d", value_at<int8_t>(p));
+        break;
+    case 'B':
+    case 'M':
+        fprintf(f, "%u", value_at<uint8_t>(p));
+        break;
+    case 'h':
+        fprintf(f, "%d", value_at<int16_t>(p));
+        break;
+    case 'H':
+        fprintf(f, "%u", value_at<uint16_t>(p));
+        break;
+    case 'i':
+        fprintf(f, "%d", value_at<int32_t>(p));
+        break;
+    case 'I':
+        fprintf(f, "%u", value_at<uint32_t>(p));
+        break;
+    case 'q':
+        fprintf(f, "%lld", (long long)value_at<int64_t>(p));
+        break;
+    case 'Q':
+        fprintf(f, "%llu", (unsigned long long)value_at<uint64_t>(p));
+        break;
+    case 'f':
+        fprintf(f, "%.7g", value_at<float>(p));
+        break;
+    case 'd':
+        fprintf(f, "%.15g", value_at<double>(p));
+        break;
+    case 'c':
+        fprintf(f, "%.2f", value_at<int16_t>(p) * 0.01);
+        break;
+    case 'C':
+        fprintf(f, "%.2f", value_at<uint16_t>(p) * 0.01);
+        break;
+    case 'e':
+        fprintf(f, "%.2f", value_at<int32_t>(p) * 0.01);
+        break;
+    case 'E':
+        fprintf(f, "%.2f", value_at<uint32_t>(p) * 0.01);
+        break;
+    case 'L':
+        fprintf(f, "%.7f", value_at<int32_t>(p) * 1.0e-7);
+        break;
+    case 'n':
+    case 'N':
+    case 'Z':
+        fprintf(f, "%.*s", (int)strnlen((const char *)p, size), (const char *)p);
+        break;
+    }
+}
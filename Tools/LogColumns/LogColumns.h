@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+  columnar store of DataFlash logs
+
+  A log is converted into a directory holding one file per message type,
+  NAME.col. Each file has a header describing the message format, then a
+  column of uint64_t times in microseconds, then one column per field of
+  the message, each an array of the field as stored in the log. Columns
+  are 8 byte aligned so that they can be used in place once the file is
+  mmapped. The time column is the time index of the message type: a
+  time range is found by binary search on it
+ */
+
+#include <AP_Common/AP_Common.h>
+
+#include "../Replay/DataFlashFileReader.h"
+
+#include <stdio.h>
+#include <vector>
+
+#define LOG_COLUMNS_MAGIC "APLOGCOL"
+#define LOG_COLUMNS_VERSION 1
+#define LOG_COLUMNS_MAX_FIELDS 16   // a log_Format holds at most 16 fields
+
+struct PACKED log_columns_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t rows;
+    struct log_Format format;
+    uint8_t num_fields;
+    uint8_t field_size[LOG_COLUMNS_MAX_FIELDS];
+    // file offsets of the time column and of each field column
+    uint64_t time_offset;
+    uint64_t field_offset[LOG_COLUMNS_MAX_FIELDS];
+};
+
+// size in the log of a field of type c, 0 if unknown
+uint8_t log_columns_field_size(char c);
+
+/*
+  log reader building the columns of each message type in memory, and
+  writing them out at the end
+ */
+class LogColumnsWriter : public DataFlashFileReader
+{
+public:
+    bool handle_log_format_msg(const struct log_Format &f) override;
+    bool handle_msg(const struct log_Format &f, uint8_t *msg) override;
+
+    // write all the message types with at least one message to dir
+    bool write(const char *dir);
+
+private:
+    struct column_set {
+        bool valid = false;
+        uint8_t num_fields;
+        uint8_t field_size[LOG_COLUMNS_MAX_FIELDS];
+        uint8_t field_offset[LOG_COLUMNS_MAX_FIELDS];
+        int8_t time_field;        // index of TimeUS or TimeMS, -1 if none
+        bool time_ms;
+        std::vector<uint64_t> time;
+        std::vector<uint8_t> data[LOG_COLUMNS_MAX_FIELDS];
+    } columns[LOGREADER_MAX_FORMATS];
+
+    // time of the last message with a time field, for the others
+    uint64_t last_time_us = 0;
+
+    bool write_type(const char *dir, const struct log_Format &f, const struct column_set &c);
+};
+
+/*
+  read only access to the columns of one message type, from a mmapped
+  NAME.col file
+ */
+class LogColumnsReader
+{
+public:
+    ~LogColumnsReader();
+
+    bool open(const char *dir, const char *name);
+
+    const struct log_columns_header &header() const { return *_hdr; }
+    uint32_t rows() const { return _hdr->rows; }
+
+    // index of the field called label, -1 if none
+    int8_t find_field(const char *label) const;
+
+    // label of field i, copied into buf
+    void field_label(uint8_t i, char *buf, uint8_t buflen) const;
+
+    uint64_t time_us(uint32_t row) const { return _time[row]; }
+
+    // first row at or after t, and first row after t
+    uint32_t lower_bound(uint64_t t_us) const;
+    uint32_t upper_bound(uint64_t t_us) const;
+
+    // print field i of row in the style of the log dump tools
+    void print_field(FILE *f, uint8_t i, uint32_t row) const;
+
+private:
+    int _fd = -1;
+    size_t _size;
+    const uint8_t *_map = nullptr;
+    const struct log_columns_header *_hdr = nullptr;
+    const uint64_t *_time = nullptr;
+};
@@ -0,0 +1,135 @@
+/*
+  convert DataFlash logs to a columnar store, and query it
+
+  LogColumns convert LOGFILE DIR
+    splits a .bin log into one columns file per message type in DIR
+  LogColumns list DIR
+    lists the message types in DIR with their number of messages
+  LogColumns query DIR TYPE [-s START] [-e END] [FIELD...]
+    prints the messages of TYPE between START and END seconds as CSV,
+    with all fields or only those given
+ */
+
+#include "LogColumns.h"
+
+#include <AP_Math/AP_Math.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage(void)
+{
+    ::printf("Usage: LogColumns convert LOGFILE DIR\n");
+    ::printf("       LogColumns list DIR\n");
+    ::printf("       LogColumns query DIR TYPE [-s START] [-e END] [FIELD...]\n");
+    ::printf("START and END are in seconds of log time\n");
+}
+
+static int convert(const char *logfile, const char *dir)
+{
+    // the columns of a whole log are held in memory until written
+    LogColumnsWriter writer;
+    if (!writer.open_log(logfile)) {
+        ::printf("Failed to open %s\n", logfile);
+        return 1;
+    }
+    char type[5];
+    while (writer.update(type)) {
+    }
+    return writer.write(dir) ? 0 : 1;
+}
+
+static int list(const char *dir)
+{
+    DIR *d = ::opendir(dir);
+    if (d == nullptr) {
+        ::printf("Failed to open %s\n", dir);
+        return 1;
+    }
+    for (struct dirent *de = ::readdir(d); de != nullptr; de = ::readdir(d)) {
+        const size_t len = strlen(de->d_name);
+        if (len < 5 || strcmp(&de->d_name[len - 4], ".col") != 0) {
+            continue;
+        }
+        char name[5] {};
+        memcpy(name, de->d_name, MIN(len - 4, sizeof(name) - 1));
+        LogColumnsReader reader;
+        if (!reader.open(dir, name)) {
+            continue;
+        }
+        const struct log_columns_header &hdr = reader.header();
+        ::printf("%-4s %10u  %.16s  %.64s\n", name, reader.rows(), hdr.format.format, hdr.format.labels);
+    }
+    ::closedir(d);
+    return 0;
+}
+
+static int query(const char *dir, const char *name, int argc, char *const argv[])
+{
+    LogColumnsReader reader;
+    if (!reader.open(dir, name)) {
+        return 1;
+    }
+
+    uint64_t start_us = 0;
+    uint64_t end_us = UINT64_MAX;
+    int8_t fields[LOG_COLUMNS_MAX_FIELDS];
+    uint8_t num_fields = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            start_us = strtod(argv[++i], nullptr) * 1.0e6;
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            end_us = strtod(argv[++i], nullptr) * 1.0e6;
+        } else {
+            const int8_t field = reader.find_field(argv[i]);
+            if (field == -1) {
+                ::printf("No field %s in %s\n", argv[i], name);
+                return 1;
+            }
+            if (num_fields < LOG_COLUMNS_MAX_FIELDS) {
+                fields[num_fields++] = field;
+            }
+        }
+    }
+    if (num_fields == 0) {
+        for (uint8_t i = 0; i < reader.header().num_fields; i++) {
+            fields[num_fields++] = i;
+        }
+    }
+
+    char label[17];
+    ::printf("time_us");
+    for (uint8_t i = 0; i < num_fields; i++) {
+        reader.field_label(fields[i], label, sizeof(label));
+        ::printf(",%s", label);
+    }
+    ::printf("\n");
+
+    const uint32_t end = reader.upper_bound(end_us);
+    for (uint32_t row = reader.lower_bound(start_us); row < end; row++) {
+        ::printf("%llu", (unsigned long long)reader.time_us(row));
+        for (uint8_t i = 0; i < num_fields; i++) {
+            ::printf(",");
+            reader.print_field(stdout, fields[i], row);
+        }
+        ::printf("\n");
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc == 4 && strcmp(argv[1], "convert") == 0) {
+        return convert(argv[2], argv[3]);
+    }
+    if (argc == 3 && strcmp(argv[1], "list") == 0) {
+        return list(argv[2]);
+    }
+    if (argc >= 4 && strcmp(argv[1], "query") == 0) {
+        return query(argv[2], argv[3], argc - 4, &argv[4]);
+    }
+    usage();
+    return 1;
+}
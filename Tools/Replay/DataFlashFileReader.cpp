@@ -12,24 +12,79 @@ bool DataFlashFileReader::open_log(const char *logfile)
     if (fd == -1) {
         return false;
     }
+
+    compressed = log_file_compressed(fd);
+    if (compressed) {
+        if (!frames.init()) {
+            return false;
+        }
+        frames.reset(fd);
+    }
+    raw_len = 0;
+    raw_ofs = 0;
+    return true;
+}
+
+/*
+  read len bytes of the log, decompressing it if needed. A compressed
+  log goes on after a damaged frame as for downloads, see LogFrameReader
+ */
+bool DataFlashFileReader::read_log(void *buf, uint16_t len)
+{
+    if (!compressed) {
+        return ::read(fd, buf, len) == len;
+    }
+
+    uint8_t *p = (uint8_t *)buf;
+    while (len > 0) {
+        if (raw_len == 0) {
+            const ssize_t ret = frames.read(raw_ofs, raw, raw_data);
+            if (ret <= 0) {
+                return false;
+            }
+            raw_len = ret;
+        }
+        const uint16_t n = MIN(len, raw_len);
+        memcpy(p, raw_data, n);
+        raw_data += n;
+        raw_len -= n;
+        raw_ofs += n;
+        p += n;
+        len -= n;
+    }
     return true;
 }
 
 bool DataFlashFileReader::update(char type[5])
 {
     uint8_t hdr[3];
-    if (::read(fd, hdr, 3) != 3) {
+    if (!read_log(hdr, 3)) {
         return false;
     }
-    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
-        printf("bad log header\n");
-        return false;
+    uint32_t skipped = 0;
+    while (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2 ||
+           (compressed && hdr[2] != LOG_FORMAT_MSG && formats[hdr[2]].length == 0)) {
+        if (!compressed) {
+            printf("bad log header\n");
+            return false;
+        }
+        // the bytes lost with a damaged frame read as zeros and the next
+        // frame may start within a message: skip to the next one
+        hdr[0] = hdr[1];
+        hdr[1] = hdr[2];
+        if (!read_log(&hdr[2], 1)) {
+            return false;
+        }
+        skipped++;
+    }
+    if (skipped > 0) {
+        printf("skipped %u bytes of damaged log\n", (unsigned)skipped);
     }
 
     if (hdr[2] == LOG_FORMAT_MSG) {
         struct log_Format f;
         memcpy(&f, hdr, 3);
-        if (::read(fd, &f.type, sizeof(f)-3) != sizeof(f)-3) {
+        if (!read_log(&f.type, sizeof(f)-3)) {
             return false;
         }
         memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
@@ -55,7 +110,7 @@ bool DataFlashFileReader::update(char type[5])
     uint8_t msg[f.length];
 
     memcpy(msg, hdr, 3);
-    if (::read(fd, &msg[3], f.length-3) != f.length-3) {
+    if (!read_log(&msg[3], f.length-3)) {
         return false;
     }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <DataFlash/DataFlash.h>
+#include <DataFlash/LogCompression.h>
 
 class DataFlashFileReader
 {
@@ -18,4 +19,16 @@ protected:
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
     struct log_Format formats[LOGREADER_MAX_FORMATS] {};
+
+private:
+    // compressed logs are decompressed a frame at a time into raw,
+    // holding raw_len bytes of the log from offset raw_ofs
+    bool compressed = false;
+    LogFrameReader frames;
+    uint8_t raw[LOG_COMPRESSED_FRAME_MAX];
+    const uint8_t *raw_data = nullptr;
+    uint16_t raw_len = 0;
+    uint32_t raw_ofs = 0;
+
+    bool read_log(void *buf, uint16_t len);
 };
@@ -234,9 +234,21 @@ void AC_AttitudeControl_Multi::rate_controller_run()
     // move throttle vs attitude mixing towards desired (called from here because this is conveniently called on every iteration)
     update_throttle_rpy_mix();
 
-    _motors.set_roll(rate_target_to_motor_roll(_rate_target_ang_vel.x));
-    _motors.set_pitch(rate_target_to_motor_pitch(_rate_target_ang_vel.y));
-    _motors.set_yaw(rate_target_to_motor_yaw(_rate_target_ang_vel.z));
+    rate_controller_run(_rate_target_ang_vel, _ahrs.get_gyro());
+
+    control_monitor_update();
+}
+
+void AC_AttitudeControl_Multi::rate_controller_run(const Vector3f &rate_target_ang_vel, const Vector3f &gyro)
+{
+    _motors.set_roll(rate_target_to_motor_roll(rate_target_ang_vel.x, gyro.x));
+    _motors.set_pitch(rate_target_to_motor_pitch(rate_target_ang_vel.y, gyro.y));
+    _motors.set_yaw(rate_target_to_motor_yaw(rate_target_ang_vel.z, gyro.z));
+}
+
+void AC_AttitudeControl_Multi::rate_controller_update()
+{
+    update_throttle_rpy_mix();
 
     control_monitor_update();
 }
@@ -73,6 +73,15 @@ public:
     // run lowest level body-frame rate controller and send outputs to the motors
     void rate_controller_run();
 
+    // run the body-frame rate controller for rate_target_ang_vel, using gyro
+    // as the current rates, and send outputs to the motors. Used when the
+    // rate controller runs on its own thread, faster than the main loop,
+    // which then calls rate_controller_update() instead of rate_controller_run()
+    void rate_controller_run(const Vector3f &rate_target_ang_vel, const Vector3f &gyro);
+
+    // update the parts of the rate controller that run at the main loop rate
+    void rate_controller_update();
+
     // sanity check parameters.  should be called once before take-off
     void parameter_sanity_check();
 
@@ -414,7 +414,7 @@ bool AC_Fence::load_polygon_from_eeprom(bool force_reload)
     if (!_inav.get_location(temp_loc)) {
         return false;
     }
-    const struct Location &ekf_origin = _inav.get_origin();
+    const LocationFrame frame(_inav.get_origin());
 
     // sanity check total
     _total = constrain_int16(_total, 0, _poly_loader.max_points());
@@ -427,7 +427,7 @@ bool AC_Fence::load_polygon_from_eeprom(bool force_reload)
         // move into location structure and convert to offset from ekf origin
         temp_loc.lat = temp_latlon.x;
         temp_loc.lng = temp_latlon.y;
-        _boundary[index] = location_diff(ekf_origin, temp_loc) * 100.0f;
+        _boundary[index] = frame.get_ne(temp_loc) * 100.0f;
     }
     _boundary_num_points = _total;
     _boundary_loaded = true;
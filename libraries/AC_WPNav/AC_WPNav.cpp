@@ -102,7 +102,16 @@ const AP_Param::GroupInfo AC_WPNav::var_info[] = {
     // @Values: 0:Disable,1:Enable
     // @User: Advanced
     AP_GROUPINFO("RFND_USE",   10, AC_WPNav, _rangefinder_use, 1),
-    
+
+    // @Param: ACCEL_C
+    // @DisplayName: Waypoint Cornering Acceleration
+    // @Description: Defines the maximum lateral acceleration in cm/s/s used to limit the speed through the curves of spline waypoints. If zero twice WPNAV_ACCEL is used
+    // @Units: cm/s/s
+    // @Range: 0 1000
+    // @Increment: 10
+    // @User: Advanced
+    AP_GROUPINFO("ACCEL_C",    11, AC_WPNav, _wp_accel_c_cms, 0.0f),
+
     AP_GROUPEND
 };
 
@@ -126,8 +135,10 @@ AC_WPNav::AC_WPNav(const AP_InertialNav& inav, const AP_AHRS& ahrs, AC_PosContro
     _track_speed(0.0f),
     _track_leash_length(0.0f),
     _slow_down_dist(0.0f),
+    _fast_wp_speed_cms(0.0f),
     _spline_time(0.0f),
-    _spline_time_scale(0.0f),
+    _spline_dist(0.0f),
+    _spline_length(0.0f),
     _spline_vel_scaler(0.0f),
     _yaw(0.0f)
 {
@@ -468,6 +479,11 @@ bool AC_WPNav::set_wp_destination(const Vector3f& destination, bool terrain_alt)
 ///     returns false on failure (likely caused by missing terrain data)
 bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt)
 {
+    // a fast waypoint passed at a planned speed hands that speed over to the next segment
+    const bool carry_speed = _flags.fast_waypoint && _flags.reached_destination && _fast_wp_speed_cms > 0.0f &&
+                             (AP_HAL::millis() - _wp_last_update) < 1000;
+    const float prev_speed_cms = MIN(_limited_speed_xy_cms, _fast_wp_speed_cms);
+
     // store origin and destination locations
     _origin = origin;
     _destination = destination;
@@ -510,6 +526,7 @@ bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vecto
     _track_desired = 0;             // target is at beginning of track
     _flags.reached_destination = false;
     _flags.fast_waypoint = false;   // default waypoint back to slow
+    _fast_wp_speed_cms = 0.0f;      // no speed limit at fast waypoints until the following waypoints are known
     _flags.slowing_down = false;    // target is not slowing down yet
     _flags.segment_type = SEGMENT_STRAIGHT;
     _flags.new_wp_destination = true;   // flag new waypoint so we can freeze the pos controller's feed forward and smooth the transition
@@ -519,6 +536,9 @@ bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vecto
     // get speed along track (note: we convert vertical speed into horizontal speed equivalent)
     float speed_along_track = curr_vel.x * _pos_delta_unit.x + curr_vel.y * _pos_delta_unit.y + curr_vel.z * _pos_delta_unit.z;
     _limited_speed_xy_cms = constrain_float(speed_along_track,0,_wp_speed_cms);
+    if (carry_speed) {
+        _limited_speed_xy_cms = MAX(_limited_speed_xy_cms, MIN(prev_speed_cms, _wp_speed_cms));
+    }
 
     return true;
 }
@@ -645,6 +665,10 @@ bool AC_WPNav::advance_wp_target_along_track(float dt)
             if (_flags.slowing_down) {
                 _limited_speed_xy_cms = MIN(_limited_speed_xy_cms, get_slow_down_speed(dist_to_dest, _track_accel));
             }
+        } else if (_fast_wp_speed_cms > 0.0f) {
+            // slow down to the speed the vehicle can turn towards the next waypoint at
+            float dist_to_dest = MAX(_track_length - _track_desired, 0.0f);
+            _limited_speed_xy_cms = MIN(_limited_speed_xy_cms, safe_sqrt(sq(_fast_wp_speed_cms) + dist_to_dest * 4.0f * _track_accel));
         }
 
         // if our current velocity is within the linear velocity range limit the intermediate point's velocity to be no more than the linear_velocity above or below our current velocity
@@ -699,6 +723,36 @@ bool AC_WPNav::advance_wp_target_along_track(float dt)
     return true;
 }
 
+/// set_wp_lookahead - plans the speed at which the intermediate point passes a fast waypoint from the straight segments which follow it
+///     next_destinations holds up to WPNAV_LOOKAHEAD_MAX waypoints after the destination, in order
+///     stop_at_end should be true if the vehicle stops at the last of them
+///     relies on set_wp_destination or set_wp_origin_and_destination having been called first
+void AC_WPNav::set_wp_lookahead(const Location_Class next_destinations[], uint8_t num_destinations, bool stop_at_end)
+{
+    Vector3f path[WPNAV_LOOKAHEAD_MAX + 2];
+    uint8_t num_points = 0;
+
+    path[num_points++] = _origin;
+    path[num_points++] = _destination;
+    for (uint8_t i = 0; i < MIN(num_destinations, WPNAV_LOOKAHEAD_MAX); i++) {
+        bool terrain_alt;
+        if (!get_vector_NEU(next_destinations[i], path[num_points], terrain_alt) || terrain_alt != _terrain_alt) {
+            // what comes after this point is unknown, so don't plan to stop at it
+            stop_at_end = false;
+            break;
+        }
+        num_points++;
+    }
+
+    // without a corner there is nothing to slow down for
+    if (num_points < 3) {
+        _fast_wp_speed_cms = 0.0f;
+        return;
+    }
+
+    _fast_wp_speed_cms = MAX(calc_lookahead_speed(path, num_points, stop_at_end ? 0.0f : _wp_speed_cms), WPNAV_WP_TRACK_SPEED_MIN);
+}
+
 /// get_wp_distance_to_destination - get horizontal distance to destination in cm
 float AC_WPNav::get_wp_distance_to_destination() const
 {
@@ -899,7 +953,7 @@ bool AC_WPNav::set_spline_origin_and_destination(const Vector3f& origin, const V
     if (stopped_at_start || !prev_segment_exists) {
     	// if vehicle is stopped at the origin, set origin velocity to 0.02 * distance vector from origin to destination
     	_spline_origin_vel = (destination - origin) * dt;
-    	_spline_time = 0.0f;
+    	_spline_dist = 0.0f;
     	_spline_vel_scaler = 0.0f;
     }else{
     	// look at previous segment to determine velocity at origin
@@ -907,7 +961,7 @@ bool AC_WPNav::set_spline_origin_and_destination(const Vector3f& origin, const V
             // previous segment is straight, vehicle is moving so vehicle should fly straight through the origin
             // before beginning it's spline path to the next waypoint. Note: we are using the previous segment's origin and destination
             _spline_origin_vel = (_destination - _origin);
-            _spline_time = 0.0f;	// To-Do: this should be set based on how much overrun there was from straight segment?
+            _spline_dist = 0.0f;	// To-Do: this should be set based on how much overrun there was from straight segment?
             _spline_vel_scaler = _pos_control.get_vel_target().length();    // start velocity target from current target velocity
         }else{
             // previous segment is splined, vehicle will fly through origin
@@ -915,10 +969,10 @@ bool AC_WPNav::set_spline_origin_and_destination(const Vector3f& origin, const V
             // Note: previous segment will leave destination velocity parallel to position difference vector
             //       from previous segment's origin to this segment's destination)
             _spline_origin_vel = _spline_destination_vel;
-            if (_spline_time > 1.0f && _spline_time < 1.1f) {    // To-Do: remove hard coded 1.1f
-                _spline_time -= 1.0f;
+            if (_spline_dist > _spline_length && _spline_dist < _spline_length * 1.1f) {    // To-Do: remove hard coded 1.1f
+                _spline_dist -= _spline_length;
             }else{
-                _spline_time = 0.0f;
+                _spline_dist = 0.0f;
             }
             // Note: we leave _spline_vel_scaler as it was from end of previous segment
         }
@@ -1036,13 +1090,106 @@ void AC_WPNav::update_spline_solution(const Vector3f& origin, const Vector3f& de
     _hermite_spline_solution[1] = origin_vel;
     _hermite_spline_solution[2] = -origin*3.0f -origin_vel*2.0f + dest*3.0f - dest_vel;
     _hermite_spline_solution[3] = origin*2.0f + origin_vel -dest*2.0f + dest_vel;
+
+    update_spline_table();
  }
 
+/// update_spline_table - measures the length of the spline segment and fills the spline time and maximum speed tables by distance along it
+///     relies on update_spline_solution having set the hermite spline solution
+void AC_WPNav::update_spline_table()
+{
+    Vector3f pos, vel, prev_pos;
+
+    // measure the length of the segment by adding up the chords between evenly spaced spline times
+    float length = 0.0f;
+    prev_pos = _hermite_spline_solution[0];
+    for (uint16_t k = 1; k <= WPNAV_SPLINE_LENGTH_STEPS; k++) {
+        calc_spline_pos_vel((float)k / WPNAV_SPLINE_LENGTH_STEPS, pos, vel);
+        length += (pos - prev_pos).length();
+        prev_pos = pos;
+    }
+    _spline_length = length;
+
+    // walk the same chords again to find the spline time at each evenly spaced distance
+    const float table_step = length / (WPNAV_SPLINE_TABLE_SIZE - 1);
+    float dist = 0.0f;
+    uint8_t i = 1;
+    _spline_table_time[0] = 0.0f;
+    prev_pos = _hermite_spline_solution[0];
+    for (uint16_t k = 1; k <= WPNAV_SPLINE_LENGTH_STEPS && i < WPNAV_SPLINE_TABLE_SIZE - 1; k++) {
+        calc_spline_pos_vel((float)k / WPNAV_SPLINE_LENGTH_STEPS, pos, vel);
+        const float chord = (pos - prev_pos).length();
+        while (i < WPNAV_SPLINE_TABLE_SIZE - 1 && dist + chord >= i * table_step) {
+            const float chord_fraction = chord > 0.0f ? (i * table_step - dist) / chord : 0.0f;
+            _spline_table_time[i] = (k - 1 + chord_fraction) / WPNAV_SPLINE_LENGTH_STEPS;
+            i++;
+        }
+        dist += chord;
+        prev_pos = pos;
+    }
+    for (; i < WPNAV_SPLINE_TABLE_SIZE; i++) {
+        _spline_table_time[i] = 1.0f;
+    }
+
+    // maximum speed through the curvature at each point, v^2 = accel / curvature
+    // the waypoint speed may change during the segment so it's applied when the table is read, not here
+    const float accel_c = get_corner_accel();
+    for (i = 0; i < WPNAV_SPLINE_TABLE_SIZE; i++) {
+        const float t = _spline_table_time[i];
+        vel = _hermite_spline_solution[1] + _hermite_spline_solution[2] * 2.0f * t + _hermite_spline_solution[3] * 3.0f * t * t;
+        const Vector3f accel = _hermite_spline_solution[2] * 2.0f + _hermite_spline_solution[3] * 6.0f * t;
+        const float vel_length = vel.length();
+        const float curvature_num = (vel % accel).length();
+        float speed_max = WPNAV_SPLINE_SPEED_MAX;
+        // curvature is |vel x accel| / |vel|^3
+        if (curvature_num * speed_max * speed_max > accel_c * vel_length * vel_length * vel_length) {
+            speed_max = safe_sqrt(accel_c * vel_length * vel_length * vel_length / curvature_num);
+        }
+        _spline_table_speed_max[i] = MAX(speed_max, WPNAV_WP_TRACK_SPEED_MIN);
+    }
+
+    // limit each point's speed so that the vehicle can slow down for the curves ahead
+    for (i = WPNAV_SPLINE_TABLE_SIZE - 1; i > 0; i--) {
+        const float speed_max = safe_sqrt(sq(_spline_table_speed_max[i]) + 2.0f * _wp_accel_cms * table_step);
+        _spline_table_speed_max[i - 1] = MIN(_spline_table_speed_max[i - 1], speed_max);
+    }
+}
+
+/// get_spline_table - returns the spline time and maximum speed in cm/s at the given distance in cm along the spline segment
+void AC_WPNav::get_spline_table(float spline_dist, float& spline_time, float& speed_max) const
+{
+    if (_spline_length <= 0.0f) {
+        spline_time = 1.0f;
+        speed_max = _spline_table_speed_max[WPNAV_SPLINE_TABLE_SIZE - 1];
+        return;
+    }
+
+    const float index = constrain_float(spline_dist / _spline_length, 0.0f, 1.0f) * (WPNAV_SPLINE_TABLE_SIZE - 1);
+    const uint8_t i = MIN((uint8_t)index, WPNAV_SPLINE_TABLE_SIZE - 2);
+    const float fraction = index - i;
+
+    spline_time = _spline_table_time[i] + (_spline_table_time[i + 1] - _spline_table_time[i]) * fraction;
+    speed_max = _spline_table_speed_max[i] + (_spline_table_speed_max[i + 1] - _spline_table_speed_max[i]) * fraction;
+}
+
+/// get_corner_accel - returns the maximum lateral acceleration in cm/s/s when following a spline
+float AC_WPNav::get_corner_accel() const
+{
+    if (_wp_accel_c_cms > 0.0f) {
+        return _wp_accel_c_cms;
+    }
+    return 2.0f * _wp_accel_cms;
+}
+
 /// advance_spline_target_along_track - move target location along track from origin to destination
 bool AC_WPNav::advance_spline_target_along_track(float dt)
 {
     if (!_flags.reached_destination) {
         Vector3f target_pos, target_vel;
+        float spline_speed_max;
+
+        // look up the spline time and the speed limit for the curvature from the distance along the segment, the waypoint speed is applied below
+        get_spline_table(_spline_dist, _spline_time, spline_speed_max);
 
         // update target position and velocity from spline calculator
         calc_spline_pos_vel(_spline_time, target_pos, target_vel);
@@ -1085,8 +1232,8 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         }
 
         // update velocity
-        float spline_dist_to_wp = (_destination - target_pos).length();
-        float vel_limit = _wp_speed_cms;
+        float spline_dist_to_wp = MAX(_spline_length - _spline_dist, 0.0f);
+        float vel_limit = MIN(_wp_speed_cms, spline_speed_max);
         if (!is_zero(dt)) {
             vel_limit = MIN(vel_limit, track_leash_slack/dt);
         }
@@ -1102,12 +1249,6 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         // constrain target velocity
         _spline_vel_scaler = constrain_float(_spline_vel_scaler, 0.0f, vel_limit);
 
-        // scale the spline_time by the velocity we've calculated vs the velocity that came out of the spline calculator
-        float target_vel_length = target_vel.length();
-        if (!is_zero(target_vel_length)) {
-            _spline_time_scale = _spline_vel_scaler/target_vel_length;
-        }
-
         // update target position
         target_pos.z += terr_offset;
         _pos_control.set_pos_target(target_pos);
@@ -1115,12 +1256,12 @@ bool AC_WPNav::advance_spline_target_along_track(float dt)
         // update the yaw
         _yaw = RadiansToCentiDegrees(atan2f(target_vel.y,target_vel.x));
 
-        // advance spline time to next step
-        _spline_time += _spline_time_scale*dt;
+        // advance along the spline by the distance travelled at the target velocity
+        _spline_dist += _spline_vel_scaler*dt;
 
         // we will reach the next waypoint in the next step so set reached_destination flag
         // To-Do: is this one step too early?
-        if (_spline_time >= 1.0f) {
+        if (_spline_dist >= _spline_length) {
             _flags.reached_destination = true;
         }
     }
@@ -1231,6 +1372,72 @@ void AC_WPNav::calc_slow_down_distance(float speed_cms, float accel_cmss)
     _slow_down_dist = speed_cms * speed_cms / (4.0f*accel_cmss);
 }
 
+/// calc_track_accel - returns the acceleration in cm/s/s along a straight segment, limited by the horizontal
+///     and vertical accelerations in the same way as _track_accel
+float AC_WPNav::calc_track_accel(const Vector3f& segment) const
+{
+    const float length = segment.length();
+    if (is_zero(length)) {
+        return 0.0f;
+    }
+    const float unit_xy = norm(segment.x, segment.y) / length;
+    const float unit_z = fabsf(segment.z) / length;
+    if (is_zero(unit_z)) {
+        return _wp_accel_cms / unit_xy;
+    }
+    if (is_zero(unit_xy)) {
+        return _wp_accel_z_cms / unit_z;
+    }
+    return MIN(_wp_accel_z_cms / unit_z, _wp_accel_cms / unit_xy);
+}
+
+/// calc_corner_speed - returns the maximum speed in cm/s through a corner between two straight segments
+///     while staying within the waypoint radius of the corner
+float AC_WPNav::calc_corner_speed(const Vector3f& origin, const Vector3f& corner, const Vector3f& next) const
+{
+    const Vector3f dir_in = corner - origin;
+    const Vector3f dir_out = next - corner;
+    const float length_product = dir_in.length() * dir_out.length();
+    if (is_zero(length_product)) {
+        return _wp_speed_cms;
+    }
+
+    // cosine of half the turn angle
+    const float cos_turn = constrain_float((dir_in * dir_out) / length_product, -1.0f, 1.0f);
+    const float cos_half_turn = safe_sqrt((1.0f + cos_turn) * 0.5f);
+    if (cos_half_turn >= 1.0f) {
+        return _wp_speed_cms;
+    }
+
+    // radius of the arc tangent to both segments which passes the corner at the waypoint radius
+    const float radius = _wp_radius_cm * cos_half_turn / (1.0f - cos_half_turn);
+
+    // without a configured corner acceleration, turn as hard as the slower of the two segments can accelerate
+    float accel = _wp_accel_c_cms;
+    if (accel <= 0.0f) {
+        accel = 2.0f * MIN(calc_track_accel(dir_in), calc_track_accel(dir_out));
+    }
+
+    return MIN(safe_sqrt(accel * radius), _wp_speed_cms);
+}
+
+/// calc_lookahead_speed - returns the maximum speed in cm/s through path[1] for a path of straight segments starting at path[0],
+///     so that the vehicle can slow down for each following corner and reach the last point at end_speed
+float AC_WPNav::calc_lookahead_speed(const Vector3f path[], uint8_t num_points, float end_speed) const
+{
+    float speed = end_speed;
+
+    // work backwards from the end, slowing down at the same rate as the target does before a stop,
+    // with the acceleration along each segment that advance_wp_target_along_track() will use on it
+    for (int8_t i = num_points - 2; i >= 1; i--) {
+        const Vector3f segment = path[i + 1] - path[i];
+        speed = safe_sqrt(sq(speed) + segment.length() * 4.0f * calc_track_accel(segment));
+        speed = MIN(speed, calc_corner_speed(path[i - 1], path[i], path[i + 1]));
+    }
+
+    return MIN(speed, _wp_speed_cms);
+}
+
 /// get_slow_down_speed - returns target speed of target point based on distance from the destination (in cm)
 float AC_WPNav::get_slow_down_speed(float dist_from_dest_cm, float accel_cmss)
 {
@@ -42,6 +42,12 @@
 
 #define WPNAV_RANGEFINDER_FILT_Z         0.25f      // range finder distance filtered at 0.25hz
 
+#define WPNAV_LOOKAHEAD_MAX                  8      // maximum number of waypoints after the destination used to plan the speed through a fast waypoint
+
+#define WPNAV_SPLINE_TABLE_SIZE             33      // number of evenly spaced points along a spline segment in its arc length tables
+#define WPNAV_SPLINE_LENGTH_STEPS          128      // number of chords used to measure the arc length of a spline segment
+#define WPNAV_SPLINE_SPEED_MAX        10000.0f      // speed limit in cm/s kept in the spline speed table where the segment is straight, above any waypoint speed
+
 class AC_WPNav
 {
 public:
@@ -178,6 +184,12 @@ public:
     /// set_fast_waypoint - set to true to ignore the waypoint radius and consider the waypoint 'reached' the moment the intermediate point reaches it
     void set_fast_waypoint(bool fast) { _flags.fast_waypoint = fast; }
 
+    /// set_wp_lookahead - plans the speed at which the intermediate point passes a fast waypoint from the straight segments which follow it
+    ///     next_destinations holds up to WPNAV_LOOKAHEAD_MAX waypoints after the destination, in order
+    ///     stop_at_end should be true if the vehicle stops at the last of them
+    ///     relies on set_wp_destination or set_wp_origin_and_destination having been called first
+    void set_wp_lookahead(const Location_Class next_destinations[], uint8_t num_destinations, bool stop_at_end);
+
     /// update_wpnav - run the wp controller - should be called at 100hz or higher
     bool update_wpnav();
 
@@ -286,6 +298,18 @@ protected:
     /// get_slow_down_speed - returns target speed of target point based on distance from the destination (in cm)
     float get_slow_down_speed(float dist_from_dest_cm, float accel_cmss);
 
+    /// calc_track_accel - returns the acceleration in cm/s/s along a straight segment, limited by the horizontal
+    ///     and vertical accelerations in the same way as _track_accel
+    float calc_track_accel(const Vector3f& segment) const;
+
+    /// calc_corner_speed - returns the maximum speed in cm/s through a corner between two straight segments
+    ///     while staying within the waypoint radius of the corner
+    float calc_corner_speed(const Vector3f& origin, const Vector3f& corner, const Vector3f& next) const;
+
+    /// calc_lookahead_speed - returns the maximum speed in cm/s through path[1] for a path of straight segments starting at path[0],
+    ///     so that the vehicle can slow down for each following corner and reach the last point at end_speed
+    float calc_lookahead_speed(const Vector3f path[], uint8_t num_points, float end_speed) const;
+
     /// spline protected functions
 
     /// update_spline_solution - recalculates hermite_spline_solution grid
@@ -299,6 +323,16 @@ protected:
     /// 	relies on update_spline_solution being called since the previous
     void calc_spline_pos_vel(float spline_time, Vector3f& position, Vector3f& velocity);
 
+    /// update_spline_table - measures the length of the spline segment and fills the spline time and maximum speed tables by distance along it
+    ///     relies on update_spline_solution having set the hermite spline solution
+    void update_spline_table();
+
+    /// get_spline_table - returns the spline time and maximum speed in cm/s at the given distance in cm along the spline segment
+    void get_spline_table(float spline_dist, float& spline_time, float& speed_max) const;
+
+    /// get_corner_accel - returns the maximum lateral acceleration in cm/s/s when following a spline
+    float get_corner_accel() const;
+
     // get terrain's altitude (in cm above the ekf origin) at the current position (+ve means terrain below vehicle is above ekf origin's altitude)
     bool get_terrain_offset(float& offset_cm);
 
@@ -325,6 +359,7 @@ protected:
     AP_Float    _wp_radius_cm;          // distance from a waypoint in cm that, when crossed, indicates the wp has been reached
     AP_Float    _wp_accel_cms;          // horizontal acceleration in cm/s/s during missions
     AP_Float    _wp_accel_z_cms;        // vertical acceleration in cm/s/s during missions
+    AP_Float    _wp_accel_c_cms;        // maximum lateral acceleration in cm/s/s along spline segments, zero to use twice _wp_accel_cms
 
     // loiter controller internal variables
     int16_t     _pilot_accel_fwd_cms; 	// pilot's desired acceleration forward (body-frame)
@@ -344,10 +379,14 @@ protected:
     float       _track_speed;           // speed in cm/s along track
     float       _track_leash_length;    // leash length along track
     float       _slow_down_dist;        // vehicle should begin to slow down once it is within this distance from the destination
+    float       _fast_wp_speed_cms;     // speed in cm/s at which the target passes a fast waypoint, zero for no limit
 
     // spline variables
     float       _spline_time;           // current spline time between origin and destination
-    float       _spline_time_scale;     // current spline time between origin and destination
+    float       _spline_dist;           // current distance in cm along the spline segment from the origin
+    float       _spline_length;         // length in cm of the spline segment
+    float       _spline_table_time[WPNAV_SPLINE_TABLE_SIZE];        // spline time at evenly spaced distances along the segment
+    float       _spline_table_speed_max[WPNAV_SPLINE_TABLE_SIZE];   // maximum speed in cm/s at evenly spaced distances along the segment, limited by the curvature ahead but not by the waypoint speed
     Vector3f    _spline_origin_vel;     // the target velocity vector at the origin of the spline segment
     Vector3f    _spline_destination_vel;// the target velocity vector at the destination point of the spline segment
     Vector3f    _hermite_spline_solution[4]; // array describing spline path between origin and destination
@@ -30,7 +30,7 @@
 
 #define VEHICLE_TIMEOUT_MS              5000   // if no updates in this time, drop it from the list
 #define ADSB_VEHICLE_LIST_SIZE_DEFAULT  25
-#define ADSB_VEHICLE_LIST_SIZE_MAX      100
+#define ADSB_VEHICLE_LIST_SIZE_MAX      250
 #define ADSB_CHAN_TIMEOUT_MS            15000
 
 #if APM_BUILD_TYPE(APM_BUILD_ArduPlane)
@@ -55,7 +55,7 @@ const AP_Param::GroupInfo AP_ADSB::var_info[] = {
     // @Param: LIST_MAX
     // @DisplayName: ADSB vehicle list size
     // @Description: ADSB list size of nearest vehicles. Longer lists take longer to refresh with lower SRx_ADSB values.
-    // @Range: 1 100
+    // @Range: 1 250
     // @User: Advanced
     AP_GROUPINFO("LIST_MAX",   2, AP_ADSB, in_state.list_size_param, ADSB_VEHICLE_LIST_SIZE_DEFAULT),
 
@@ -129,10 +129,21 @@ void AP_ADSB::init(void)
         in_state.list_size = in_state.list_size_param;
         in_state.vehicle_list = new adsb_vehicle_t[in_state.list_size];
 
-        if (in_state.vehicle_list == nullptr) {
+        // keep the ICAO index at most half full so probe sequences stay short
+        uint16_t index_size = 2;
+        while (index_size < 2 * in_state.list_size) {
+            index_size <<= 1;
+        }
+        in_state.icao_index = new uint16_t[index_size];
+        in_state.icao_index_mask = index_size - 1;
+
+        if (in_state.vehicle_list == nullptr || in_state.icao_index == nullptr) {
             // dynamic RAM allocation of _vehicle_list[] failed, disable gracefully
             hal.console->printf("Unable to initialize ADS-B vehicle list\n");
+            deinit();
             _enabled.set_and_notify(0);
+        } else {
+            memset(in_state.icao_index, 0, index_size * sizeof(in_state.icao_index[0]));
         }
     }
 
@@ -153,6 +164,10 @@ void AP_ADSB::deinit(void)
         delete [] in_state.vehicle_list;
         in_state.vehicle_list = nullptr;
     }
+    if (in_state.icao_index != nullptr) {
+        delete [] in_state.icao_index;
+        in_state.icao_index = nullptr;
+    }
 }
 
 /*
@@ -250,7 +265,9 @@ void AP_ADSB::update(void)
 
 /*
  * determine index and distance of furthest vehicle. This is
- * used to bump it off when a new closer aircraft is detected
+ * used to bump it off when a new closer aircraft is detected.
+ * The distances are taken from our current location: we and the
+ * other aircraft may have moved since they were last refreshed
  */
 void AP_ADSB::determine_furthest_aircraft(void)
 {
@@ -295,8 +312,14 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
             furthest_vehicle_distance = 0;
             furthest_vehicle_index = 0;
         }
+        icao_index_remove(in_state.vehicle_list[index].info.ICAO_address);
         if (index != (in_state.vehicle_count-1)) {
             in_state.vehicle_list[index] = in_state.vehicle_list[in_state.vehicle_count-1];
+            icao_index_set(in_state.vehicle_list[index].info.ICAO_address, index);
+            if (furthest_vehicle_index == in_state.vehicle_count-1) {
+                // the furthest vehicle was the one moved
+                furthest_vehicle_index = index;
+            }
         }
         // TODO: is memset needed? When we decrement the index we essentially forget about it
         memset(&in_state.vehicle_list[in_state.vehicle_count-1], 0, sizeof(adsb_vehicle_t));
@@ -311,8 +334,16 @@ void AP_ADSB::delete_vehicle(const uint16_t index)
  */
 bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
 {
-    for (uint16_t i = 0; i < in_state.vehicle_count; i++) {
-        if (in_state.vehicle_list[i].info.ICAO_address == vehicle.info.ICAO_address) {
+    if (in_state.icao_index == nullptr) {
+        return false;
+    }
+
+    const uint32_t icao = vehicle.info.ICAO_address;
+    for (uint16_t slot = icao_index_slot(icao);
+         in_state.icao_index[slot] != 0;
+         slot = (slot + 1) & in_state.icao_index_mask) {
+        const uint16_t i = in_state.icao_index[slot] - 1;
+        if (in_state.vehicle_list[i].info.ICAO_address == icao) {
             *index = i;
             return true;
         }
@@ -320,6 +351,68 @@ bool AP_ADSB::find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const
     return false;
 }
 
+/*
+ * home slot of an ICAO address in the index. Fibonacci hashing spreads
+ * addresses allocated in blocks over the whole table
+ */
+uint16_t AP_ADSB::icao_index_slot(const uint32_t icao) const
+{
+    return ((icao * 2654435761U) >> 16) & in_state.icao_index_mask;
+}
+
+/*
+ * point the index entry for icao at vehicle_list[index], adding the entry
+ * if the address isn't indexed yet
+ */
+void AP_ADSB::icao_index_set(const uint32_t icao, const uint16_t index)
+{
+    if (in_state.icao_index == nullptr) {
+        return;
+    }
+
+    uint16_t slot = icao_index_slot(icao);
+    while (in_state.icao_index[slot] != 0 &&
+           in_state.vehicle_list[in_state.icao_index[slot] - 1].info.ICAO_address != icao) {
+        slot = (slot + 1) & in_state.icao_index_mask;
+    }
+    in_state.icao_index[slot] = index + 1;
+}
+
+/*
+ * remove icao from the index. Entries following it in the probe sequence
+ * are shifted back so that they remain reachable without tombstones
+ */
+void AP_ADSB::icao_index_remove(const uint32_t icao)
+{
+    if (in_state.icao_index == nullptr) {
+        return;
+    }
+
+    const uint16_t mask = in_state.icao_index_mask;
+    uint16_t hole = icao_index_slot(icao);
+    while (true) {
+        if (in_state.icao_index[hole] == 0) {
+            // not indexed
+            return;
+        }
+        if (in_state.vehicle_list[in_state.icao_index[hole] - 1].info.ICAO_address == icao) {
+            break;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    for (uint16_t next = (hole + 1) & mask; in_state.icao_index[next] != 0; next = (next + 1) & mask) {
+        const uint16_t home = icao_index_slot(in_state.vehicle_list[in_state.icao_index[next] - 1].info.ICAO_address);
+        // the entry can fill the hole unless its home slot lies between
+        // the hole and its current slot
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            in_state.icao_index[hole] = in_state.icao_index[next];
+            hole = next;
+        }
+    }
+    in_state.icao_index[hole] = 0;
+}
+
 /*
  * Update the vehicle list. If the vehicle is already in the
  * list then it will update it, otherwise it will be added.
@@ -413,8 +506,18 @@ void AP_ADSB::handle_vehicle(const mavlink_message_t* packet)
  */
 void AP_ADSB::set_vehicle(const uint16_t index, const adsb_vehicle_t &vehicle)
 {
-    if (index < in_state.list_size) {
-        in_state.vehicle_list[index] = vehicle;
+    if (index >= in_state.list_size) {
+        return;
+    }
+
+    const bool is_new = index >= in_state.vehicle_count;
+    const bool is_replacing = !is_new && in_state.vehicle_list[index].info.ICAO_address != vehicle.info.ICAO_address;
+    if (is_replacing) {
+        icao_index_remove(in_state.vehicle_list[index].info.ICAO_address);
+    }
+    in_state.vehicle_list[index] = vehicle;
+    if (is_new || is_replacing) {
+        icao_index_set(vehicle.info.ICAO_address, index);
     }
 }
 
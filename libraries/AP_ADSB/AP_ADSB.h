@@ -88,6 +88,11 @@ private:
     // return index of given vehicle if ICAO_ADDRESS matches. return -1 if no match
     bool find_index(const adsb_vehicle_t &vehicle, uint16_t *index) const;
 
+    // ICAO address hash index into vehicle_list
+    uint16_t icao_index_slot(const uint32_t icao) const;
+    void icao_index_set(const uint32_t icao, const uint16_t index);
+    void icao_index_remove(const uint32_t icao);
+
     // remove a vehicle from the list
     void delete_vehicle(const uint16_t index);
 
@@ -127,6 +132,12 @@ private:
         uint16_t    vehicle_count;
         AP_Int32    list_radius;
 
+        // open addressed hash of ICAO addresses, with linear probing. Each
+        // slot holds an index into vehicle_list plus one, 0 if the slot is
+        // empty. Sized to a power of two at least twice list_size
+        uint16_t    *icao_index = nullptr;
+        uint16_t    icao_index_mask;
+
         // streamrate stuff
         uint32_t    send_start_ms[MAVLINK_COMM_NUM_BUFFERS];
         uint16_t    send_index[MAVLINK_COMM_NUM_BUFFERS];
@@ -133,15 +133,29 @@ void AP_Avoidance::init(void)
     debug("ADSB initialisation: %d obstacles", _obstacles_max.get());
     if (_obstacles == nullptr) {
         _obstacles = new AP_Avoidance::Obstacle[_obstacles_max];
+        _relative_storage = new float[8 * _obstacles_max];
 
-        if (_obstacles == nullptr) {
+        if (_obstacles == nullptr || _relative_storage == nullptr) {
             // dynamic RAM allocation of _obstacles[] failed, disable gracefully
             hal.console->printf("Unable to initialize Avoidance obstacle list\n");
+            delete [] _obstacles;
+            _obstacles = nullptr;
+            delete [] _relative_storage;
+            _relative_storage = nullptr;
             // disable ourselves to avoid repeated allocation attempts
             _enabled.set(0);
             return;
         }
         _obstacles_allocated = _obstacles_max;
+
+        _relative.pos_n             = &_relative_storage[0 * _obstacles_allocated];
+        _relative.pos_e             = &_relative_storage[1 * _obstacles_allocated];
+        _relative.vel_n             = &_relative_storage[2 * _obstacles_allocated];
+        _relative.vel_e             = &_relative_storage[3 * _obstacles_allocated];
+        _relative.time_horizon_fail = &_relative_storage[4 * _obstacles_allocated];
+        _relative.time_horizon_warn = &_relative_storage[5 * _obstacles_allocated];
+        _relative.closest_xy_fail   = &_relative_storage[6 * _obstacles_allocated];
+        _relative.closest_xy_warn   = &_relative_storage[7 * _obstacles_allocated];
     }
     _obstacle_count = 0;
     _last_state_change_ms = 0;
@@ -158,6 +172,8 @@ void AP_Avoidance::deinit(void)
     if (_obstacles != nullptr) {
         delete [] _obstacles;
         _obstacles = nullptr;
+        delete [] _relative_storage;
+        _relative_storage = nullptr;
         _obstacles_allocated = 0;
         handle_recovery(AP_AVOIDANCE_RECOVERY_RTL);
     }
@@ -290,6 +306,39 @@ float closest_approach_xy(const Location &my_loc,
     return ret;
 }
 
+/*
+  closest horizontal approach for a batch of obstacles. Equivalent to
+  closest_approach_xy() with positions and velocities already relative to
+  us: the time of closest approach is clamped to [0, time_horizon] and
+  the miss distance taken at that time. The first loop is branch free so
+  the compiler can vectorise it; the square roots are taken separately as
+  sqrtf() may set errno
+ */
+void closest_approach_xy_batch(const uint8_t count,
+                               const float *pos_n,
+                               const float *pos_e,
+                               const float *vel_n,
+                               const float *vel_e,
+                               const float *time_horizon,
+                               float *ret)
+{
+    for (uint8_t i=0; i<count; i++) {
+        const float vel_sq = vel_n[i] * vel_n[i] + vel_e[i] * vel_e[i];
+        const float pos_dot_vel = pos_n[i] * vel_n[i] + pos_e[i] * vel_e[i];
+        // when there is no relative velocity pos_dot_vel is also zero and
+        // the closest approach is the current distance
+        float t = -pos_dot_vel / (vel_sq > FLT_EPSILON ? vel_sq : FLT_EPSILON);
+        t = t < 0.0f ? 0.0f : t;
+        t = t > time_horizon[i] ? time_horizon[i] : t;
+        const float miss_n = pos_n[i] + vel_n[i] * t;
+        const float miss_e = pos_e[i] + vel_e[i] * t;
+        ret[i] = miss_n * miss_n + miss_e * miss_e;
+    }
+    for (uint8_t i=0; i<count; i++) {
+        ret[i] = sqrtf(ret[i]);
+    }
+}
+
 // returns the closest these objects will get in the body z axis (in metres)
 float closest_approach_z(const Location &my_loc,
                          const Vector3f &my_vel,
@@ -318,9 +367,14 @@ float closest_approach_z(const Location &my_loc,
     return ret/100.0f;
 }
 
+/*
+  update the threat level of an obstacle. Horizontal closest approaches
+  must have been computed into _relative for this obstacle's index
+ */
 void AP_Avoidance::update_threat_level(const Location &my_loc,
                                        const Vector3f &my_vel,
-                                       AP_Avoidance::Obstacle &obstacle)
+                                       AP_Avoidance::Obstacle &obstacle,
+                                       const uint8_t index)
 {
 
     Location &obstacle_loc = obstacle._location;
@@ -329,11 +383,11 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
     obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_NONE;
 
     const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
-    float closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _fail_time_horizon + obstacle_age/1000);
+    float closest_xy = _relative.closest_xy_fail[index];
     if (closest_xy < _fail_distance_xy) {
         obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_HIGH;
     } else {
-        closest_xy = closest_approach_xy(my_loc, my_vel, obstacle_loc, obstacle_vel, _warn_time_horizon + obstacle_age/1000);
+        closest_xy = _relative.closest_xy_warn[index];
         if (closest_xy < _warn_distance_xy) {
             obstacle.threat_level = MAV_COLLISION_THREAT_LEVEL_LOW;
         }
@@ -362,7 +416,7 @@ void AP_Avoidance::update_threat_level(const Location &my_loc,
     // level is none - but only *once the GCS has been informed*!
     obstacle.closest_approach_xy = closest_xy;
     obstacle.closest_approach_z = closest_z;
-    float current_distance = get_distance(my_loc, obstacle_loc);
+    float current_distance = norm(_relative.pos_n[index], _relative.pos_e[index]);
     obstacle.distance_to_closest_approach = current_distance - closest_xy;
     Vector2f net_velocity_ne = Vector2f(my_vel[0] - obstacle_vel[0], my_vel[1] - obstacle_vel[1]);
     obstacle.time_to_closest_approach = 0.0f;
@@ -441,6 +495,32 @@ void AP_Avoidance::check_for_threats()
         return;
     }
 
+    // move all obstacles into our local frame, sharing a single longitude
+    // scale, then compute their horizontal closest approach in one pass
+    const float scale = longitude_scale(my_loc);
+    const uint32_t now = AP_HAL::millis();
+    for (uint8_t i=0; i<_obstacle_count; i++) {
+        const AP_Avoidance::Obstacle &obstacle = _obstacles[i];
+        _relative.pos_n[i] = (obstacle._location.lat - my_loc.lat) * LOCATION_SCALING_FACTOR;
+        _relative.pos_e[i] = (obstacle._location.lng - my_loc.lng) * LOCATION_SCALING_FACTOR * scale;
+        _relative.vel_n[i] = obstacle._velocity[0] - my_vel[0];
+        _relative.vel_e[i] = obstacle._velocity[1] - my_vel[1];
+        // horizons are whole seconds, extended by the age of the data
+        const uint32_t obstacle_age_s = (now - obstacle.timestamp_ms) / 1000;
+        _relative.time_horizon_fail[i] = (uint8_t)(_fail_time_horizon + obstacle_age_s);
+        _relative.time_horizon_warn[i] = (uint8_t)(_warn_time_horizon + obstacle_age_s);
+    }
+    closest_approach_xy_batch(_obstacle_count,
+                              _relative.pos_n, _relative.pos_e,
+                              _relative.vel_n, _relative.vel_e,
+                              _relative.time_horizon_fail,
+                              _relative.closest_xy_fail);
+    closest_approach_xy_batch(_obstacle_count,
+                              _relative.pos_n, _relative.pos_e,
+                              _relative.vel_n, _relative.vel_e,
+                              _relative.time_horizon_warn,
+                              _relative.closest_xy_warn);
+
     // we always check all obstacles to see if they are threats since it
     // is most likely our own position and/or velocity have changed
     // determine the current most-serious-threat
@@ -451,7 +531,7 @@ void AP_Avoidance::check_for_threats()
         const uint32_t obstacle_age = AP_HAL::millis() - obstacle.timestamp_ms;
         debug("i=%d src_id=%d timestamp=%u age=%d", i, obstacle.src_id, obstacle.timestamp_ms, obstacle_age);
 
-        update_threat_level(my_loc, my_vel, obstacle);
+        update_threat_level(my_loc, my_vel, obstacle, i);
         debug("   threat-level=%d", obstacle.threat_level);
 
         // ignore any really old data:
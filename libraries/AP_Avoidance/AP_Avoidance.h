@@ -163,7 +163,8 @@ private:
     void check_for_threats();
     void update_threat_level(const Location &my_loc,
                              const Vector3f &my_vel,
-                             AP_Avoidance::Obstacle &obstacle);
+                             AP_Avoidance::Obstacle &obstacle,
+                             uint8_t index);
 
     // calls into the AP_ADSB library to retrieve vehicle data
     void get_adsb_samples();
@@ -174,6 +175,23 @@ private:
 
     // internal variables
     AP_Avoidance::Obstacle *_obstacles;
+
+    // horizontal state of each obstacle relative to us, in metres and
+    // m/s, north and east. Kept as one array per component, parallel to
+    // _obstacles, so closest approach is evaluated over all obstacles in
+    // one pass by closest_approach_xy_batch()
+    struct {
+        float *pos_n;
+        float *pos_e;
+        float *vel_n;
+        float *vel_e;
+        float *time_horizon_fail;
+        float *time_horizon_warn;
+        float *closest_xy_fail;
+        float *closest_xy_warn;
+    } _relative;
+    float *_relative_storage = nullptr;
+
     uint8_t _obstacles_allocated;
     uint8_t _obstacle_count;
     int8_t _current_most_serious_threat;
@@ -206,6 +224,16 @@ float closest_approach_xy(const Location &my_loc,
                           const Vector3f &obstacle_vel,
                           uint8_t time_horizon);
 
+// closest horizontal approach, in metres, within time_horizon seconds of
+// count obstacles given their position and velocity relative to us
+void closest_approach_xy_batch(uint8_t count,
+                               const float *pos_n,
+                               const float *pos_e,
+                               const float *vel_n,
+                               const float *vel_e,
+                               const float *time_horizon,
+                               float *ret);
+
 float closest_approach_z(const Location &my_loc,
                          const Vector3f &my_vel,
                          const Location &obstacle_loc,
@@ -0,0 +1,86 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Avoidance/AP_Avoidance.h>
+
+#define MAX_OBSTACLES 128
+
+/*
+  obstacles scattered within about 2km of us, each flying at up to 50m/s
+ */
+static void setup_obstacles(Location &my_loc, Vector3f &my_vel,
+                            Location *locs, Vector3f *vels, uint8_t count)
+{
+    my_loc = {};
+    my_loc.lat = -353632610;
+    my_loc.lng = 1491652300;
+    my_vel = Vector3f(10.0f, 5.0f, 0.0f);
+
+    for (uint8_t i = 0; i < count; i++) {
+        locs[i] = my_loc;
+        locs[i].lat += (int32_t)(i * 7919 % 40000) - 20000;
+        locs[i].lng += (int32_t)(i * 104729 % 40000) - 20000;
+        vels[i] = Vector3f((float)(i * 31 % 100) - 50.0f,
+                           (float)(i * 17 % 100) - 50.0f,
+                           0.0f);
+    }
+}
+
+/*
+  one Location based closest_approach_xy() call per obstacle, as done
+  before the relative state was kept in arrays
+ */
+static void BM_ClosestApproachXY(benchmark::State& state)
+{
+    const uint8_t count = state.range_x();
+    Location my_loc;
+    Vector3f my_vel;
+    Location locs[MAX_OBSTACLES];
+    Vector3f vels[MAX_OBSTACLES];
+    float ret[MAX_OBSTACLES];
+
+    setup_obstacles(my_loc, my_vel, locs, vels, count);
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < count; i++) {
+            ret[i] = closest_approach_xy(my_loc, my_vel, locs[i], vels[i], 30);
+        }
+        gbenchmark_escape(ret);
+    }
+}
+
+/*
+  conversion to the local frame followed by closest_approach_xy_batch(),
+  as done by AP_Avoidance::check_for_threats()
+ */
+static void BM_ClosestApproachXYBatch(benchmark::State& state)
+{
+    const uint8_t count = state.range_x();
+    Location my_loc;
+    Vector3f my_vel;
+    Location locs[MAX_OBSTACLES];
+    Vector3f vels[MAX_OBSTACLES];
+    float pos_n[MAX_OBSTACLES], pos_e[MAX_OBSTACLES];
+    float vel_n[MAX_OBSTACLES], vel_e[MAX_OBSTACLES];
+    float time_horizon[MAX_OBSTACLES];
+    float ret[MAX_OBSTACLES];
+
+    setup_obstacles(my_loc, my_vel, locs, vels, count);
+
+    while (state.KeepRunning()) {
+        const float scale = longitude_scale(my_loc);
+        for (uint8_t i = 0; i < count; i++) {
+            pos_n[i] = (locs[i].lat - my_loc.lat) * LOCATION_SCALING_FACTOR;
+            pos_e[i] = (locs[i].lng - my_loc.lng) * LOCATION_SCALING_FACTOR * scale;
+            vel_n[i] = vels[i].x - my_vel.x;
+            vel_e[i] = vels[i].y - my_vel.y;
+            time_horizon[i] = 30;
+        }
+        closest_approach_xy_batch(count, pos_n, pos_e, vel_n, vel_e, time_horizon, ret);
+        gbenchmark_escape(ret);
+    }
+}
+
+BENCHMARK(BM_ClosestApproachXY)->Range(8, MAX_OBSTACLES);
+BENCHMARK(BM_ClosestApproachXYBatch)->Range(8, MAX_OBSTACLES);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,129 @@
+#include <AP_gtest.h>
+
+#include <AP_Avoidance/AP_Avoidance.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define NUM_OBSTACLES 100
+
+static const uint8_t time_horizon = 30;
+
+static Location origin()
+{
+    Location loc {};
+    loc.lat = -353632610;
+    loc.lng = 1491652300;
+    return loc;
+}
+
+static float random_float(float range)
+{
+    return range * ((float)rand() / RAND_MAX * 2.0f - 1.0f);
+}
+
+/*
+  check closest_approach_xy_batch() against closest_approach_xy() for
+  obstacles at locs[] flying at vels[], with us at origin() flying at
+  my_vel
+ */
+static void check_batch(const Vector3f &my_vel,
+                        const Location *locs, const Vector3f *vels,
+                        uint8_t count)
+{
+    const Location my_loc = origin();
+    float pos_n[NUM_OBSTACLES], pos_e[NUM_OBSTACLES];
+    float vel_n[NUM_OBSTACLES], vel_e[NUM_OBSTACLES];
+    float horizon[NUM_OBSTACLES];
+    float ret[NUM_OBSTACLES];
+
+    for (uint8_t i = 0; i < count; i++) {
+        // the same scaling as closest_approach_xy() uses
+        const Vector2f pos = -location_diff(locs[i], my_loc);
+        pos_n[i] = pos.x;
+        pos_e[i] = pos.y;
+        vel_n[i] = vels[i].x - my_vel.x;
+        vel_e[i] = vels[i].y - my_vel.y;
+        horizon[i] = time_horizon;
+    }
+
+    closest_approach_xy_batch(count, pos_n, pos_e, vel_n, vel_e, horizon, ret);
+
+    for (uint8_t i = 0; i < count; i++) {
+        const float expected = closest_approach_xy(my_loc, my_vel, locs[i], vels[i], time_horizon);
+        EXPECT_NEAR(expected, ret[i], 0.01f + expected * 1e-4f) << "obstacle " << (unsigned)i;
+    }
+}
+
+TEST(ClosestApproachXYBatch, Random)
+{
+    Location locs[NUM_OBSTACLES];
+    Vector3f vels[NUM_OBSTACLES];
+
+    srand(1);
+    const Vector3f my_vel(random_float(30), random_float(30), 0);
+    for (uint8_t i = 0; i < NUM_OBSTACLES; i++) {
+        locs[i] = origin();
+        location_offset(locs[i], random_float(2000), random_float(2000));
+        vels[i] = Vector3f(random_float(50), random_float(50), 0);
+    }
+
+    check_batch(my_vel, locs, vels, NUM_OBSTACLES);
+}
+
+/*
+  obstacles flying straight at us, straight away from us and alongside
+  us on a parallel track
+ */
+TEST(ClosestApproachXYBatch, Parallel)
+{
+    Location locs[NUM_OBSTACLES];
+    Vector3f vels[NUM_OBSTACLES];
+
+    srand(2);
+    const Vector3f my_vel(random_float(30), random_float(30), 0);
+    for (uint8_t i = 0; i < NUM_OBSTACLES; i++) {
+        const float ofs_n = random_float(2000);
+        const float ofs_e = random_float(2000);
+        const float speed = random_float(20);
+        locs[i] = origin();
+        location_offset(locs[i], ofs_n, ofs_e);
+        switch (i % 3) {
+        case 0:
+            // along the line between us, towards or away from us
+            vels[i] = my_vel + Vector3f(ofs_n, ofs_e, 0).normalized() * speed;
+            break;
+        case 1:
+            // parallel to our track, at a different speed
+            vels[i] = my_vel + my_vel.normalized() * speed;
+            break;
+        default:
+            // same velocity as us
+            vels[i] = my_vel;
+            break;
+        }
+    }
+
+    check_batch(my_vel, locs, vels, NUM_OBSTACLES);
+}
+
+TEST(ClosestApproachXYBatch, ZeroVelocity)
+{
+    Location locs[NUM_OBSTACLES];
+    Vector3f vels[NUM_OBSTACLES];
+
+    srand(3);
+    for (uint8_t i = 0; i < NUM_OBSTACLES; i++) {
+        locs[i] = origin();
+        location_offset(locs[i], random_float(2000), random_float(2000));
+        vels[i].zero();
+    }
+    // one obstacle right on top of us
+    locs[0] = origin();
+
+    // neither of us moving
+    check_batch(Vector3f(), locs, vels, NUM_OBSTACLES);
+    // only us moving
+    check_batch(Vector3f(12.0f, -7.0f, 0), locs, vels, NUM_OBSTACLES);
+}
+
+AP_GTEST_MAIN()
@@ -414,6 +414,7 @@ Compass::Compass(void) :
     _compass_cal_autoreboot(false),
     _cal_complete_requires_reboot(false),
     _cal_has_run(false),
+    _cal_io_registered(false),
     _backend_count(0),
     _compass_count(0),
     _board_orientation(ROTATION_NONE),
@@ -307,6 +307,7 @@ private:
     bool _start_calibration(uint8_t i, bool retry=false, float delay_sec=0.0f);
     bool _start_calibration_mask(uint8_t mask, bool retry=false, bool autosave=false, float delay_sec=0.0f, bool autoreboot=false);
     bool _auto_reboot() { return _compass_cal_autoreboot; }
+    void _calibration_io_update();
 
 
     //keep track of which calibrators have been saved
@@ -317,6 +318,7 @@ private:
     bool _compass_cal_autoreboot;
     bool _cal_complete_requires_reboot;
     bool _cal_has_run;
+    bool _cal_io_registered;
 
     // backend objects
     AP_Compass_Backend *_backends[COMPASS_MAX_BACKEND];
@@ -11,6 +11,12 @@ Compass::compass_cal_update()
 {
     bool running = false;
 
+    if (!_cal_io_registered) {
+        // the calibration fits are run from the IO thread
+        _cal_io_registered = true;
+        hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&Compass::_calibration_io_update, void));
+    }
+
     for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
         bool failure;
         _calibrator[i].update(failure);
@@ -41,6 +47,14 @@ Compass::compass_cal_update()
     }
 }
 
+void
+Compass::_calibration_io_update()
+{
+    for (uint8_t i=0; i<COMPASS_MAX_INSTANCES; i++) {
+        _calibrator[i].run_fit_step();
+    }
+}
+
 bool
 Compass::_start_calibration(uint8_t i, bool retry, float delay)
 {
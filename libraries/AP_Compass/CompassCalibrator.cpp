@@ -55,6 +55,11 @@
  *
  * The fitting algorithm used is Levenberg-Marquardt. See also:
  * http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm
+ *
+ * When the HAL provides semaphores the fit steps are run from the IO thread
+ * through run_fit_step(), so that calibrating several compasses at once does
+ * not load the main loop. update() then only reports failures back to the
+ * caller.
  */
 
 #include "CompassCalibrator.h"
@@ -77,24 +82,43 @@ extern const AP_HAL::HAL& hal;
 
 CompassCalibrator::CompassCalibrator():
 _tolerance(COMPASS_CAL_DEFAULT_TOLERANCE),
-_sample_buffer(nullptr)
+_sample_buffer(nullptr),
+_sem(nullptr),
+_fit_failed(false)
 {
     clear();
 }
 
 void CompassCalibrator::clear() {
+    if (_sem != nullptr && !_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
     set_status(COMPASS_CAL_NOT_STARTED);
+    _fit_failed = false;
+    if (_sem != nullptr) {
+        _sem->give();
+    }
 }
 
 void CompassCalibrator::start(bool retry, float delay) {
     if(running()) {
         return;
     }
+    if (_sem == nullptr) {
+        _sem = hal.util->new_semaphore();
+    }
+    if (_sem != nullptr && !_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
     _attempt = 1;
     _retry = retry;
     _delay_start_sec = delay;
     _start_time_ms = AP_HAL::millis();
+    _fit_failed = false;
     set_status(COMPASS_CAL_WAITING_TO_START);
+    if (_sem != nullptr) {
+        _sem->give();
+    }
 }
 
 void CompassCalibrator::get_calibration(Vector3f &offsets, Vector3f &diagonals, Vector3f &offdiagonals) {
@@ -127,6 +151,11 @@ float CompassCalibrator::get_completion_percent() const {
 }
 
 void CompassCalibrator::update_completion_mask(const Vector3f& v)
+{
+    update_completion_mask(_completion_mask, v);
+}
+
+void CompassCalibrator::update_completion_mask(completion_mask_t &mask, const Vector3f& v)
 {
     Matrix3f softiron{
         _params.diag.x,    _params.offdiag.x, _params.offdiag.y,
@@ -138,15 +167,19 @@ void CompassCalibrator::update_completion_mask(const Vector3f& v)
     if (section < 0) {
         return;
     }
-    _completion_mask[section / 8] |= 1 << (section % 8);
+    mask[section / 8] |= 1 << (section % 8);
 }
 
 void CompassCalibrator::update_completion_mask()
 {
-    memset(_completion_mask, 0, sizeof(_completion_mask));
+    // rebuild the mask aside, as it may be read by the main loop while
+    // the fit runs on the IO thread
+    completion_mask_t mask;
+    memset(mask, 0, sizeof(mask));
     for (int i = 0; i < _samples_collected; i++) {
-        update_completion_mask(_sample_buffer[i].get());
+        update_completion_mask(mask, _sample_buffer[i].get());
     }
+    memcpy(_completion_mask, mask, sizeof(mask));
 }
 
 CompassCalibrator::completion_mask_t& CompassCalibrator::get_completion_mask()
@@ -157,8 +190,14 @@ CompassCalibrator::completion_mask_t& CompassCalibrator::get_completion_mask()
 bool CompassCalibrator::check_for_timeout() {
     uint32_t tnow = AP_HAL::millis();
     if(running() && tnow - _last_sample_ms > 1000) {
+        if (_sem != nullptr && !_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+            return false;
+        }
         _retry = false;
         set_status(COMPASS_CAL_FAILED);
+        if (_sem != nullptr) {
+            _sem->give();
+        }
         return true;
     }
     return false;
@@ -167,6 +206,16 @@ bool CompassCalibrator::check_for_timeout() {
 void CompassCalibrator::new_sample(const Vector3f& sample) {
     _last_sample_ms = AP_HAL::millis();
 
+    if (_status == COMPASS_CAL_NOT_STARTED) {
+        return;
+    }
+
+    // samples are not collected while fitting, so there is no point
+    // in waiting for the IO thread to release the buffer
+    if (_sem != nullptr && !_sem->take_nonblocking()) {
+        return;
+    }
+
     if(_status == COMPASS_CAL_WAITING_TO_START) {
         set_status(COMPASS_CAL_RUNNING_STEP_ONE);
     }
@@ -174,17 +223,57 @@ void CompassCalibrator::new_sample(const Vector3f& sample) {
     if(running() && _samples_collected < COMPASS_CAL_NUM_SAMPLES && accept_sample(sample)) {
         update_completion_mask(sample);
         _sample_buffer[_samples_collected].set(sample);
+        const Vector3f stored = _sample_buffer[_samples_collected].get();
+        _sample_sum += Vector3d(stored.x, stored.y, stored.z);
         _samples_collected++;
     }
+
+    if (_sem != nullptr) {
+        _sem->give();
+    }
 }
 
 void CompassCalibrator::update(bool &failure) {
     failure = false;
 
+    if (_sem != nullptr) {
+        // fit is run by run_fit_step() on the IO thread
+        if (_fit_failed) {
+            _fit_failed = false;
+            failure = true;
+        }
+        return;
+    }
+
     if(!fitting()) {
         return;
     }
 
+    failure = fit_step();
+}
+
+void CompassCalibrator::run_fit_step() {
+    if (_sem == nullptr || !fitting()) {
+        return;
+    }
+
+    if (!_sem->take_nonblocking()) {
+        return;
+    }
+
+    if (fitting() && fit_step()) {
+        _fit_failed = true;
+    }
+
+    _sem->give();
+}
+
+/////////////////////////////////////////////////////////////
+////////////////////// PRIVATE METHODS //////////////////////
+/////////////////////////////////////////////////////////////
+bool CompassCalibrator::fit_step() {
+    bool failure = false;
+
     if(_status == COMPASS_CAL_RUNNING_STEP_ONE) {
         if (_fit_step >= 10) {
             if(is_equal(_fitness,_initial_fitness) || isnan(_fitness)) {           //if true, means that fitness is diverging instead of converging
@@ -215,11 +304,10 @@ void CompassCalibrator::update(bool &failure) {
             _fit_step++;
         }
     }
+
+    return failure;
 }
 
-/////////////////////////////////////////////////////////////
-////////////////////// PRIVATE METHODS //////////////////////
-/////////////////////////////////////////////////////////////
 bool CompassCalibrator::running() const {
     return _status == COMPASS_CAL_RUNNING_STEP_ONE || _status == COMPASS_CAL_RUNNING_STEP_TWO;
 }
@@ -244,6 +332,7 @@ void CompassCalibrator::initialize_fit() {
 void CompassCalibrator::reset_state() {
     _samples_collected = 0;
     _samples_thinned = 0;
+    _sample_sum.zero();
     _params.radius = 200;
     _params.offset.zero();
     _params.diag = Vector3f(1.0f,1.0f,1.0f);
@@ -379,6 +468,8 @@ void CompassCalibrator::thin_samples() {
 
     for(uint16_t i=0; i < _samples_collected; i++) {
         if(!accept_sample(_sample_buffer[i])) {
+            const Vector3f stored = _sample_buffer[i].get();
+            _sample_sum -= Vector3d(stored.x, stored.y, stored.z);
             _sample_buffer[i] = _sample_buffer[_samples_collected-1];
             _samples_collected --;
             _samples_thinned ++;
@@ -483,12 +574,10 @@ void CompassCalibrator::calc_sphere_jacob(const Vector3f& sample, const param_t&
 
 void CompassCalibrator::calc_initial_offset()
 {
-    // Set initial offset to the average value of the samples
-    _params.offset.zero();
-    for(uint16_t k = 0; k<_samples_collected; k++) {
-        _params.offset -= _sample_buffer[k].get();
-    }
-    _params.offset /= _samples_collected;
+    // Set initial offset to the average value of the samples, kept as a
+    // running sum as they are collected
+    const Vector3d mean = _sample_sum / _samples_collected;
+    _params.offset = -Vector3f(mean.x, mean.y, mean.z);
 }
 
 void CompassCalibrator::run_sphere_fit()
@@ -516,17 +605,26 @@ void CompassCalibrator::run_sphere_fit()
 
         calc_sphere_jacob(sample, fit1_params, sphere_jacob);
 
+        // the residual doesn't depend on the parameter being derived
+        float resid = calc_residual(sample, fit1_params);
+
         for(uint8_t i = 0;i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
-            // compute JTJ
-            for(uint8_t j = 0; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
+            // compute the upper triangle of JTJ, it is symmetric
+            for(uint8_t j = i; j < COMPASS_CAL_NUM_SPHERE_PARAMS; j++) {
                 JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] += sphere_jacob[i] * sphere_jacob[j];   //a backup JTJ for LM
             }
             // compute JTFI
-            JTFI[i] += sphere_jacob[i] * calc_residual(sample, fit1_params);
+            JTFI[i] += sphere_jacob[i] * resid;
         }
     }
 
+    for(uint8_t i = 0; i < COMPASS_CAL_NUM_SPHERE_PARAMS; i++) {
+        for(uint8_t j = 0; j < i; j++) {
+            JTJ[i*COMPASS_CAL_NUM_SPHERE_PARAMS+j] = JTJ[j*COMPASS_CAL_NUM_SPHERE_PARAMS+i];
+        }
+    }
+    // a backup JTJ for LM
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
@@ -629,18 +727,26 @@ void CompassCalibrator::run_ellipsoid_fit()
 
         calc_ellipsoid_jacob(sample, fit1_params, ellipsoid_jacob);
 
+        // the residual doesn't depend on the parameter being derived
+        float resid = calc_residual(sample, fit1_params);
+
         for(uint8_t i = 0;i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
-            // compute JTJ
-            for(uint8_t j = 0; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
-                JTJ [i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
-                JTJ2[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
+            // compute the upper triangle of JTJ, it is symmetric
+            for(uint8_t j = i; j < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; j++) {
+                JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] += ellipsoid_jacob[i] * ellipsoid_jacob[j];
             }
             // compute JTFI
-            JTFI[i] += ellipsoid_jacob[i] * calc_residual(sample, fit1_params);
+            JTFI[i] += ellipsoid_jacob[i] * resid;
         }
     }
 
-
+    for(uint8_t i = 0; i < COMPASS_CAL_NUM_ELLIPSOID_PARAMS; i++) {
+        for(uint8_t j = 0; j < i; j++) {
+            JTJ[i*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+j] = JTJ[j*COMPASS_CAL_NUM_ELLIPSOID_PARAMS+i];
+        }
+    }
+    // a backup JTJ for LM
+    memcpy(JTJ2, JTJ, sizeof(JTJ2));
 
     //------------------------Levenberg-Marquardt-part-starts-here---------------------------------//
     //refer: http://en.wikipedia.org/wiki/Levenberg%E2%80%93Marquardt_algorithm#Choice_of_damping_parameter
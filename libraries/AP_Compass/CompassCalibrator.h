@@ -1,3 +1,4 @@
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
 #define COMPASS_CAL_NUM_SPHERE_PARAMS 4
@@ -28,6 +29,11 @@ public:
     void update(bool &failure);
     void new_sample(const Vector3f &sample);
 
+    // run one fit step from the IO thread. Does nothing if the
+    // calibrator could not get a semaphore, in which case update()
+    // fits from the main thread as before
+    void run_fit_step();
+
     bool check_for_timeout();
 
     bool running() const;
@@ -95,6 +101,17 @@ private:
     float _ellipsoid_lambda;
     uint16_t _samples_collected;
     uint16_t _samples_thinned;
+    // running sum of the samples in _sample_buffer, so that the
+    // initial offset does not need another pass over the buffer. Kept in
+    // double so that adding and removing samples doesn't accumulate
+    // rounding errors in float
+    Vector3d _sample_sum;
+
+    // protects the sample buffer and fit state between the thread
+    // feeding samples, the main loop and the IO thread running the fit
+    AP_HAL::Semaphore *_sem;
+    // set by the IO thread when a fit fails, consumed by update()
+    volatile bool _fit_failed;
 
     bool set_status(compass_cal_status_t status);
 
@@ -110,6 +127,9 @@ private:
 
     bool fitting() const;
 
+    // run one step of the fit, returning true on failure
+    bool fit_step();
+
     // thins out samples between step one and step two
     void thin_samples();
 
@@ -131,6 +151,7 @@ private:
      * @param v[in] A vector representing one calibration sample.
      */
     void update_completion_mask(const Vector3f& v);
+    void update_completion_mask(completion_mask_t &mask, const Vector3f& v);
     /**
      * Reset and update #_completion_mask with the current samples.
      */
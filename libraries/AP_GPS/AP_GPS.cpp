@@ -18,6 +18,7 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Notify/AP_Notify.h>
+#include <DataFlash/DataFlash.h>
 #include <GCS_MAVLink/GCS.h>
 
 #include "AP_GPS_NOVA.h"
@@ -198,6 +199,13 @@ const AP_Param::GroupInfo AP_GPS::var_info[] = {
     // @User: Advanced
     AP_GROUPINFO("POS2", 17, AP_GPS, _antenna_offset[1], 0.0f),
 
+    // @Param: RAW_STREAM
+    // @DisplayName: Raw data stream capture
+    // @Description: Capture the unmodified data stream received from each GPS, including raw observables and ephemerides when the receiver is configured to output them. The stream can be logged to dataflash as GRWD messages, which are dropped before any other message when the logger falls behind, and/or forwarded to the serial port configured with the GPS raw data protocol. Tools such as RTKLIB can then extract observation files for post processing.
+    // @Bitmask: 0:Log GPS1,1:Log GPS2,2:Forward GPS1,3:Forward GPS2
+    // @User: Advanced
+    AP_GROUPINFO("RAW_STREAM", 18, AP_GPS, _raw_stream, 0),
+
     AP_GROUPEND
 };
 
@@ -210,9 +218,50 @@ void AP_GPS::init(DataFlash_Class *dataflash, const AP_SerialManager& serial_man
     // search for serial ports with gps protocol
     _port[0] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, 0);
     _port[1] = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS, 1);
+    _raw_port = serial_manager.find_serial(AP_SerialManager::SerialProtocol_GPS_Raw, 0);
     _last_instance_swap_ms = 0;
 }
 
+/*
+  capture a chunk of the raw data stream received from a GPS, logging
+  it and/or forwarding it to the raw data serial port
+ */
+void AP_GPS::handle_raw_stream(uint8_t instance, const uint8_t *data, uint16_t len)
+{
+    if (instance >= GPS_MAX_INSTANCES) {
+        return;
+    }
+
+    if ((_raw_stream & (RAW_STREAM_FORWARD_GPS1 << instance)) && _raw_port != nullptr) {
+        // never block the caller: drop what doesn't fit
+        uint16_t n = MIN(len, _raw_port->txspace());
+        if (n > 0) {
+            _raw_port->write(data, n);
+        }
+    }
+
+    if (!(_raw_stream & (RAW_STREAM_LOG_GPS1 << instance)) ||
+        _DataFlash == nullptr || !_DataFlash->logging_started()) {
+        return;
+    }
+
+    struct log_GPS_RAWD pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_GPS_RAWD_MSG),
+        time_us    : AP_HAL::micros64(),
+        instance   : instance,
+    };
+    uint8_t *chunk = (uint8_t *)pkt.data;
+    while (len > 0) {
+        pkt.seq = _raw_seq[instance]++;
+        pkt.len = MIN(len, sizeof(pkt.data));
+        memcpy(chunk, data, pkt.len);
+        memset(&chunk[pkt.len], 0, sizeof(pkt.data) - pkt.len);
+        _DataFlash->WriteBulkBlock(&pkt, sizeof(pkt));
+        data += pkt.len;
+        len -= pkt.len;
+    }
+}
+
 // baudrates to try to detect GPSes with
 const uint32_t AP_GPS::_baudrates[] = {4800U, 19200U, 38400U, 115200U, 57600U, 9600U, 230400U};
 
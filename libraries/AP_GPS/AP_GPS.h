@@ -353,6 +353,16 @@ public:
     AP_Int8 _save_config;
     AP_Int8 _auto_config;
     AP_Vector3f _antenna_offset[2];
+    AP_Int8 _raw_stream;
+
+    // bits of _raw_stream, shifted left by the instance number
+    enum raw_stream_options {
+        RAW_STREAM_LOG_GPS1     = (1<<0),
+        RAW_STREAM_FORWARD_GPS1 = (1<<2),
+    };
+
+    // capture a chunk of data received by a backend, see _raw_stream
+    void handle_raw_stream(uint8_t instance, const uint8_t *data, uint16_t len);
 
     // handle sending of initialisation strings to the GPS
     void send_blob_start(uint8_t instance, const char *_blob, uint16_t size);
@@ -389,6 +399,10 @@ private:
     AP_GPS_Backend *drivers[GPS_MAX_INSTANCES];
     AP_HAL::UARTDriver *_port[GPS_MAX_INSTANCES];
 
+    // port for forwarding raw GPS data and sequence numbers of logged chunks
+    AP_HAL::UARTDriver *_raw_port;
+    uint16_t _raw_seq[GPS_MAX_INSTANCES];
+
     /// primary GPS instance
     uint8_t primary_instance:2;
 
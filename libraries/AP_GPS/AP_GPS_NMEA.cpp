@@ -111,23 +111,24 @@ AP_GPS_NMEA::AP_GPS_NMEA(AP_GPS &_gps, AP_GPS::GPS_State &_state, AP_HAL::UARTDr
 
 bool AP_GPS_NMEA::read(void)
 {
-    int16_t numc;
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    uint16_t numc;
     bool parsed = false;
 
-    numc = port->available();
-    while (numc--) {
-        char c = port->read();
+    while ((numc = read_chunk(buf, sizeof(buf))) > 0) {
 #ifdef NMEA_LOG_PATH
         static FILE *logf = nullptr;
         if (logf == nullptr) {
             logf = fopen(NMEA_LOG_PATH, "wb");
         }
         if (logf != nullptr) {
-            ::fwrite(&c, 1, 1, logf);
+            ::fwrite(buf, 1, numc, logf);
         }
 #endif
-        if (_decode(c)) {
-            parsed = true;
+        for (uint16_t i = 0; i < numc; i++) {
+            if (_decode(buf[i])) {
+                parsed = true;
+            }
         }
     }
     return parsed;
@@ -68,10 +68,13 @@ AP_GPS_SBF::read(void)
         }
     }
 
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    uint16_t numc;
     bool ret = false;
-    while (port->available() > 0) {
-        uint8_t temp = port->read();
-        ret |= parse(temp);
+    while ((numc = read_chunk(buf, sizeof(buf))) > 0) {
+        for (uint16_t i = 0; i < numc; i++) {
+            ret |= parse(buf[i]);
+        }
     }
 
     return ret;
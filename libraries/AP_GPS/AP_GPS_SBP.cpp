@@ -102,79 +102,92 @@ void
 AP_GPS_SBP::_sbp_process() 
 {
 
-    while (port->available() > 0) {
-        uint8_t temp = port->read();
-        uint16_t crc;
-
-
-        //This switch reads one character at a time,
-        //parsing it into buffers until a full message is dispatched
-        switch(parser_state.state) {
-            case sbp_parser_state_t::WAITING:
-                if (temp == SBP_PREAMBLE) {
-                    parser_state.n_read = 0;
-                    parser_state.state = sbp_parser_state_t::GET_TYPE;
-                }
-                break;
-
-            case sbp_parser_state_t::GET_TYPE:
-                *((uint8_t*)&(parser_state.msg_type) + parser_state.n_read) = temp;
-                parser_state.n_read += 1;
-                if (parser_state.n_read >= 2) {
-                    parser_state.n_read = 0;
-                    parser_state.state = sbp_parser_state_t::GET_SENDER;
-                }
-                break;
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    uint16_t numc;
+
+    while ((numc = read_chunk(buf, sizeof(buf))) > 0) {
+        for (uint16_t i = 0; i < numc; i++) {
+            uint8_t temp = buf[i];
+            uint16_t crc;
+
+
+            //This switch reads one character at a time,
+            //parsing it into buffers until a full message is dispatched
+            switch(parser_state.state) {
+                case sbp_parser_state_t::WAITING:
+                    if (temp == SBP_PREAMBLE) {
+                        parser_state.n_read = 0;
+                        parser_state.state = sbp_parser_state_t::GET_TYPE;
+                    }
+                    break;
+
+                case sbp_parser_state_t::GET_TYPE:
+                    *((uint8_t*)&(parser_state.msg_type) + parser_state.n_read) = temp;
+                    parser_state.n_read += 1;
+                    if (parser_state.n_read >= 2) {
+                        parser_state.n_read = 0;
+                        parser_state.state = sbp_parser_state_t::GET_SENDER;
+                    }
+                    break;
+
+                case sbp_parser_state_t::GET_SENDER:
+                    *((uint8_t*)&(parser_state.sender_id) + parser_state.n_read) = temp;
+                    parser_state.n_read += 1;
+                    if (parser_state.n_read >= 2) {
+                        parser_state.n_read = 0;
+                        parser_state.state = sbp_parser_state_t::GET_LEN;
+                    }
+                    break;
 
-            case sbp_parser_state_t::GET_SENDER:
-                *((uint8_t*)&(parser_state.sender_id) + parser_state.n_read) = temp;
-                parser_state.n_read += 1;
-                if (parser_state.n_read >= 2) {
-                    parser_state.n_read = 0;
-                    parser_state.state = sbp_parser_state_t::GET_LEN;
-                }
-                break;
-
-            case sbp_parser_state_t::GET_LEN:
-                parser_state.msg_len = temp;
-                parser_state.n_read = 0;
-                parser_state.state = sbp_parser_state_t::GET_MSG;
-                break;
-
-            case sbp_parser_state_t::GET_MSG:
-                *((uint8_t*)&(parser_state.msg_buff) + parser_state.n_read) = temp;
-                parser_state.n_read += 1;
-                if (parser_state.n_read >= parser_state.msg_len) {
+                case sbp_parser_state_t::GET_LEN:
+                    parser_state.msg_len = temp;
                     parser_state.n_read = 0;
-                    parser_state.state = sbp_parser_state_t::GET_CRC;
+                    if (parser_state.msg_len == 0) {
+                        parser_state.state = sbp_parser_state_t::GET_CRC;
+                    } else {
+                        parser_state.state = sbp_parser_state_t::GET_MSG;
+                    }
+                    break;
+
+                case sbp_parser_state_t::GET_MSG: {
+                    // copy as much of the message as available in the chunk
+                    uint16_t n = MIN(parser_state.msg_len - parser_state.n_read, numc - i);
+                    memcpy(parser_state.msg_buff + parser_state.n_read, &buf[i], n);
+                    parser_state.n_read += n;
+                    i += n - 1;
+                    if (parser_state.n_read >= parser_state.msg_len) {
+                        parser_state.n_read = 0;
+                        parser_state.state = sbp_parser_state_t::GET_CRC;
+                    }
+                    break;
                 }
-                break;
 
-            case sbp_parser_state_t::GET_CRC:
-                *((uint8_t*)&(parser_state.crc) + parser_state.n_read) = temp;
-                parser_state.n_read += 1;
-                if (parser_state.n_read >= 2) {
-                    parser_state.state = sbp_parser_state_t::WAITING;
-
-                    crc = crc16_ccitt((uint8_t*)&(parser_state.msg_type), 2, 0);
-                    crc = crc16_ccitt((uint8_t*)&(parser_state.sender_id), 2, crc);
-                    crc = crc16_ccitt(&(parser_state.msg_len), 1, crc);
-                    crc = crc16_ccitt(parser_state.msg_buff, parser_state.msg_len, crc);
-                    if (parser_state.crc == crc) {
-                        _sbp_process_message();
-                    } else {
-                        Debug("CRC Error Occurred!");
-                        crc_error_counter += 1;
+                case sbp_parser_state_t::GET_CRC:
+                    *((uint8_t*)&(parser_state.crc) + parser_state.n_read) = temp;
+                    parser_state.n_read += 1;
+                    if (parser_state.n_read >= 2) {
+                        parser_state.state = sbp_parser_state_t::WAITING;
+
+                        crc = crc16_ccitt((uint8_t*)&(parser_state.msg_type), 2, 0);
+                        crc = crc16_ccitt((uint8_t*)&(parser_state.sender_id), 2, crc);
+                        crc = crc16_ccitt(&(parser_state.msg_len), 1, crc);
+                        crc = crc16_ccitt(parser_state.msg_buff, parser_state.msg_len, crc);
+                        if (parser_state.crc == crc) {
+                            _sbp_process_message();
+                        } else {
+                            Debug("CRC Error Occurred!");
+                            crc_error_counter += 1;
+                        }
+
+                        parser_state.state = sbp_parser_state_t::WAITING;                
                     }
+                    break;
 
-                    parser_state.state = sbp_parser_state_t::WAITING;                
+                default:
+                    parser_state.state = sbp_parser_state_t::WAITING;
+                    break;
                 }
-                break;
-
-            default:
-                parser_state.state = sbp_parser_state_t::WAITING;
-                break;
-            }
+        }
     }
 }
 
@@ -353,7 +366,11 @@ AP_GPS_SBP::_detect(struct SBP_detect_state &state, uint8_t data)
             state.crc_so_far = crc16_ccitt(&data, 1, state.crc_so_far);
             state.msg_len = data;
             state.n_read = 0;
-            state.state = SBP_detect_state::GET_MSG;
+            if (state.msg_len == 0) {
+                state.state = SBP_detect_state::GET_CRC;
+            } else {
+                state.state = SBP_detect_state::GET_MSG;
+            }
             break;
 
         case SBP_detect_state::GET_MSG:
@@ -335,8 +335,9 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
+    uint8_t buf[AP_GPS_READ_CHUNK_SIZE];
+    uint16_t numc;
     uint8_t data;
-    int16_t numc;
     bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
@@ -361,108 +362,125 @@ AP_GPS_UBLOX::read(void)
         }
     }
 
-    numc = port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
+    while ((numc = read_chunk(buf, sizeof(buf))) > 0) {
+        for (uint16_t i = 0; i < numc; i++) {        // Process bytes received
 
-        // read the next byte
-        data = port->read();
+            // Skip straight to the next preamble when hunting for a
+            // message
+            if (_step == 0) {
+                const uint8_t *p = (const uint8_t *)memchr(&buf[i], PREAMBLE1, numc - i);
+                if (p == nullptr) {
+                    break;
+                }
+                i = p - buf;
+            }
 
-	reset:
-        switch(_step) {
-
-        // Message preamble detection
-        //
-        // If we fail to match any of the expected bytes, we reset
-        // the state machine and re-consider the failed byte as
-        // the first byte of the preamble.  This improves our
-        // chances of recovering from a mismatch and makes it less
-        // likely that we will be fooled by the preamble appearing
-        // as data in some other message.
-        //
-        case 1:
-            if (PREAMBLE2 == data) {
+            // Receive message data: copy as much of the payload as is
+            // available in the chunk and update the checksum over the
+            // whole span. _payload_length never exceeds sizeof(_buffer)
+            if (_step == 6) {
+                uint16_t n = MIN(_payload_length - _payload_counter, numc - i);
+                _update_checksum(&buf[i], n, _ck_a, _ck_b);
+                memcpy(&_buffer[_payload_counter], &buf[i], n);
+                _payload_counter += n;
+                i += n;
+                if (_payload_counter < _payload_length) {
+                    break;
+                }
                 _step++;
-                break;
+                if (i == numc) {
+                    break;
+                }
             }
-            _step = 0;
-            Debug("reset %u", __LINE__);
-            /* no break */
-        case 0:
-            if(PREAMBLE1 == data)
-                _step++;
-            break;
 
-        // Message header processing
-        //
-        // We sniff the class and message ID to decide whether we
-        // are going to gather the message bytes or just discard
-        // them.
-        //
-        // We always collect the length so that we can avoid being
-        // fooled by preamble bytes in messages.
-        //
-        case 2:
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;                               // reset the checksum accumulators
-            break;
-        case 3:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _msg_id = data;
-            break;
-        case 4:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-            _payload_length = data;                             // payload length low byte
-            break;
-        case 5:
-            _step++;
-            _ck_b += (_ck_a += data);                   // checksum byte
-
-            _payload_length += (uint16_t)(data<<8);
-            if (_payload_length > sizeof(_buffer)) {
-                Debug("large payload %u", (unsigned)_payload_length);
-                // assume any payload bigger then what we know about is noise
-                _payload_length = 0;
+            data = buf[i];
+
+	reset:
+            switch(_step) {
+
+            // Message preamble detection
+            //
+            // If we fail to match any of the expected bytes, we reset
+            // the state machine and re-consider the failed byte as
+            // the first byte of the preamble.  This improves our
+            // chances of recovering from a mismatch and makes it less
+            // likely that we will be fooled by the preamble appearing
+            // as data in some other message.
+            //
+            case 1:
+                if (PREAMBLE2 == data) {
+                    _step++;
+                    break;
+                }
                 _step = 0;
-				goto reset;
-            }
-            _payload_counter = 0;                               // prepare to receive payload
-            break;
+                Debug("reset %u", __LINE__);
+                /* no break */
+            case 0:
+                if(PREAMBLE1 == data)
+                    _step++;
+                break;
 
-        // Receive message data
-        //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
+            // Message header processing
+            //
+            // We sniff the class and message ID to decide whether we
+            // are going to gather the message bytes or just discard
+            // them.
+            //
+            // We always collect the length so that we can avoid being
+            // fooled by preamble bytes in messages.
+            //
+            case 2:
                 _step++;
-            break;
+                _class = data;
+                _ck_b = _ck_a = data;                               // reset the checksum accumulators
+                break;
+            case 3:
+                _step++;
+                _ck_b += (_ck_a += data);                   // checksum byte
+                _msg_id = data;
+                break;
+            case 4:
+                _step++;
+                _ck_b += (_ck_a += data);                   // checksum byte
+                _payload_length = data;                             // payload length low byte
+                break;
+            case 5:
+                _step++;
+                _ck_b += (_ck_a += data);                   // checksum byte
+
+                _payload_length += (uint16_t)(data<<8);
+                if (_payload_length > sizeof(_buffer)) {
+                    Debug("large payload %u", (unsigned)_payload_length);
+                    // assume any payload bigger then what we know about is noise
+                    _payload_length = 0;
+                    _step = 0;
+                    goto reset;
+                }
+                _payload_counter = 0;                               // prepare to receive payload
+                break;
 
-        // Checksum and message processing
-        //
-        case 7:
-            _step++;
-            if (_ck_a != data) {
-                Debug("bad cka %x should be %x", data, _ck_a);
+            // Checksum and message processing
+            //
+            case 7:
+                _step++;
+                if (_ck_a != data) {
+                    Debug("bad cka %x should be %x", data, _ck_a);
+                    _step = 0;
+                    goto reset;
+                }
+                break;
+            case 8:
                 _step = 0;
-				goto reset;
-            }
-            break;
-        case 8:
-            _step = 0;
-            if (_ck_b != data) {
-                Debug("bad ckb %x should be %x", data, _ck_b);
-                break;                                                  // bad checksum
-            }
+                if (_ck_b != data) {
+                    Debug("bad ckb %x should be %x", data, _ck_b);
+                    break;                                                  // bad checksum
+                }
 
-            if (_parse_gps()) {
-                parsed = true;
+                if (_parse_gps()) {
+                    parsed = true;
+                }
+                break;
             }
-            break;
         }
     }
     return parsed;
@@ -532,7 +550,7 @@ void AP_GPS_UBLOX::log_rxm_raw(const struct ubx_rxm_raw &raw)
             cno        : raw.svinfo[i].cno,
             lli        : raw.svinfo[i].lli
         };
-        gps._DataFlash->WriteBlock(&pkt, sizeof(pkt));
+        gps._DataFlash->WriteBulkBlock(&pkt, sizeof(pkt));
     }
 }
 
@@ -552,7 +570,7 @@ void AP_GPS_UBLOX::log_rxm_rawx(const struct ubx_rxm_rawx &raw)
         numMeas    : raw.numMeas,
         recStat    : raw.recStat
     };
-    gps._DataFlash->WriteBlock(&header, sizeof(header));
+    gps._DataFlash->WriteBulkBlock(&header, sizeof(header));
 
     for (uint8_t i=0; i<raw.numMeas; i++) {
         struct log_GPS_RAWS pkt = {
@@ -571,7 +589,7 @@ void AP_GPS_UBLOX::log_rxm_rawx(const struct ubx_rxm_rawx &raw)
             doStdev    : raw.svinfo[i].doStdev,
             trkStat    : raw.svinfo[i].trkStat
         };
-        gps._DataFlash->WriteBlock(&pkt, sizeof(pkt));
+        gps._DataFlash->WriteBulkBlock(&pkt, sizeof(pkt));
     }
 }
 #endif // UBLOX_RXM_RAW_LOGGING
@@ -1075,7 +1093,7 @@ AP_GPS_UBLOX::_parse_gps(void)
  *  update checksum for a set of bytes
  */
 void
-AP_GPS_UBLOX::_update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
+AP_GPS_UBLOX::_update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
 {
     while (len--) {
         ck_a += *data;
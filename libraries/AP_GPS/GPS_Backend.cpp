@@ -137,3 +137,19 @@ void AP_GPS_Backend::fill_3d_velocity(void)
     state.velocity.z = 0;
     state.have_vertical_velocity = false;
 }
+
+/*
+  read a chunk of bytes from the port in one go, so parsers can work on
+  spans instead of paying for a virtual call per byte
+ */
+uint16_t AP_GPS_Backend::read_chunk(uint8_t *buf, uint16_t len)
+{
+    ssize_t n = port->read(buf, len);
+    if (n <= 0) {
+        return 0;
+    }
+    if (gps._raw_stream) {
+        gps.handle_raw_stream(state.instance, buf, n);
+    }
+    return n;
+}
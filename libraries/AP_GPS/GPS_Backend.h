@@ -21,6 +21,9 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include "AP_GPS.h"
 
+// size of the stack buffer used by backends to read from the port in bulk
+#define AP_GPS_READ_CHUNK_SIZE 64
+
 class AP_GPS_Backend
 {
 public:
@@ -61,6 +64,12 @@ protected:
     int32_t swap_int32(int32_t v) const;
     int16_t swap_int16(int16_t v) const;
 
+    /*
+      read up to len bytes from the port with a single call to the UART
+      driver, returning the number of bytes read
+     */
+    uint16_t read_chunk(uint8_t *buf, uint16_t len);
+
     /*
       fill in 3D velocity from 2D components
      */
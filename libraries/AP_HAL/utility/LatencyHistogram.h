@@ -0,0 +1,70 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Histogram of latencies in microseconds, with bins doubling in width:
+ * [0, 250), [250, 500), [500, 1000), ... [8000, 16000) and [16000, inf).
+ *
+ * The counts and the sum are cumulative, so that a reader can take the
+ * difference between two copies to get the histogram over that period.
+ */
+class LatencyHistogram {
+public:
+    static const uint8_t NUM_BINS = 8;
+    static const uint32_t FIRST_BIN_US = 250;
+
+    // upper limit of @bin in microseconds, UINT32_MAX for the last one
+    static uint32_t bin_limit_us(uint8_t bin)
+    {
+        return bin < NUM_BINS - 1 ? FIRST_BIN_US << bin : UINT32_MAX;
+    }
+
+    void add(uint32_t latency_us)
+    {
+        uint8_t bin = 0;
+        while (bin < NUM_BINS - 1 && latency_us >= bin_limit_us(bin)) {
+            bin++;
+        }
+        bins[bin]++;
+        count++;
+        sum_us += latency_us;
+        if (latency_us > max_us) {
+            max_us = latency_us;
+        }
+    }
+
+    // set this to the difference between two copies of the same histogram
+    void delta(const LatencyHistogram &now, const LatencyHistogram &before)
+    {
+        for (uint8_t i = 0; i < NUM_BINS; i++) {
+            bins[i] = now.bins[i] - before.bins[i];
+        }
+        count = now.count - before.count;
+        sum_us = now.sum_us - before.sum_us;
+        max_us = now.max_us;
+    }
+
+    uint32_t average_us() const { return count ? sum_us / count : 0; }
+
+    uint32_t bins[NUM_BINS] {};
+    uint32_t count = 0;
+    uint64_t sum_us = 0;
+
+    // not cumulative: it's up to the owner to decide when to reset it
+    uint32_t max_us = 0;
+};
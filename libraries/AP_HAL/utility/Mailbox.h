@@ -0,0 +1,76 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/*
+ * Lock-free mailbox holding the latest object posted by one producer thread
+ * for one consumer thread.
+ *
+ * It's a triple buffer: the producer and the consumer each own a slot and
+ * the third one holds the latest posted object. post() and fetch() swap
+ * their own slot with that one, so neither side ever waits for the other
+ * and the consumer never sees a partially written object. Objects posted
+ * while the consumer isn't looking are overwritten, only the latest is
+ * kept.
+ */
+template <class T>
+class ObjectMailbox {
+public:
+    /*
+     * Post a new object, replacing the one not yet fetched if any. Must
+     * only be called from the producer thread.
+     */
+    void post(const T &object)
+    {
+        _slots[_write] = object;
+        uint8_t prev = _latest.exchange(_write | FRESH, std::memory_order_acq_rel);
+        _write = prev & INDEX_MASK;
+    }
+
+    /*
+     * Copy the latest posted object to @object. Returns true if it wasn't
+     * fetched before: otherwise @object gets the same object as the previous
+     * call, or a default constructed one if nothing was posted yet. Must
+     * only be called from the consumer thread.
+     */
+    bool fetch(T &object)
+    {
+        bool fresh = _latest.load(std::memory_order_relaxed) & FRESH;
+        if (fresh) {
+            uint8_t prev = _latest.exchange(_read, std::memory_order_acq_rel);
+            _read = prev & INDEX_MASK;
+        }
+        object = _slots[_read];
+        return fresh;
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 0x03;
+    static const uint8_t FRESH = 0x04;
+
+    T _slots[3] {};
+
+    // slot owned by the producer
+    uint8_t _write = 0;
+
+    // slot owned by the consumer
+    uint8_t _read = 1;
+
+    // slot with the latest object, with FRESH set if not fetched yet
+    std::atomic<uint8_t> _latest{2};
+};
@@ -61,6 +61,9 @@ public:
     // listen has been used. A new socket is returned
     SocketAPM *accept(uint32_t timeout_ms);
 
+    // file descriptor of the socket, e.g. to wait on it with epoll
+    int get_fd() const { return fd; }
+
 private:
     bool datagram;
     struct sockaddr_in in_addr {};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <sys/types.h>
+
 #include <AP_HAL/AP_HAL_Namespace.h>
 #include "Print.h"
 
@@ -17,4 +19,19 @@ public:
      * -1 if nothing available, uint8_t value otherwise. */
     virtual int16_t read() = 0;
 
+    /* read up to @count bytes into @buffer. Returns the number of bytes
+     * read, which may be 0. Drivers with an internal receive buffer
+     * should override it to copy in bulk rather than byte by byte. */
+    virtual ssize_t read(uint8_t *buffer, uint16_t count) {
+        uint16_t i;
+        for (i = 0; i < count; i++) {
+            int16_t c = read();
+            if (c < 0) {
+                break;
+            }
+            buffer[i] = c;
+        }
+        return i;
+    }
+
 };
@@ -0,0 +1,75 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_HAL/utility/LatencyHistogram.h>
+
+TEST(LatencyHistogramTest, Bins)
+{
+    LatencyHistogram hist;
+
+    hist.add(0);
+    hist.add(249);
+    hist.add(250);
+    hist.add(999);
+    hist.add(1000);
+    hist.add(15999);
+    hist.add(16000);
+    hist.add(1000000);
+
+    EXPECT_EQ(2U, hist.bins[0]);
+    EXPECT_EQ(1U, hist.bins[1]);
+    EXPECT_EQ(1U, hist.bins[2]);
+    EXPECT_EQ(1U, hist.bins[3]);
+    EXPECT_EQ(0U, hist.bins[4]);
+    EXPECT_EQ(0U, hist.bins[5]);
+    EXPECT_EQ(1U, hist.bins[6]);
+    EXPECT_EQ(2U, hist.bins[7]);
+
+    EXPECT_EQ(8U, hist.count);
+    EXPECT_EQ(1000000U, hist.max_us);
+    EXPECT_EQ((0U + 249 + 250 + 999 + 1000 + 15999 + 16000 + 1000000) / 8,
+              hist.average_us());
+
+    EXPECT_EQ(250U, LatencyHistogram::bin_limit_us(0));
+    EXPECT_EQ(16000U, LatencyHistogram::bin_limit_us(LatencyHistogram::NUM_BINS - 2));
+    EXPECT_EQ(UINT32_MAX, LatencyHistogram::bin_limit_us(LatencyHistogram::NUM_BINS - 1));
+}
+
+TEST(LatencyHistogramTest, Delta)
+{
+    LatencyHistogram hist;
+    LatencyHistogram before;
+    LatencyHistogram delta;
+
+    EXPECT_EQ(0U, delta.average_us());
+
+    hist.add(100);
+    hist.add(2000);
+    before = hist;
+    hist.add(300);
+    hist.add(500);
+
+    delta.delta(hist, before);
+    EXPECT_EQ(0U, delta.bins[0]);
+    EXPECT_EQ(1U, delta.bins[1]);
+    EXPECT_EQ(1U, delta.bins[2]);
+    EXPECT_EQ(0U, delta.bins[4]);
+    EXPECT_EQ(2U, delta.count);
+    EXPECT_EQ(400U, delta.average_us());
+    EXPECT_EQ(2000U, delta.max_us);
+}
+
+AP_GTEST_MAIN()
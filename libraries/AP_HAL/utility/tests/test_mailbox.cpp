@@ -0,0 +1,100 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <pthread.h>
+
+#include <AP_HAL/utility/Mailbox.h>
+
+struct TestObject {
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+TEST(ObjectMailboxTest, EmptyMailbox)
+{
+    ObjectMailbox<TestObject> mailbox;
+    TestObject obj = { 1, 2, 3 };
+
+    EXPECT_FALSE(mailbox.fetch(obj));
+    EXPECT_EQ(0U, obj.a);
+    EXPECT_EQ(0U, obj.b);
+    EXPECT_EQ(0U, obj.c);
+}
+
+TEST(ObjectMailboxTest, KeepsLatest)
+{
+    ObjectMailbox<TestObject> mailbox;
+    TestObject obj;
+
+    for (uint32_t i = 1; i <= 10; i++) {
+        mailbox.post({ i, i * 2, i * 3 });
+    }
+
+    EXPECT_TRUE(mailbox.fetch(obj));
+    EXPECT_EQ(10U, obj.a);
+    EXPECT_EQ(20U, obj.b);
+    EXPECT_EQ(30U, obj.c);
+
+    /* nothing new: same object, not fresh */
+    obj = { };
+    EXPECT_FALSE(mailbox.fetch(obj));
+    EXPECT_EQ(10U, obj.a);
+
+    mailbox.post({ 11, 22, 33 });
+    EXPECT_TRUE(mailbox.fetch(obj));
+    EXPECT_EQ(11U, obj.a);
+    EXPECT_EQ(22U, obj.b);
+    EXPECT_EQ(33U, obj.c);
+}
+
+static const uint32_t producer_count = 1000000;
+
+static void *producer(void *arg)
+{
+    ObjectMailbox<TestObject> *mailbox = static_cast<ObjectMailbox<TestObject> *>(arg);
+
+    for (uint32_t i = 1; i <= producer_count; i++) {
+        mailbox->post({ i, ~i, i * 7 });
+    }
+
+    return nullptr;
+}
+
+TEST(ObjectMailboxTest, ConcurrentPostFetch)
+{
+    ObjectMailbox<TestObject> mailbox;
+    pthread_t thread;
+    TestObject obj;
+    uint32_t last = 0;
+
+    ASSERT_EQ(0, pthread_create(&thread, nullptr, producer, &mailbox));
+
+    while (last < producer_count) {
+        if (!mailbox.fetch(obj)) {
+            continue;
+        }
+        /* never torn and never older than what we already got */
+        ASSERT_EQ(~obj.a, obj.b);
+        ASSERT_EQ(obj.a * 7, obj.c);
+        ASSERT_GT(obj.a, last);
+        last = obj.a;
+    }
+
+    pthread_join(thread, nullptr);
+}
+
+AP_GTEST_MAIN()
@@ -46,6 +46,29 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+/*
+ * The SAD of the block search and of the subpixel refinement are
+ * computed 8 pixels at a time with SSE2 or NEON for the 8x8 windows
+ * used with a max flow of 4 pixels, and by the scalar code otherwise.
+ * Both give the same results. Define FLOW_PX4_ALLOW_SIMD to 0 to force
+ * the scalar code.
+ */
+#ifndef FLOW_PX4_ALLOW_SIMD
+#if defined(__SSE2__) || defined(__ARM_NEON__) || defined(__aarch64__)
+#define FLOW_PX4_ALLOW_SIMD 1
+#else
+#define FLOW_PX4_ALLOW_SIMD 0
+#endif
+#endif
+
+#if FLOW_PX4_ALLOW_SIMD
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
@@ -116,6 +139,177 @@ static inline uint32_t compute_diff(uint8_t *image, uint16_t offx, uint16_t offy
     return acc;
 }
 
+#if FLOW_PX4_ALLOW_SIMD && defined(__SSE2__)
+static inline __m128i load_8px(const uint8_t *p)
+{
+    return _mm_loadl_epi64((const __m128i *)p);
+}
+
+// 8 pixels widened to 16 bits
+static inline __m128i load_8px_u16(const uint8_t *p)
+{
+    return _mm_unpacklo_epi8(load_8px(p), _mm_setzero_si128());
+}
+
+// two rows of 8 pixels in one register
+static inline __m128i load_2x8px(const uint8_t *p, uint16_t row_size)
+{
+    return _mm_unpacklo_epi64(load_8px(p), load_8px(p + row_size));
+}
+
+static inline uint32_t sum_sad(__m128i sad)
+{
+    return _mm_cvtsi128_si32(sad) + _mm_cvtsi128_si32(_mm_srli_si128(sad, 8));
+}
+
+static inline uint32_t compute_sad_8x8(const uint8_t *p1, const uint8_t *p2,
+                                       uint16_t row_size)
+{
+    __m128i acc = _mm_setzero_si128();
+
+    for (uint8_t j = 0; j < 8; j += 2) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(load_2x8px(p1 + j*row_size, row_size),
+                                              load_2x8px(p2 + j*row_size, row_size)));
+    }
+    return sum_sad(acc);
+}
+
+/*
+ * SAD of the 8 subpixel shifts of an 8x8 window, see compute_subpixel()
+ * for the positions. Each row of subpixels is computed on 16 bit lanes
+ * and two shifts are packed per register against the same pixels of
+ * image1.
+ */
+static inline void compute_subpixel_8x8(const uint8_t *p1, const uint8_t *p2,
+                                        uint32_t *acc, uint16_t row_size)
+{
+    __m128i acc01 = _mm_setzero_si128();
+    __m128i acc23 = _mm_setzero_si128();
+    __m128i acc45 = _mm_setzero_si128();
+    __m128i acc67 = _mm_setzero_si128();
+
+    for (uint8_t j = 0; j < 8; j++) {
+        const uint8_t *row = p2 + j*row_size;
+        const __m128i x = load_8px_u16(row);
+        const __m128i r = load_8px_u16(row + 1);
+        const __m128i l = load_8px_u16(row - 1);
+        const __m128i d = load_8px_u16(row + row_size);
+        const __m128i dr = load_8px_u16(row + row_size + 1);
+        const __m128i dl = load_8px_u16(row + row_size - 1);
+        const __m128i u = load_8px_u16(row - row_size);
+        const __m128i ur = load_8px_u16(row - row_size + 1);
+        const __m128i ul = load_8px_u16(row - row_size - 1);
+
+        const __m128i xr = _mm_add_epi16(x, r);
+        const __m128i xl = _mm_add_epi16(x, l);
+        const __m128i sub0 = _mm_srli_epi16(xr, 1);
+        const __m128i sub1 = _mm_srli_epi16(_mm_add_epi16(xr, _mm_add_epi16(d, dr)), 2);
+        const __m128i sub2 = _mm_srli_epi16(_mm_add_epi16(x, dr), 1);
+        const __m128i sub3 = _mm_srli_epi16(_mm_add_epi16(xl, _mm_add_epi16(dl, d)), 2);
+        const __m128i sub4 = _mm_srli_epi16(_mm_add_epi16(x, dl), 1);
+        const __m128i sub5 = _mm_srli_epi16(_mm_add_epi16(xl, _mm_add_epi16(ul, u)), 2);
+        const __m128i sub6 = _mm_srli_epi16(_mm_add_epi16(x, u), 1);
+        const __m128i sub7 = _mm_srli_epi16(_mm_add_epi16(xr, _mm_add_epi16(u, ur)), 2);
+
+        const __m128i src = load_8px(p1 + j*row_size);
+        const __m128i src2 = _mm_unpacklo_epi64(src, src);
+        acc01 = _mm_add_epi64(acc01, _mm_sad_epu8(_mm_packus_epi16(sub0, sub1), src2));
+        acc23 = _mm_add_epi64(acc23, _mm_sad_epu8(_mm_packus_epi16(sub2, sub3), src2));
+        acc45 = _mm_add_epi64(acc45, _mm_sad_epu8(_mm_packus_epi16(sub4, sub5), src2));
+        acc67 = _mm_add_epi64(acc67, _mm_sad_epu8(_mm_packus_epi16(sub6, sub7), src2));
+    }
+
+    acc[0] = _mm_cvtsi128_si32(acc01);
+    acc[1] = _mm_cvtsi128_si32(_mm_srli_si128(acc01, 8));
+    acc[2] = _mm_cvtsi128_si32(acc23);
+    acc[3] = _mm_cvtsi128_si32(_mm_srli_si128(acc23, 8));
+    acc[4] = _mm_cvtsi128_si32(acc45);
+    acc[5] = _mm_cvtsi128_si32(_mm_srli_si128(acc45, 8));
+    acc[6] = _mm_cvtsi128_si32(acc67);
+    acc[7] = _mm_cvtsi128_si32(_mm_srli_si128(acc67, 8));
+}
+#elif FLOW_PX4_ALLOW_SIMD
+static inline uint32_t sum_sad(uint16x8_t sad)
+{
+    const uint64x2_t sum = vpaddlq_u32(vpaddlq_u16(sad));
+    return vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1);
+}
+
+static inline uint32_t compute_sad_8x8(const uint8_t *p1, const uint8_t *p2,
+                                       uint16_t row_size)
+{
+    // at most 8 * 255 per lane
+    uint16x8_t acc = vdupq_n_u16(0);
+
+    for (uint8_t j = 0; j < 8; j++) {
+        acc = vabal_u8(acc, vld1_u8(p1 + j*row_size), vld1_u8(p2 + j*row_size));
+    }
+    return sum_sad(acc);
+}
+
+/*
+ * SAD of the 8 subpixel shifts of an 8x8 window, see compute_subpixel()
+ * for the positions. Each row of subpixels is computed on 16 bit lanes.
+ */
+static inline void compute_subpixel_8x8(const uint8_t *p1, const uint8_t *p2,
+                                        uint32_t *acc, uint16_t row_size)
+{
+    uint16x8_t sad[8];
+    for (uint8_t k = 0; k < 8; k++) {
+        sad[k] = vdupq_n_u16(0);
+    }
+
+    for (uint8_t j = 0; j < 8; j++) {
+        const uint8_t *row = p2 + j*row_size;
+        const uint16x8_t x = vmovl_u8(vld1_u8(row));
+        const uint16x8_t r = vmovl_u8(vld1_u8(row + 1));
+        const uint16x8_t l = vmovl_u8(vld1_u8(row - 1));
+        const uint16x8_t d = vmovl_u8(vld1_u8(row + row_size));
+        const uint16x8_t dr = vmovl_u8(vld1_u8(row + row_size + 1));
+        const uint16x8_t dl = vmovl_u8(vld1_u8(row + row_size - 1));
+        const uint16x8_t u = vmovl_u8(vld1_u8(row - row_size));
+        const uint16x8_t ur = vmovl_u8(vld1_u8(row - row_size + 1));
+        const uint16x8_t ul = vmovl_u8(vld1_u8(row - row_size - 1));
+
+        const uint16x8_t xr = vaddq_u16(x, r);
+        const uint16x8_t xl = vaddq_u16(x, l);
+        const uint8x8_t src = vld1_u8(p1 + j*row_size);
+        sad[0] = vabal_u8(sad[0], src, vshrn_n_u16(xr, 1));
+        sad[1] = vabal_u8(sad[1], src, vshrn_n_u16(vaddq_u16(xr, vaddq_u16(d, dr)), 2));
+        sad[2] = vabal_u8(sad[2], src, vshrn_n_u16(vaddq_u16(x, dr), 1));
+        sad[3] = vabal_u8(sad[3], src, vshrn_n_u16(vaddq_u16(xl, vaddq_u16(dl, d)), 2));
+        sad[4] = vabal_u8(sad[4], src, vshrn_n_u16(vaddq_u16(x, dl), 1));
+        sad[5] = vabal_u8(sad[5], src, vshrn_n_u16(vaddq_u16(xl, vaddq_u16(ul, u)), 2));
+        sad[6] = vabal_u8(sad[6], src, vshrn_n_u16(vaddq_u16(x, u), 1));
+        sad[7] = vabal_u8(sad[7], src, vshrn_n_u16(vaddq_u16(xr, vaddq_u16(u, ur)), 2));
+    }
+
+    for (uint8_t k = 0; k < 8; k++) {
+        acc[k] = sum_sad(sad[k]);
+    }
+}
+#endif
+
+/**
+ * @brief Compute SAD of two pixel windows without SIMD.
+ *
+ * @param p1 upper left corner of the pattern in image1
+ * @param p2 upper left corner of the pattern in image2
+ */
+static inline uint32_t compute_sad_scalar(const uint8_t *p1, const uint8_t *p2,
+                                          uint16_t row_size, uint16_t window_size)
+{
+    unsigned int i,j;
+    uint32_t acc = 0;
+
+    for (i = 0; i < window_size; i++) {
+        for (j = 0; j < window_size; j++) {
+            acc += abs(p1[i + j*row_size] - p2[i + j*row_size]);
+        }
+    }
+    return acc;
+}
+
 /**
  * @brief Compute SAD of two pixel windows.
  *
@@ -136,38 +330,28 @@ static inline uint32_t compute_sad(uint8_t *image1, uint8_t *image2,
      */
     uint16_t off1 = off1y * row_size + off1x;
     uint16_t off2 = off2y * row_size + off2x;
-    unsigned int i,j;
-    uint32_t acc = 0;
 
-    for (i = 0; i < window_size; i++) {
-        for (j = 0; j < window_size; j++) {
-            acc += abs(image1[off1 + i + j*row_size] -
-                       image2[off2 + i + j*row_size]);
-        }
+#if FLOW_PX4_ALLOW_SIMD
+    if (window_size == 8) {
+        return compute_sad_8x8(&image1[off1], &image2[off2], row_size);
     }
-    return acc;
+#endif
+
+    return compute_sad_scalar(&image1[off1], &image2[off2], row_size, window_size);
 }
 
 /**
- * @brief Compute SAD distances of subpixel shift of two pixel patterns.
+ * @brief Compute SAD distances of subpixel shift of two pixel patterns
+ *        without SIMD.
  *
- * @param image1 ...
- * @param image2 ...
- * @param off1X x coordinate of upper left corner of pattern in image1
- * @param off1Y y coordinate of upper left corner of pattern in image1
- * @param off2X x coordinate of upper left corner of pattern in image2
- * @param off2Y y coordinate of upper left corner of pattern in image2
+ * @param p1 upper left corner of the pattern in image1
+ * @param p2 upper left corner of the pattern in image2
  * @param acc array to store SAD distances for shift in every direction
  */
-static inline uint32_t compute_subpixel(uint8_t *image1, uint8_t *image2,
-                                        uint16_t off1x, uint16_t off1y,
-                                        uint16_t off2x, uint16_t off2y,
-                                        uint32_t *acc, uint16_t row_size,
-                                        uint16_t window_size)
+static inline void compute_subpixel_scalar(const uint8_t *p1, const uint8_t *p2,
+                                           uint32_t *acc, uint16_t row_size,
+                                           uint16_t window_size)
 {
-    /* calculate position in image buffer */
-    uint16_t off1 = off1y * row_size + off1x; // image1
-    uint16_t off2 = off2y * row_size + off2x; // image2
     uint8_t sub[8];
     uint16_t i, j, k;
 
@@ -191,47 +375,102 @@ static inline uint32_t compute_subpixel(uint8_t *image1, uint8_t *image2,
              * the pixel down from it, and the pixel down on
              * the right. etc...
              */
-            sub[0] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + j*row_size])/2;
+            sub[0] = (p2[i + j*row_size] +
+                      p2[i + 1 + j*row_size])/2;
 
-            sub[1] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + j*row_size] +
-                      image2[off2 + i + (j+1)*row_size] +
-                      image2[off2 + i + 1 + (j+1)*row_size])/4;
+            sub[1] = (p2[i + j*row_size] +
+                      p2[i + 1 + j*row_size] +
+                      p2[i + (j+1)*row_size] +
+                      p2[i + 1 + (j+1)*row_size])/4;
 
-            sub[2] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + (j+1)*row_size])/2;
+            sub[2] = (p2[i + j*row_size] +
+                      p2[i + 1 + (j+1)*row_size])/2;
 
-            sub[3] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i - 1 + j*row_size] +
-                      image2[off2 + i - 1 + (j+1)*row_size] +
-                      image2[off2 + i + (j+1)*row_size])/4;
+            sub[3] = (p2[i + j*row_size] +
+                      p2[i - 1 + j*row_size] +
+                      p2[i - 1 + (j+1)*row_size] +
+                      p2[i + (j+1)*row_size])/4;
 
-            sub[4] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i - 1 + (j+1)*row_size])/2;
+            sub[4] = (p2[i + j*row_size] +
+                      p2[i - 1 + (j+1)*row_size])/2;
 
-            sub[5] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i - 1 + j*row_size] +
-                      image2[off2 + i - 1 + (j-1)*row_size] +
-                      image2[off2 + i + (j-1)*row_size])/4;
+            sub[5] = (p2[i + j*row_size] +
+                      p2[i - 1 + j*row_size] +
+                      p2[i - 1 + (j-1)*row_size] +
+                      p2[i + (j-1)*row_size])/4;
 
-            sub[6] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + (j-1)*row_size])/2;
+            sub[6] = (p2[i + j*row_size] +
+                      p2[i + (j-1)*row_size])/2;
 
-            sub[7] = (image2[off2 + i + j*row_size] +
-                      image2[off2 + i + 1 + j*row_size] +
-                      image2[off2 + i + (j-1)*row_size] +
-                      image2[off2 + i + 1 + (j-1)*row_size])/4;
+            sub[7] = (p2[i + j*row_size] +
+                      p2[i + 1 + j*row_size] +
+                      p2[i + (j-1)*row_size] +
+                      p2[i + 1 + (j-1)*row_size])/4;
 
             for (k = 0; k < 8; k++) {
-                acc[k] += abs(image1[off1 + i + j*row_size] - sub[k]);
+                acc[k] += abs(p1[i + j*row_size] - sub[k]);
             }
         }
     }
+}
+
+/**
+ * @brief Compute SAD distances of subpixel shift of two pixel patterns.
+ *
+ * @param image1 ...
+ * @param image2 ...
+ * @param off1X x coordinate of upper left corner of pattern in image1
+ * @param off1Y y coordinate of upper left corner of pattern in image1
+ * @param off2X x coordinate of upper left corner of pattern in image2
+ * @param off2Y y coordinate of upper left corner of pattern in image2
+ * @param acc array to store SAD distances for shift in every direction
+ */
+static inline uint32_t compute_subpixel(uint8_t *image1, uint8_t *image2,
+                                        uint16_t off1x, uint16_t off1y,
+                                        uint16_t off2x, uint16_t off2y,
+                                        uint32_t *acc, uint16_t row_size,
+                                        uint16_t window_size)
+{
+    /* calculate position in image buffer */
+    uint16_t off1 = off1y * row_size + off1x; // image1
+    uint16_t off2 = off2y * row_size + off2x; // image2
+
+#if FLOW_PX4_ALLOW_SIMD
+    if (window_size == 8) {
+        compute_subpixel_8x8(&image1[off1], &image2[off2], acc, row_size);
+        return 0;
+    }
+#endif
 
+    compute_subpixel_scalar(&image1[off1], &image2[off2], acc, row_size, window_size);
     return 0;
 }
 
+const bool Flow_PX4::_simd = FLOW_PX4_ALLOW_SIMD;
+
+uint32_t Flow_PX4::_compute_sad_8x8(const uint8_t *p1, const uint8_t *p2,
+                                    uint16_t row_size, bool simd)
+{
+#if FLOW_PX4_ALLOW_SIMD
+    if (simd) {
+        return compute_sad_8x8(p1, p2, row_size);
+    }
+#endif
+    return compute_sad_scalar(p1, p2, row_size, 8);
+}
+
+void Flow_PX4::_compute_subpixel_8x8(const uint8_t *p1, const uint8_t *p2,
+                                     uint32_t *acc, uint16_t row_size, bool simd)
+{
+#if FLOW_PX4_ALLOW_SIMD
+    if (simd) {
+        compute_subpixel_8x8(p1, p2, acc, row_size);
+        return;
+    }
+#endif
+    compute_subpixel_scalar(p1, p2, acc, row_size, 8);
+}
+
 uint8_t Flow_PX4::compute_flow(uint8_t *image1, uint8_t *image2,
                                uint32_t delta_time, float *pixel_flow_x,
                                float *pixel_flow_y)
@@ -26,6 +26,17 @@ public:
              float bottom_flow_value_threshold);
     uint8_t compute_flow(uint8_t *image1, uint8_t *image2, uint32_t delta_time,
                          float *pixel_flow_x, float *pixel_flow_y);
+
+protected:
+    // true if the 8x8 windows are computed with SSE2 or NEON
+    static const bool _simd;
+
+    // the 8x8 window SADs, with or without SIMD
+    static uint32_t _compute_sad_8x8(const uint8_t *p1, const uint8_t *p2,
+                                     uint16_t row_size, bool simd);
+    static void _compute_subpixel_8x8(const uint8_t *p1, const uint8_t *p2,
+                                      uint32_t *acc, uint16_t row_size, bool simd);
+
 private:
     uint32_t _width;
     uint32_t _search_size;
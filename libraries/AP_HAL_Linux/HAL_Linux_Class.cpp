@@ -261,6 +261,9 @@ void _usage(void)
     printf("\tnetworking UDP:\n");
     printf("\t                  -A udp:11.0.0.255:14550:bcast\n");
     printf("\t                  -A udpin:0.0.0.0:14550\n");
+    printf("\tMAVLink server for many UDP and TCP clients:\n");
+    printf("\t                  -A server:0.0.0.0:14550\n");
+    printf("\t                  -A server:0.0.0.0:14550:20000 (bytes/s per client)\n");
     printf("\tcustom log path:\n");
     printf("\t                  --log-directory /var/APM/logs\n");
     printf("\t                  -l /var/APM/logs\n");
@@ -270,6 +273,14 @@ void _usage(void)
     printf("\tmodule support:\n");
     printf("\t                   --module-directory %s\n", AP_MODULE_DEFAULT_DIRECTORY);
     printf("\t                   -M %s\n", AP_MODULE_DEFAULT_DIRECTORY);
+    printf("\tthread priority, cpu affinity, rate and policy (NAME:PRIO[:CPU[:RATE[:POLICY]]]):\n");
+    printf("\t                   --thread ap-spi-0:14:1\n");
+    printf("\t                   -T ap-i2c-1:11\n");
+    printf("\t                   -T ap-main:12:3\n");
+    printf("\t                   -T ap-rcin:13:-1:500:rr\n");
+    printf("\tthread parameters from a file, one NAME:PRIO[:CPU[:RATE[:POLICY]]] per line:\n");
+    printf("\t                   --thread-config /etc/ardupilot/threads.conf\n");
+    printf("\t                   -P /etc/ardupilot/threads.conf\n");
 }
 
 void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
@@ -293,11 +304,13 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"log-directory",       true,  0, 'l'},
         {"terrain-directory",   true,  0, 't'},
         {"module-directory",    true,  0, 'M'},
+        {"thread",              true,  0, 'T'},
+        {"thread-config",       true,  0, 'P'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:he:SM:T:P:",
                     options);
 
     /*
@@ -340,6 +353,17 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         case 'M':
             module_path = gopt.optarg;
             break;
+        case 'T':
+            if (!schedulerInstance.parse_thread_params(gopt.optarg)) {
+                printf("Invalid thread parameters '%s'\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+        case 'P':
+            if (!schedulerInstance.load_thread_config(gopt.optarg)) {
+                exit(1);
+            }
+            break;
         case 'h':
             _usage();
             exit(0);
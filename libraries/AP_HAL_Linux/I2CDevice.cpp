@@ -257,9 +257,16 @@ AP_HAL::Device::PeriodicHandle I2CDevice::register_periodic_callback(
         char name[16];
         snprintf(name, sizeof(name), "ap-i2c-%u", _bus.bus);
 
+        int prio = AP_LINUX_SENSORS_SCHED_PRIO;
+        int cpu = -1;
+        int policy = AP_LINUX_SENSORS_SCHED_POLICY;
+        uint32_t rate = 0;
+        Scheduler::from(hal.scheduler)->get_thread_params(name, prio, cpu,
+                                                          policy, rate);
+
         _bus.thread.set_stack_size(AP_LINUX_SENSORS_STACK_SIZE);
-        _bus.thread.start(name, AP_LINUX_SENSORS_SCHED_POLICY,
-                          AP_LINUX_SENSORS_SCHED_PRIO);
+        _bus.thread.set_cpu_affinity(cpu);
+        _bus.thread.start(name, policy, prio);
     }
 
     return static_cast<AP_HAL::Device::PeriodicHandle>(p);
@@ -396,6 +403,19 @@ void I2CDeviceManager::_unregister(I2CBus &b)
     }
 }
 
+void I2CDeviceManager::print_stats()
+{
+    char name[16];
+
+    for (auto it = _buses.begin(); it != _buses.end(); it++) {
+        if (!(*it)->thread.is_started()) {
+            continue;
+        }
+        snprintf(name, sizeof(name), "ap-i2c-%u", (*it)->bus);
+        (*it)->thread.print_stats(name);
+    }
+}
+
 void I2CDeviceManager::teardown()
 {
     for (auto it = _buses.begin(); it != _buses.end(); it++) {
@@ -108,6 +108,11 @@ public:
      */
     void teardown();
 
+    /*
+     * Print jitter statistics of the periodic callbacks on each bus thread
+     */
+    void print_stats();
+
 protected:
     void _unregister(I2CBus &b);
     AP_HAL::OwnPtr<AP_HAL::I2CDevice> _create_device(I2CBus &b, uint8_t address) const;
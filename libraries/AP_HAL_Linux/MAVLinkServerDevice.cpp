@@ -0,0 +1,726 @@
+#include "MAVLinkServerDevice.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+extern const AP_HAL::HAL& hal;
+
+#define MAVLINK_SERVER_CLIENT_TIMEOUT_MS 10000
+
+/* epoll data of the server sockets, clients using their index */
+#define EPOLL_DATA_UDP      0xFFFF
+#define EPOLL_DATA_LISTENER 0xFFFE
+#define EPOLL_DATA_PENDING  0xFFFD
+
+/*
+  length of the MAVLink packet at the start of buf, 0 if it's not
+  complete yet
+ */
+static uint16_t mavlink_packet_length(const uint8_t *buf, uint16_t n)
+{
+    if (n < 3) {
+        return 0;
+    }
+    uint16_t len;
+    if (buf[0] == MAVLINK_STX_MAVLINK1) {
+        len = buf[1] + 8;
+    } else {
+        len = buf[1] + 12;
+        if (buf[2] & MAVLINK_IFLAG_SIGNED) {
+            len += MAVLINK_SIGNATURE_BLOCK_LEN;
+        }
+    }
+    return len <= n ? len : 0;
+}
+
+/*
+  source and targets of a complete MAVLink packet, the targets being -1
+  when the message has none. A MAVLink 2 payload is cut after its last
+  non-zero byte, so a target past its end is 0
+ */
+static void mavlink_packet_addresses(const uint8_t *pkt, uint8_t &sysid, uint8_t &compid,
+                                     int16_t &target_system, int16_t &target_component)
+{
+    const uint8_t payload_len = pkt[1];
+    const uint8_t *payload;
+    uint32_t msgid;
+    if (pkt[0] == MAVLINK_STX_MAVLINK1) {
+        sysid = pkt[3];
+        compid = pkt[4];
+        msgid = pkt[5];
+        payload = &pkt[6];
+    } else {
+        sysid = pkt[5];
+        compid = pkt[6];
+        msgid = pkt[7] | (pkt[8] << 8) | ((uint32_t)pkt[9] << 16);
+        payload = &pkt[10];
+    }
+
+    target_system = -1;
+    target_component = -1;
+    const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(msgid);
+    if (entry == nullptr) {
+        return;
+    }
+    if (entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_SYSTEM) {
+        target_system = entry->target_system_ofs < payload_len ? payload[entry->target_system_ofs] : 0;
+    }
+    if (entry->flags & MAV_MSG_ENTRY_FLAG_HAVE_TARGET_COMPONENT) {
+        target_component = entry->target_component_ofs < payload_len ? payload[entry->target_component_ofs] : 0;
+    }
+}
+
+MAVLinkServerDevice::MAVLinkServerDevice(const char *ip, uint16_t port, uint32_t client_rate):
+    _ip(ip),
+    _port(port),
+    _client_rate(client_rate)
+{
+    memset(_clients, 0, sizeof(_clients));
+}
+
+MAVLinkServerDevice::~MAVLinkServerDevice()
+{
+    close();
+    if (_epfd != -1) {
+        ::close(_epfd);
+    }
+    if (_pending_fd != -1) {
+        ::close(_pending_fd);
+    }
+}
+
+bool MAVLinkServerDevice::open()
+{
+    if (_epfd == -1) {
+        _epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epfd == -1) {
+            ::fprintf(stderr, "Failed to create epoll: %m\n");
+            return false;
+        }
+    }
+
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+
+    // readable while packets received from TCP clients wait to be read,
+    // as their sockets may have nothing more
+    if (_pending_fd == -1) {
+        _pending_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_pending_fd == -1) {
+            ::fprintf(stderr, "Failed to create eventfd: %m\n");
+            return false;
+        }
+        ev.data.u32 = EPOLL_DATA_PENDING;
+        epoll_ctl(_epfd, EPOLL_CTL_ADD, _pending_fd, &ev);
+    }
+
+    // open is retried until the network is up: keep what already worked
+    if (!_udp_bound) {
+        _udp.reuseaddress();
+        if (!_udp.bind(_ip, _port)) {
+            ::printf("MAVLink server: UDP bind failed on %s port %u - %s\n",
+                     _ip, _port, strerror(errno));
+            return false;
+        }
+        _udp.set_blocking(false);
+        ev.data.u32 = EPOLL_DATA_UDP;
+        epoll_ctl(_epfd, EPOLL_CTL_ADD, _udp.get_fd(), &ev);
+        _udp_bound = true;
+    }
+
+    if (!_listening) {
+        _listener.reuseaddress();
+        if (!_listener.bind(_ip, _port) || !_listener.listen(MAVLINK_SERVER_MAX_CLIENTS)) {
+            ::printf("MAVLink server: TCP listen failed on %s port %u - %s\n",
+                     _ip, _port, strerror(errno));
+            return false;
+        }
+        _listener.set_blocking(false);
+        ev.data.u32 = EPOLL_DATA_LISTENER;
+        epoll_ctl(_epfd, EPOLL_CTL_ADD, _listener.get_fd(), &ev);
+        _listening = true;
+    }
+
+    return true;
+}
+
+bool MAVLinkServerDevice::close()
+{
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS; i++) {
+        if (_clients[i].used) {
+            _remove_client(_clients[i]);
+        }
+    }
+    return true;
+}
+
+void MAVLinkServerDevice::set_blocking(bool blocking)
+{
+    // the sockets are always non-blocking
+}
+
+void MAVLinkServerDevice::set_speed(uint32_t speed)
+{
+}
+
+MAVLinkServerDevice::client *MAVLinkServerDevice::_add_client(SocketAPM *sock, const struct sockaddr_in &addr)
+{
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS; i++) {
+        struct client &c = _clients[i];
+        if (c.used) {
+            continue;
+        }
+        memset(&c, 0, sizeof(c));
+        c.used = true;
+        c.sock = sock;
+        c.addr = addr;
+        c.last_rx_ms = c.last_refill_ms = _millis();
+        c.tokens = _client_rate;
+        if (sock != nullptr) {
+            struct epoll_event ev {};
+            ev.events = EPOLLIN;
+            ev.data.u32 = i;
+            epoll_ctl(_epfd, EPOLL_CTL_ADD, sock->get_fd(), &ev);
+        }
+        ::printf("MAVLink server: %s client %s:%u connected\n",
+                 sock != nullptr ? "TCP" : "UDP",
+                 inet_ntoa(addr.sin_addr), ntohs(addr.sin_port));
+        return &c;
+    }
+    return nullptr;
+}
+
+void MAVLinkServerDevice::_remove_client(struct client &c)
+{
+    ::printf("MAVLink server: client %s:%u disconnected\n",
+             inet_ntoa(c.addr.sin_addr), ntohs(c.addr.sin_port));
+    if (c.sock != nullptr) {
+        // closing the socket removes it from the epoll set
+        delete c.sock;
+        c.sock = nullptr;
+    }
+    c.used = false;
+}
+
+/*
+  drop UDP clients which went silent, there is no other way to know
+  they left
+ */
+void MAVLinkServerDevice::_expire_clients()
+{
+    const uint32_t now = _millis();
+    if (now - _last_expire_ms < 1000) {
+        return;
+    }
+    _last_expire_ms = now;
+
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS; i++) {
+        struct client &c = _clients[i];
+        if (c.used && c.sock == nullptr &&
+            now - c.last_rx_ms > MAVLINK_SERVER_CLIENT_TIMEOUT_MS) {
+            _remove_client(c);
+        }
+    }
+}
+
+/*
+  token bucket of the client rate limit, holding up to 200ms worth of
+  data so short bursts go through. The part of a token earned since the
+  last refill is kept, so a client sending more often than it earns
+  whole tokens still gets its rate
+ */
+bool MAVLinkServerDevice::_take_tokens(struct client &c, uint32_t len)
+{
+    if (_client_rate == 0) {
+        return true;
+    }
+
+    const uint32_t now = _millis();
+    const uint32_t burst = MAX(_client_rate / 5, (uint32_t)MAVLINK_MAX_PACKET_LEN);
+    const uint64_t earned = (uint64_t)(now - c.last_refill_ms) * _client_rate + c.token_frac;
+    c.last_refill_ms = now;
+    if (c.tokens + earned / 1000 >= burst) {
+        c.tokens = burst;
+        c.token_frac = 0;
+    } else {
+        c.tokens += earned / 1000;
+        c.token_frac = earned % 1000;
+    }
+
+    if (c.tokens < len) {
+        c.rate_drops++;
+        return false;
+    }
+    c.tokens -= len;
+    return true;
+}
+
+void MAVLinkServerDevice::_accept()
+{
+    SocketAPM *sock = _listener.accept(0);
+    if (sock == nullptr) {
+        return;
+    }
+    sock->set_blocking(false);
+
+    struct sockaddr_in addr {};
+    socklen_t len = sizeof(addr);
+    getpeername(sock->get_fd(), (struct sockaddr *)&addr, &len);
+
+    if (_add_client(sock, addr) == nullptr) {
+        ::printf("MAVLink server: too many clients\n");
+        delete sock;
+    }
+}
+
+/*
+  stop waiting for data from a client while its buffer is full, as its
+  socket would stay readable
+ */
+void MAVLinkServerDevice::_set_rx_paused(struct client &c, bool paused)
+{
+    if (c.rx_paused == paused) {
+        return;
+    }
+    struct epoll_event ev {};
+    ev.events = paused ? 0 : EPOLLIN;
+    ev.data.u32 = &c - _clients;
+    epoll_ctl(_epfd, EPOLL_CTL_MOD, c.sock->get_fd(), &ev);
+    c.rx_paused = paused;
+}
+
+/*
+  skip anything which isn't the start of a packet
+ */
+void MAVLinkServerDevice::_resync(struct client &c)
+{
+    uint16_t start = 0;
+    while (start < c.rx_len &&
+           c.rx[start] != MAVLINK_STX_MAVLINK1 && c.rx[start] != MAVLINK_STX) {
+        start++;
+    }
+    c.rx_len -= start;
+    memmove(c.rx, &c.rx[start], c.rx_len);
+}
+
+void MAVLinkServerDevice::_recv_tcp(struct client &c)
+{
+    if (c.rx_len == sizeof(c.rx)) {
+        // wait for the packets received to be read
+        _set_rx_paused(c, true);
+        return;
+    }
+
+    ssize_t ret = ::recv(c.sock->get_fd(), &c.rx[c.rx_len], sizeof(c.rx) - c.rx_len, MSG_DONTWAIT);
+    if (ret == 0 || (ret < 0 && errno != EAGAIN && errno != EINTR)) {
+        _remove_client(c);
+        return;
+    }
+    if (ret > 0) {
+        c.rx_len += ret;
+        c.rx_bytes += ret;
+        c.last_rx_ms = _millis();
+        _resync(c);
+    }
+}
+
+ssize_t MAVLinkServerDevice::_recv_udp(uint8_t *buf, uint16_t n)
+{
+    struct sockaddr_in addr {};
+    socklen_t len = sizeof(addr);
+
+    // a datagram too long for buf would be truncated: leave it for a
+    // read with more room, unless no read can ever take it
+    ssize_t size = ::recv(_udp.get_fd(), nullptr, 0, MSG_PEEK | MSG_TRUNC | MSG_DONTWAIT);
+    if (size < 0) {
+        return -1;
+    }
+    if (size > n) {
+        if (size > MAVLINK_SERVER_MAX_DATAGRAM) {
+            ::recv(_udp.get_fd(), nullptr, 0, MSG_DONTWAIT);
+            _oversize_drops++;
+        }
+        return -1;
+    }
+
+    ssize_t ret = ::recvfrom(_udp.get_fd(), buf, n, MSG_DONTWAIT, (struct sockaddr *)&addr, &len);
+    if (ret <= 0) {
+        return -1;
+    }
+
+    struct client *from = nullptr;
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS; i++) {
+        struct client &c = _clients[i];
+        if (c.used && c.sock == nullptr &&
+            c.addr.sin_addr.s_addr == addr.sin_addr.s_addr &&
+            c.addr.sin_port == addr.sin_port) {
+            from = &c;
+            break;
+        }
+    }
+    if (from == nullptr) {
+        from = _add_client(nullptr, addr);
+    }
+    if (from != nullptr) {
+        from->rx_bytes += ret;
+        from->last_rx_ms = _millis();
+    }
+
+    _forward(from, buf, ret);
+
+    return ret;
+}
+
+/*
+  return a complete packet received from a TCP client, taking them in
+  turn so that the packets of the clients aren't interleaved
+ */
+ssize_t MAVLinkServerDevice::_read_tcp_packet(uint8_t *buf, uint16_t n)
+{
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS; i++) {
+        struct client &c = _clients[_next_tcp_client];
+        _next_tcp_client = (_next_tcp_client + 1) % MAVLINK_SERVER_MAX_CLIENTS;
+        if (!c.used || c.sock == nullptr) {
+            continue;
+        }
+
+        const uint16_t len = mavlink_packet_length(c.rx, c.rx_len);
+        if (len == 0 || len > n) {
+            continue;
+        }
+        memcpy(buf, c.rx, len);
+        c.rx_len -= len;
+        memmove(c.rx, &c.rx[len], c.rx_len);
+        _resync(c);
+        _set_rx_paused(c, false);
+
+        _forward(&c, buf, len);
+
+        return len;
+    }
+    return -1;
+}
+
+/*
+  signal whether packets received from TCP clients are waiting, as the
+  epoll fd otherwise only becomes readable with more data
+ */
+void MAVLinkServerDevice::_update_pending()
+{
+    bool pending = false;
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS && !pending; i++) {
+        const struct client &c = _clients[i];
+        pending = c.used && c.sock != nullptr && mavlink_packet_length(c.rx, c.rx_len) > 0;
+    }
+    if (pending == _pending) {
+        return;
+    }
+    if (pending) {
+        eventfd_write(_pending_fd, 1);
+    } else {
+        eventfd_t val;
+        eventfd_read(_pending_fd, &val);
+    }
+    _pending = pending;
+}
+
+/*
+  read one packet, from a UDP or a TCP client
+ */
+ssize_t MAVLinkServerDevice::read(uint8_t *buf, uint16_t n)
+{
+    ssize_t ret = _read(buf, n);
+    _update_pending();
+    return ret;
+}
+
+ssize_t MAVLinkServerDevice::_read(uint8_t *buf, uint16_t n)
+{
+    _expire_clients();
+
+    ssize_t ret = _read_tcp_packet(buf, n);
+    if (ret > 0) {
+        return ret;
+    }
+
+    struct epoll_event events[MAVLINK_SERVER_MAX_CLIENTS + 2];
+    int r = epoll_wait(_epfd, events, ARRAY_SIZE(events), 0);
+    bool udp_ready = false;
+
+    for (int i = 0; i < r; i++) {
+        const uint32_t data = events[i].data.u32;
+        if (data == EPOLL_DATA_UDP) {
+            udp_ready = true;
+        } else if (data == EPOLL_DATA_PENDING) {
+            // cleared by _update_pending()
+        } else if (data == EPOLL_DATA_LISTENER) {
+            _accept();
+        } else if (data < MAVLINK_SERVER_MAX_CLIENTS && _clients[data].used &&
+                   _clients[data].sock != nullptr) {
+            _recv_tcp(_clients[data]);
+        }
+    }
+
+    if (udp_ready) {
+        ret = _recv_udp(buf, n);
+        if (ret > 0) {
+            return ret;
+        }
+    }
+
+    return _read_tcp_packet(buf, n);
+}
+
+/*
+  a packet mustn't be cut at the end of the first element, so it's read
+  whole and then split between the elements
+ */
+ssize_t MAVLinkServerDevice::readv(const struct iovec *iov, int iovcnt)
+{
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        total += iov[i].iov_len;
+    }
+    if (iovcnt == 1 || iov[0].iov_len == total) {
+        return read((uint8_t *)iov[0].iov_base, MIN(total, (size_t)UINT16_MAX));
+    }
+
+    uint8_t buf[MIN(total, (size_t)MAVLINK_SERVER_MAX_DATAGRAM)];
+    ssize_t ret = read(buf, sizeof(buf));
+    if (ret <= 0) {
+        return ret;
+    }
+    size_t ofs = 0;
+    for (int i = 0; i < iovcnt && ofs < (size_t)ret; i++) {
+        const size_t n = MIN(iov[i].iov_len, ret - ofs);
+        memcpy(iov[i].iov_base, &buf[ofs], n);
+        ofs += n;
+    }
+    return ret;
+}
+
+ssize_t MAVLinkServerDevice::write(const uint8_t *buf, uint16_t n)
+{
+    struct iovec iov;
+    iov.iov_base = const_cast<uint8_t *>(buf);
+    iov.iov_len = n;
+    return writev(&iov, 1);
+}
+
+ssize_t MAVLinkServerDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    // a vehicle sending to the clients without reading from them still
+    // stops sending to those which left
+    _expire_clients();
+
+    return _fan_out(nullptr, iov, iovcnt);
+}
+
+/*
+  remember a system seen sending from a client, so packets for it are
+  sent there
+ */
+void MAVLinkServerDevice::_learn_route(struct client &c, uint8_t sysid, uint8_t compid)
+{
+    for (uint8_t i = 0; i < c.num_routes; i++) {
+        if (c.routes[i].sysid == sysid && c.routes[i].compid == compid) {
+            return;
+        }
+    }
+    if (c.num_routes < MAVLINK_SERVER_MAX_ROUTES) {
+        c.routes[c.num_routes].sysid = sysid;
+        c.routes[c.num_routes].compid = compid;
+        c.num_routes++;
+    }
+}
+
+/*
+  whether a packet for these targets goes to a client, as
+  MAVLink_routing::check_and_forward() decides it for a channel
+ */
+bool MAVLinkServerDevice::_routes_to(const struct client &c, int16_t target_system, int16_t target_component) const
+{
+    if (target_system <= 0) {
+        return true;
+    }
+    const bool match_system = target_system == mavlink_system.sysid;
+    for (uint8_t i = 0; i < c.num_routes; i++) {
+        if (c.routes[i].sysid == target_system &&
+            (target_component <= 0 || c.routes[i].compid == target_component || !match_system)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+  packets received from a client also go to the other clients they're
+  for: broadcasts to all of them, packets for a system to the clients it
+  was seen on, and packets for this vehicle alone to none
+ */
+void MAVLinkServerDevice::_forward(struct client *from, const uint8_t *buf, uint16_t n)
+{
+    uint16_t len;
+    for (; n > 0 && (buf[0] == MAVLINK_STX_MAVLINK1 || buf[0] == MAVLINK_STX) &&
+             (len = mavlink_packet_length(buf, n)) > 0;
+         buf += len, n -= len) {
+        uint8_t sysid, compid;
+        int16_t target_system, target_component;
+        mavlink_packet_addresses(buf, sysid, compid, target_system, target_component);
+
+        if (from != nullptr) {
+            _learn_route(*from, sysid, compid);
+        }
+        if (target_system == mavlink_system.sysid && target_component == mavlink_system.compid) {
+            continue;
+        }
+
+        struct iovec iov;
+        iov.iov_base = const_cast<uint8_t *>(buf);
+        iov.iov_len = len;
+        _fan_out(from, &iov, 1, target_system, target_component);
+    }
+}
+
+/*
+  send to a TCP client, keeping what doesn't fit to send it first next
+  time. Returns -1 if the client is still busy with a previous packet
+ */
+int MAVLinkServerDevice::_send_tcp(struct client &c, const struct iovec *iov, int iovcnt, uint32_t len)
+{
+    if (c.tx_len > 0) {
+        ssize_t ret = ::send(c.sock->get_fd(), c.tx, c.tx_len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (ret > 0) {
+            c.tx_len -= ret;
+            memmove(c.tx, &c.tx[ret], c.tx_len);
+            c.tx_bytes += ret;
+        }
+        if (c.tx_len > 0) {
+            return -1;
+        }
+    }
+
+    struct msghdr msg {};
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    ssize_t ret = ::sendmsg(c.sock->get_fd(), &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (ret < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+            _remove_client(c);
+            return 0;
+        }
+        return -1;
+    }
+    c.tx_bytes += ret;
+
+    // keep the rest of the packet, so the stream stays in sync
+    uint32_t ofs = 0;
+    for (int i = 0; i < iovcnt && c.tx_len < sizeof(c.tx); i++) {
+        for (uint32_t j = 0; j < iov[i].iov_len && c.tx_len < sizeof(c.tx); j++, ofs++) {
+            if (ofs >= (uint32_t)ret) {
+                c.tx[c.tx_len++] = ((const uint8_t *)iov[i].iov_base)[j];
+            }
+        }
+    }
+    return len;
+}
+
+/*
+  send to all the clients but from which the targets route to, with one
+  sendmmsg() for the UDP clients. Returns -1 if no client could take the
+  data, otherwise the length, even when some clients had to drop it
+ */
+ssize_t MAVLinkServerDevice::_fan_out(const struct client *from, const struct iovec *iov, int iovcnt,
+                                      int16_t target_system, int16_t target_component)
+{
+    uint32_t len = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
+
+    struct mmsghdr msgs[MAVLINK_SERVER_MAX_CLIENTS];
+    struct client *udp_clients[MAVLINK_SERVER_MAX_CLIENTS];
+    uint8_t n_udp = 0;
+    uint8_t n_clients = 0;
+    uint8_t n_blocked = 0;
+
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS; i++) {
+        struct client &c = _clients[i];
+        if (!c.used || &c == from || !_routes_to(c, target_system, target_component)) {
+            continue;
+        }
+        n_clients++;
+        if (!_take_tokens(c, len)) {
+            continue;
+        }
+        if (c.sock != nullptr) {
+            if (_send_tcp(c, iov, iovcnt, len) < 0) {
+                c.backpressure_drops++;
+                n_blocked++;
+            }
+            continue;
+        }
+        struct msghdr &hdr = msgs[n_udp].msg_hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_name = &c.addr;
+        hdr.msg_namelen = sizeof(c.addr);
+        hdr.msg_iov = const_cast<struct iovec *>(iov);
+        hdr.msg_iovlen = iovcnt;
+        udp_clients[n_udp++] = &c;
+    }
+
+    if (n_udp > 0) {
+        int sent = sendmmsg(_udp.get_fd(), msgs, n_udp, MSG_DONTWAIT);
+        if (sent < 0) {
+            sent = 0;
+        }
+        for (uint8_t i = 0; i < n_udp; i++) {
+            if (i < sent) {
+                udp_clients[i]->tx_bytes += len;
+            } else {
+                udp_clients[i]->backpressure_drops++;
+                n_blocked++;
+            }
+        }
+    }
+
+    if (from == nullptr && n_clients > 0 && n_blocked == n_clients) {
+        // the data was sent to no one: keep it in the UART buffer
+        errno = EAGAIN;
+        return -1;
+    }
+    return len;
+}
+
+void MAVLinkServerDevice::print_stats(const char *name) const
+{
+    for (uint8_t i = 0; i < MAVLINK_SERVER_MAX_CLIENTS; i++) {
+        const struct client &c = _clients[i];
+        if (!c.used) {
+            continue;
+        }
+        fprintf(stderr, "%-16s %s %s:%u\t"
+                "rx: %" PRIu64 " bytes\t"
+                "tx: %" PRIu64 " bytes\t"
+                "drops rate: %" PRIu32 "\t"
+                "backpressure: %" PRIu32 "\n",
+                name, c.sock != nullptr ? "tcp" : "udp",
+                inet_ntoa(c.addr.sin_addr), ntohs(c.addr.sin_port),
+                c.rx_bytes, c.tx_bytes, c.rate_drops, c.backpressure_drops);
+    }
+    if (_oversize_drops > 0) {
+        fprintf(stderr, "%-16s oversize datagrams dropped: %" PRIu32 "\n",
+                name, _oversize_drops);
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <netinet/in.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/Socket.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+#include "SerialDevice.h"
+
+#define MAVLINK_SERVER_MAX_CLIENTS 16
+#define MAVLINK_SERVER_MAX_DATAGRAM 2048
+#define MAVLINK_SERVER_MAX_ROUTES 4
+
+/*
+  MAVLink server for many clients on one port, over both UDP and TCP.
+
+  Every packet written is sent to all the clients, to UDP clients with a
+  single sendmmsg() call. Packets received from a client are read by the
+  UART and also forwarded to the other clients they're for, with the
+  rules of MAVLink_routing and the systems seen on each client, so that
+  clients reach each other as if they were on their own channels, while
+  MAVLink_routing routes them to and from the rest of the system through
+  the channel of the UART.
+
+  UDP clients are added when they first send a packet and dropped when
+  they stay silent for MAVLINK_SERVER_CLIENT_TIMEOUT_MS. A TCP client
+  isn't read from while it has a full buffer of packets waiting for the
+  UART, which doesn't read the device while it has less room than a
+  datagram, so neither side spins on data it can't take. Each client can
+  be limited to a number of bytes per second, packets over the limit
+  being dropped for that client only. A client which can't keep up also
+  only loses its own packets: writes are refused, so data stays in the
+  UART buffer, only when no client can take it.
+ */
+class MAVLinkServerDevice: public SerialDevice {
+public:
+    MAVLinkServerDevice(const char *ip, uint16_t port, uint32_t client_rate);
+    virtual ~MAVLinkServerDevice();
+
+    virtual bool open() override;
+    virtual bool close() override;
+    virtual void set_blocking(bool blocking) override;
+    virtual void set_speed(uint32_t speed) override;
+    virtual ssize_t write(const uint8_t *buf, uint16_t n) override;
+    virtual ssize_t read(uint8_t *buf, uint16_t n) override;
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt) override;
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt) override;
+
+    /* epoll file descriptor with the sockets of the server and its clients */
+    virtual int get_fd() const override { return _epfd; }
+
+    /* room for any datagram, so it's never truncated */
+    virtual uint16_t get_min_read_space() const override { return MAVLINK_SERVER_MAX_DATAGRAM; }
+
+    virtual void print_stats(const char *name) const override;
+
+protected:
+    /* time of the client timeouts and rate limits */
+    virtual uint32_t _millis() const { return AP_HAL::millis(); }
+
+private:
+    struct client {
+        bool used;
+        SocketAPM *sock;            // nullptr for UDP clients
+        struct sockaddr_in addr;
+        uint32_t last_rx_ms;
+
+        // systems and components seen sending from this client
+        struct {
+            uint8_t sysid;
+            uint8_t compid;
+        } routes[MAVLINK_SERVER_MAX_ROUTES];
+        uint8_t num_routes;
+
+        // rate limit, and thousandths of a token left over from the
+        // last refill
+        uint32_t tokens;
+        uint16_t token_frac;
+        uint32_t last_refill_ms;
+
+        // received bytes not yet forming a complete packet, TCP only
+        uint8_t rx[MAVLINK_MAX_PACKET_LEN];
+        uint16_t rx_len;
+        bool rx_paused;
+
+        // rest of a packet partially sent, TCP only
+        uint8_t tx[MAVLINK_MAX_PACKET_LEN];
+        uint16_t tx_len;
+
+        uint64_t rx_bytes;
+        uint64_t tx_bytes;
+        uint32_t rate_drops;
+        uint32_t backpressure_drops;
+    } _clients[MAVLINK_SERVER_MAX_CLIENTS];
+
+    bool _take_tokens(struct client &c, uint32_t len);
+    struct client *_add_client(SocketAPM *sock, const struct sockaddr_in &addr);
+    void _remove_client(struct client &c);
+    void _expire_clients();
+    void _accept();
+    void _recv_tcp(struct client &c);
+    void _resync(struct client &c);
+    void _set_rx_paused(struct client &c, bool paused);
+    void _update_pending();
+    ssize_t _read(uint8_t *buf, uint16_t n);
+    ssize_t _recv_udp(uint8_t *buf, uint16_t n);
+    ssize_t _read_tcp_packet(uint8_t *buf, uint16_t n);
+    int _send_tcp(struct client &c, const struct iovec *iov, int iovcnt, uint32_t len);
+    void _learn_route(struct client &c, uint8_t sysid, uint8_t compid);
+    bool _routes_to(const struct client &c, int16_t target_system, int16_t target_component) const;
+    void _forward(struct client *from, const uint8_t *buf, uint16_t n);
+    ssize_t _fan_out(const struct client *from, const struct iovec *iov, int iovcnt,
+                     int16_t target_system = -1, int16_t target_component = -1);
+
+    SocketAPM _udp{true};
+    SocketAPM _listener{false};
+    int _epfd = -1;
+    int _pending_fd = -1;
+    bool _pending = false;
+    uint32_t _oversize_drops = 0;
+    bool _udp_bound = false;
+    bool _listening = false;
+    const char *_ip;
+    uint16_t _port;
+    uint32_t _client_rate;
+    uint8_t _next_tcp_client = 0;
+    uint32_t _last_expire_ms = 0;
+};
@@ -35,7 +35,11 @@
 #include "AP_HAL/utility/RingBuffer.h"
 
 #define OPTICAL_FLOW_ONBOARD_RTPRIO 11
+#define OPTICAL_FLOW_ONBOARD_CAPTURE_RTPRIO 12
 static const unsigned int OPTICAL_FLOW_GYRO_BUFFER_LEN = 400;
+/* frames in flight between capture and flow: the two being compared and
+ * up to two waiting */
+static const uint8_t OPTICAL_FLOW_PIPELINE_LEN = 4;
 
 extern const AP_HAL::HAL& hal;
 
@@ -48,10 +52,6 @@ void OpticalFlow_Onboard::init()
     uint32_t memtype = V4L2_MEMORY_MMAP;
     unsigned int nbufs = 0;
     int ret;
-    pthread_attr_t attr;
-    struct sched_param param = {
-        .sched_priority = OPTICAL_FLOW_ONBOARD_RTPRIO
-    };
 
     if (_initialized) {
         return;
@@ -163,6 +163,48 @@ void OpticalFlow_Onboard::init()
         AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate video buffers");
     }
 
+    /* frames that aren't grey, or need a software crop or shrink, are
+     * converted in a single pass into a buffer of the pipeline, else the
+     * flow is computed on the V4L2 buffers directly */
+    _pixel_size = _format == V4L2_PIX_FMT_YUYV ? 2 : 1;
+    _convert = _format == V4L2_PIX_FMT_YUYV || _shrink_by_software ||
+        _crop_by_software;
+    _convert_scale = 1;
+    if (_shrink_by_software) {
+        if (_camera_output_width > _camera_output_height) {
+            _convert_scale = _camera_output_height / _height;
+        } else {
+            _convert_scale = _camera_output_width / _width;
+        }
+        _convert_left = (_camera_output_width - _width * _convert_scale) / 2;
+        _convert_top = (_camera_output_height - _height * _convert_scale) / 2;
+    } else if (_crop_by_software) {
+        _convert_left = _camera_output_width / 2 - _width / 2;
+        _convert_top = _camera_output_height / 2 - _height / 2;
+    } else {
+        _camera_output_width = _width;
+        _camera_output_height = _height;
+        _convert_left = 0;
+        _convert_top = 0;
+    }
+    if (_convert) {
+        _bytesperline = _width;
+    }
+
+    _frames = new Frame[OPTICAL_FLOW_PIPELINE_LEN];
+    _free_frames = new ObjectBuffer<uint8_t>(OPTICAL_FLOW_PIPELINE_LEN);
+    _ready_frames = new ObjectBuffer<uint8_t>(OPTICAL_FLOW_PIPELINE_LEN);
+    for (uint8_t i = 0; i < OPTICAL_FLOW_PIPELINE_LEN; i++) {
+        _frames[i].data = nullptr;
+        if (_convert) {
+            _frames[i].data = (uint8_t *)malloc(_width * _height);
+            if (!_frames[i].data) {
+                AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate conversion buffer\n");
+            }
+        }
+        _free_frames->push(i);
+    }
+
     _videoin->prepare_capture();
 
     /* Use px4 algorithm for optical flow */
@@ -171,12 +213,37 @@ void OpticalFlow_Onboard::init()
                          HAL_FLOW_PX4_BOTTOM_FLOW_FEATURE_THRESHOLD,
                          HAL_FLOW_PX4_BOTTOM_FLOW_VALUE_THRESHOLD);
 
-    /* Create the thread that will be waiting for frames
-     * Initialize thread and mutex */
+    _gyro_ring_buffer = new ObjectBuffer<GyroSample>(OPTICAL_FLOW_GYRO_BUFFER_LEN);
+
+    /* Create the threads that will be waiting for frames and computing
+     * the flow. Initialize threads and mutexes */
     ret = pthread_mutex_init(&_mutex, nullptr);
     if (ret != 0) {
         AP_HAL::panic("OpticalFlow_Onboard: failed to init mutex");
     }
+    ret = pthread_mutex_init(&_frame_mutex, nullptr);
+    if (ret != 0) {
+        AP_HAL::panic("OpticalFlow_Onboard: failed to init mutex");
+    }
+    ret = pthread_cond_init(&_frame_cond, nullptr);
+    if (ret != 0) {
+        AP_HAL::panic("OpticalFlow_Onboard: failed to init cond");
+    }
+
+    _start_thread(&_flow_thread, _compute_thread, OPTICAL_FLOW_ONBOARD_RTPRIO);
+    _start_thread(&_thread, _read_thread, OPTICAL_FLOW_ONBOARD_CAPTURE_RTPRIO);
+
+    _initialized = true;
+}
+
+void OpticalFlow_Onboard::_start_thread(pthread_t *thread,
+                                        void *(*start)(void *), int prio)
+{
+    pthread_attr_t attr;
+    struct sched_param param = {
+        .sched_priority = prio
+    };
+    int ret;
 
     ret = pthread_attr_init(&attr);
     if (ret != 0) {
@@ -185,14 +252,10 @@ void OpticalFlow_Onboard::init()
     pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
     pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
     pthread_attr_setschedparam(&attr, &param);
-    ret = pthread_create(&_thread, &attr, _read_thread, this);
+    ret = pthread_create(thread, &attr, start, this);
     if (ret != 0) {
         AP_HAL::panic("OpticalFlow_Onboard: failed to create thread");
     }
-
-    _gyro_ring_buffer = new ObjectBuffer<GyroSample>(OPTICAL_FLOW_GYRO_BUFFER_LEN);
-
-    _initialized = true;
 }
 
 bool OpticalFlow_Onboard::read(AP_HAL::OpticalFlow::Data_Frame& frame)
@@ -262,135 +325,121 @@ void *OpticalFlow_Onboard::_read_thread(void *arg)
 {
     OpticalFlow_Onboard *optflow_onboard = (OpticalFlow_Onboard *) arg;
 
-    optflow_onboard->_run_optflow();
+    optflow_onboard->_run_capture();
     return nullptr;
 }
 
-void OpticalFlow_Onboard::_run_optflow()
+void *OpticalFlow_Onboard::_compute_thread(void *arg)
 {
-    GyroSample gyro_sample;
-    Vector2f flow_rate;
-    VideoIn::Frame video_frame;
-    uint32_t convert_buffer_size = 0, output_buffer_size = 0;
-    uint32_t crop_left = 0, crop_top = 0;
-    uint32_t shrink_scale = 0, shrink_width = 0, shrink_height = 0;
-    uint32_t shrink_width_offset = 0, shrink_height_offset = 0;
-    uint8_t *convert_buffer = nullptr, *output_buffer = nullptr;
-    uint8_t qual;
+    OpticalFlow_Onboard *optflow_onboard = (OpticalFlow_Onboard *) arg;
 
-    if (_format == V4L2_PIX_FMT_YUYV) {
-        if (_shrink_by_software || _crop_by_software) {
-            convert_buffer_size = _camera_output_width * _camera_output_height;
-        } else {
-            convert_buffer_size = _width * _height;
-        }
+    optflow_onboard->_run_flow();
+    return nullptr;
+}
 
-        convert_buffer = (uint8_t *)malloc(convert_buffer_size);
-        if (!convert_buffer) {
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate conversion buffer\n");
-        }
-    }
+/* capture stage: dequeue the frames and hand them to the flow stage, after
+ * converting them if needed. A converted frame gives its V4L2 buffer back
+ * to the driver right away */
+void OpticalFlow_Onboard::_run_capture()
+{
+    VideoIn::Frame video_frame;
+    uint8_t index;
 
-    if (_shrink_by_software || _crop_by_software) {
-        output_buffer_size = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH *
-            HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
+    while (true) {
+        /* wait for next frame to come */
+        if (!_videoin->get_frame(video_frame)) {
+            AP_HAL::panic("OpticalFlow_Onboard: couldn't get frame\n");
+        }
 
-        output_buffer = (uint8_t *)malloc(output_buffer_size);
-        if (!output_buffer) {
-            if (convert_buffer) {
-                free(convert_buffer);
+        if (!_free_frames->pop(index)) {
+            /* the flow stage is behind: drop the oldest frame waiting for
+             * it and reuse it for this one, so that it goes on with the
+             * latest frames. The flow stage also takes the ready frames
+             * holding the mutex */
+            pthread_mutex_lock(&_frame_mutex);
+            const bool dropped = _ready_frames->pop(index);
+            pthread_mutex_unlock(&_frame_mutex);
+            if (!dropped) {
+                /* all the frames are in the flow stage */
+                _videoin->put_frame(video_frame);
+                continue;
+            }
+            if (!_convert) {
+                _videoin->put_frame(_frames[index].video_frame);
             }
-
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't allocate crop buffer\n");
         }
-    }
 
-    if (_shrink_by_software) {
-        if (_camera_output_width > _camera_output_height) {
-            shrink_scale = (uint32_t) _camera_output_height /
-                HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT;
+        Frame &frame = _frames[index];
+        frame.timestamp = video_frame.timestamp;
+        if (_convert) {
+            VideoIn::downscale_to_grey((uint8_t *)video_frame.data,
+                                       _camera_output_width, _pixel_size,
+                                       _convert_left, _convert_top,
+                                       _convert_scale, _width, _height,
+                                       frame.data);
+            _videoin->put_frame(video_frame);
         } else {
-            shrink_scale = (uint32_t) _camera_output_width /
-                HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH;
+            frame.video_frame = video_frame;
+            frame.data = (uint8_t *)video_frame.data;
         }
 
-        shrink_width = HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH * shrink_scale;
-        shrink_height = HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT * shrink_scale;
-
-        shrink_width_offset = (_camera_output_width - shrink_width) / 2;
-        shrink_height_offset = (_camera_output_height - shrink_height) / 2;
-    } else if (_crop_by_software) {
-        crop_left = _camera_output_width / 2 -
-           HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH / 2;
-        crop_top = _camera_output_height / 2 -
-           HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT / 2;
+        pthread_mutex_lock(&_frame_mutex);
+        _ready_frames->push(index);
+        pthread_cond_signal(&_frame_cond);
+        pthread_mutex_unlock(&_frame_mutex);
     }
+}
 
-    while(true) {
-        /* wait for next frame to come */
-        if (!_videoin->get_frame(video_frame)) {
-            if (convert_buffer) {
-               free(convert_buffer);
-            }
-
-            if (output_buffer) {
-               free(output_buffer);
-            }
-
-            AP_HAL::panic("OpticalFlow_Onboard: couldn't get frame\n");
-        }
-
-        if (_format == V4L2_PIX_FMT_YUYV) {
-            VideoIn::yuyv_to_grey((uint8_t *)video_frame.data,
-                convert_buffer_size * 2, convert_buffer);
+void OpticalFlow_Onboard::_release_frame(uint8_t index)
+{
+    if (!_convert) {
+        _videoin->put_frame(_frames[index].video_frame);
+    }
+    _free_frames->push(index);
+}
 
-            memset(video_frame.data, 0, convert_buffer_size * 2);
-            memcpy(video_frame.data, convert_buffer, convert_buffer_size);
-        }
+/* flow stage: compute the flow between each frame and the previous one */
+void OpticalFlow_Onboard::_run_flow()
+{
+    GyroSample gyro_sample;
+    Vector2f flow_rate;
+    int16_t last_index = -1;
+    uint8_t index;
+    uint8_t qual;
 
-        if (_shrink_by_software) {
-            /* shrink_8bpp() will shrink a selected area using the offsets,
-             * therefore, we don't need the crop. */
-            VideoIn::shrink_8bpp((uint8_t *)video_frame.data, output_buffer,
-                                 _camera_output_width, _camera_output_height,
-                                 shrink_width_offset, shrink_width,
-                                 shrink_height_offset, shrink_height,
-                                 shrink_scale, shrink_scale);
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
-        } else if (_crop_by_software) {
-            VideoIn::crop_8bpp((uint8_t *)video_frame.data, output_buffer,
-                               _camera_output_width,
-                               crop_left, HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH,
-                               crop_top, HAL_OPTFLOW_ONBOARD_OUTPUT_HEIGHT);
-
-            memset(video_frame.data, 0, _camera_output_width * _camera_output_height);
-            memcpy(video_frame.data, output_buffer, output_buffer_size);
+    while (true) {
+        pthread_mutex_lock(&_frame_mutex);
+        while (!_ready_frames->pop(index)) {
+            pthread_cond_wait(&_frame_cond, &_frame_mutex);
         }
+        pthread_mutex_unlock(&_frame_mutex);
 
         /* if it is at least the second frame we receive
          * since we have to compare 2 frames */
-        if (_last_video_frame.data == nullptr) {
-            _last_video_frame = video_frame;
+        if (last_index == -1) {
+            last_index = index;
             continue;
         }
+        const Frame &frame = _frames[index];
+        const Frame &last_frame = _frames[last_index];
+        const uint32_t dt = frame.timestamp - last_frame.timestamp;
 
         /* read the integrated gyro data */
-        _get_integrated_gyros(video_frame.timestamp, gyro_sample);
+        _get_integrated_gyros(frame.timestamp, gyro_sample);
 
 #ifdef OPTICALFLOW_ONBOARD_RECORD_VIDEO
         int fd = open(OPTICALFLOW_ONBOARD_VIDEO_FILE, O_CLOEXEC | O_CREAT | O_WRONLY
                 | O_APPEND, S_IRUSR | S_IWUSR | S_IRGRP |
                 S_IWGRP | S_IROTH | S_IWOTH);
 	    if (fd != -1) {
-	        write(fd, video_frame.data, _sizeimage);
+	        write(fd, frame.data, _convert ? _width * _height : _sizeimage);
 #ifdef OPTICALFLOW_ONBOARD_RECORD_METADATAS
             struct PACKED {
                 uint32_t timestamp;
                 float x;
                 float y;
                 float z;
-            } metas = { video_frame.timestamp, rate_x, rate_y, rate_z};
+            } metas = { frame.timestamp, rate_x, rate_y, rate_z};
             write(fd, &metas, sizeof(metas));
 #endif
 	        close(fd);
@@ -400,10 +449,7 @@ void OpticalFlow_Onboard::_run_optflow()
         /* compute gyro data and video frames
          * get flow rate to send it to the opticalflow driver
          */
-        qual = _flow->compute_flow((uint8_t*)_last_video_frame.data,
-                                   (uint8_t *)video_frame.data,
-                                   video_frame.timestamp -
-                                   _last_video_frame.timestamp,
+        qual = _flow->compute_flow(last_frame.data, frame.data, dt,
                                    &flow_rate.x, &flow_rate.y);
 
         /* fill data frame for upper layers */
@@ -412,31 +458,22 @@ void OpticalFlow_Onboard::_run_optflow()
                                   HAL_FLOW_PX4_FOCAL_LENGTH_MILLIPX;
         _pixel_flow_y_integral += flow_rate.y /
                                   HAL_FLOW_PX4_FOCAL_LENGTH_MILLIPX;
-        _integration_timespan += video_frame.timestamp -
-                                 _last_video_frame.timestamp;
+        _integration_timespan += dt;
         _gyro_x_integral       += (gyro_sample.gyro.x - _last_gyro_rate.x) *
-                                  (video_frame.timestamp - _last_video_frame.timestamp) /
+                                  dt /
                                   (gyro_sample.time_us - _last_integration_time);
         _gyro_y_integral       += (gyro_sample.gyro.y - _last_gyro_rate.y) /
                                   (gyro_sample.time_us - _last_integration_time) *
-                                  (video_frame.timestamp - _last_video_frame.timestamp);
+                                  dt;
         _surface_quality = qual;
         _data_available = true;
         pthread_mutex_unlock(&_mutex);
 
-        /* give the last frame back to the video input driver */
-        _videoin->put_frame(_last_video_frame);
+        /* give the last frame back to the capture stage */
+        _release_frame(last_index);
         _last_integration_time = gyro_sample.time_us;
-        _last_video_frame = video_frame;
+        last_index = index;
         _last_gyro_rate = gyro_sample.gyro;
     }
-
-    if (convert_buffer) {
-        free(convert_buffer);
-    }
-
-    if (output_buffer) {
-        free(output_buffer);
-    }
 }
 #endif
@@ -42,16 +42,39 @@ public:
     void push_gyro_bias(float gyro_bias_x, float gyro_bias_y);
 
 private:
-    void _run_optflow();
+    /* a grey frame on its way from the capture to the flow stage. It is
+     * the V4L2 buffer itself when no conversion is needed, or a buffer of
+     * the pipeline holding the converted frame */
+    struct Frame {
+        VideoIn::Frame video_frame;
+        uint8_t *data;
+        uint32_t timestamp;
+    };
+
+    void _start_thread(pthread_t *thread, void *(*start)(void *), int prio);
+    void _run_capture();
+    void _run_flow();
+    void _release_frame(uint8_t index);
     static void *_read_thread(void *arg);
+    static void *_compute_thread(void *arg);
     void _get_integrated_gyros(uint64_t timestamp, GyroSample &gyro);
     VideoIn* _videoin;
-    VideoIn::Frame _last_video_frame;
     PWM_Sysfs_Base* _pwm;
     CameraSensor* _camerasensor;
     Flow_PX4* _flow;
     pthread_t _thread;
+    pthread_t _flow_thread;
     pthread_mutex_t _mutex;
+    Frame *_frames;
+    ObjectBuffer<uint8_t> *_free_frames;
+    ObjectBuffer<uint8_t> *_ready_frames;
+    pthread_mutex_t _frame_mutex;
+    pthread_cond_t _frame_cond;
+    bool _convert;
+    uint32_t _pixel_size;
+    uint32_t _convert_left;
+    uint32_t _convert_top;
+    uint32_t _convert_scale;
     bool _initialized;
     bool _data_available;
     bool _crop_by_software;
@@ -17,10 +17,13 @@
 #include "PollerThread.h"
 
 #include <algorithm>
+#include <inttypes.h>
 #include <poll.h>
+#include <stdio.h>
 #include <sys/epoll.h>
 #include <sys/timerfd.h>
 
+#include <AP_HAL/AP_HAL.h>
 #include <AP_Math/AP_Math.h>
 
 namespace Linux {
@@ -33,10 +36,32 @@ void TimerPollable::on_can_read()
 
     uint64_t nevents = 0;
     int r = read(_fd, &nevents, sizeof(nevents));
-    if (r < 0) {
+    if (r < 0 || nevents == 0) {
         return;
     }
 
+    /* more than one expiration means we completely missed a period */
+    _stats.overruns += nevents - 1;
+    _expired_usec = _deadline_usec + (nevents - 1) * _period_usec;
+    _deadline_usec = _expired_usec + _period_usec;
+    _pending = true;
+}
+
+void TimerPollable::run()
+{
+    uint64_t now_usec = AP_HAL::micros64();
+    uint32_t jitter_usec = 0;
+
+    if (now_usec > _expired_usec) {
+        jitter_usec = now_usec - _expired_usec;
+    }
+
+    _pending = false;
+
+    _stats.count++;
+    _stats.max_jitter_usec = MAX(_stats.max_jitter_usec, jitter_usec);
+    _stats.avg_jitter_usec += (jitter_usec - _stats.avg_jitter_usec) / _stats.count;
+
     if (_wrapper) {
         _wrapper->start_cb();
     }
@@ -76,13 +101,17 @@ bool TimerPollable::adjust_timer(uint32_t timeout_usec)
 
     struct itimerspec spec = { };
 
-    spec.it_interval.tv_nsec = timeout_usec * NSEC_PER_USEC;
-    spec.it_value.tv_nsec = timeout_usec * NSEC_PER_USEC;
+    spec.it_interval.tv_sec = timeout_usec / USEC_PER_SEC;
+    spec.it_interval.tv_nsec = (timeout_usec % USEC_PER_SEC) * NSEC_PER_USEC;
+    spec.it_value = spec.it_interval;
 
     if (timerfd_settime(_fd, 0, &spec, nullptr) < 0) {
         return false;
     }
 
+    _period_usec = timeout_usec;
+    _deadline_usec = AP_HAL::micros64() + timeout_usec;
+
     return true;
 }
 
@@ -132,6 +161,49 @@ void PollerThread::_cleanup_timers()
     }
 }
 
+/*
+ * Run the callbacks whose timers expired, in earliest-deadline-first order:
+ * when several timers expire in the same wakeup, the one closest to missing
+ * its next period runs first. Callbacks are not preempted, so a long
+ * callback still delays the others on the same bus.
+ */
+void PollerThread::_run_timers()
+{
+    for (;;) {
+        TimerPollable *next = nullptr;
+
+        for (TimerPollable *p : _timers) {
+            if (!p->_pending || p->_removeme) {
+                continue;
+            }
+            if (!next || p->_deadline_usec < next->_deadline_usec) {
+                next = p;
+            }
+        }
+
+        if (!next) {
+            break;
+        }
+
+        next->run();
+    }
+}
+
+void PollerThread::print_stats(const char *name) const
+{
+    for (const TimerPollable *p : _timers) {
+        const TimerPollable::Stats &st = p->get_stats();
+
+        fprintf(stderr, "%-16s period: %" PRIu32 "us\t"
+                "count: %" PRIu64 "\t"
+                "overruns: %" PRIu64 "\t"
+                "jitter max: %" PRIu32 "us\t"
+                "avg: %.1fus\n",
+                name, p->_period_usec, st.count, st.overruns,
+                st.max_jitter_usec, (double)st.avg_jitter_usec);
+    }
+}
+
 void PollerThread::mainloop()
 {
     if (!_poller) {
@@ -140,6 +212,7 @@ void PollerThread::mainloop()
 
     while (!_should_exit) {
         _poller.poll();
+        _run_timers();
         _cleanup_timers();
     }
 
@@ -40,13 +40,32 @@ public:
 
     using PeriodicCb = AP_HAL::Device::PeriodicCb;
 
+    /*
+     * Timing statistics of a periodic callback. Jitter is the difference
+     * between the time the timer expired and the time the callback
+     * actually started running.
+     */
+    struct Stats {
+        uint64_t count;
+        uint64_t overruns;
+        uint32_t max_jitter_usec;
+        float avg_jitter_usec;
+    };
+
     virtual ~TimerPollable() { }
 
+    /*
+     * Acknowledge the timer expiration and mark the callback as pending:
+     * the actual call happens in run() so callbacks can be ordered by their
+     * deadline by the PollerThread
+     */
     void on_can_read() override;
 
     bool setup_timer(uint32_t timeout_usec);
     bool adjust_timer(uint32_t timeout_usec);
 
+    const Stats &get_stats() const { return _stats; }
+
 protected:
     TimerPollable(PeriodicCb cb, WrapperCb *wrapper)
         : _cb(cb)
@@ -54,9 +73,20 @@ protected:
     {
     }
 
+    void run();
+
     PeriodicCb _cb;
     WrapperCb *_wrapper;
     bool _removeme = false;
+    bool _pending = false;
+
+    uint32_t _period_usec = 0;
+
+    /* time of the expiration being serviced and of the next one */
+    uint64_t _expired_usec = 0;
+    uint64_t _deadline_usec = 0;
+
+    Stats _stats{};
 };
 
 
@@ -74,8 +104,15 @@ public:
 
     bool stop() override;
 
+    /*
+     * Print the timing statistics of each callback on this thread to
+     * stderr, prefixed by @name
+     */
+    void print_stats(const char *name) const;
+
 protected:
     void _cleanup_timers();
+    void _run_timers();
 
     Poller _poller{};
     std::vector<TimerPollable*> _timers{};
@@ -99,6 +99,11 @@ public:
      */
     void teardown();
 
+    /*
+     * Print jitter statistics of the periodic callbacks on each bus thread
+     */
+    void print_stats();
+
 protected:
     void _unregister(SPIBus &b);
     AP_HAL::OwnPtr<AP_HAL::SPIDevice> _create_device(SPIBus &b, SPIDesc &device_desc) const;
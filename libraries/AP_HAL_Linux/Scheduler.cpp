@@ -3,8 +3,10 @@
 #include <algorithm>
 #include <errno.h>
 #include <poll.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -12,8 +14,10 @@
 #include <AP_HAL/AP_HAL.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
+#include "I2CDevice.h"
 #include "RCInput.h"
 #include "RPIOUARTDriver.h"
+#include "SPIDevice.h"
 #include "SPIUARTDriver.h"
 #include "Storage.h"
 #include "UARTDriver.h"
@@ -87,11 +91,28 @@ void Scheduler::init()
     // we don't run Replay in real-time...
     mlockall(MCL_CURRENT|MCL_FUTURE);
 
-    struct sched_param param = { .sched_priority = APM_LINUX_MAIN_PRIORITY };
-    if (sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
+    int main_prio = APM_LINUX_MAIN_PRIORITY;
+    int main_cpu = -1;
+    int main_policy = SCHED_FIFO;
+    uint32_t main_rate = 0;
+
+    get_thread_params("ap-main", main_prio, main_cpu, main_policy, main_rate);
+
+    struct sched_param param = { .sched_priority = main_prio };
+    if (sched_setscheduler(0, main_policy, &param) == -1) {
         AP_HAL::panic("Scheduler: failed to set scheduling parameters: %s",
                       strerror(errno));
     }
+
+    if (main_cpu >= 0) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(main_cpu, &cpuset);
+        if (sched_setaffinity(0, sizeof(cpuset), &cpuset) == -1) {
+            AP_HAL::panic("Scheduler: failed to set CPU affinity of main thread: %s",
+                          strerror(errno));
+        }
+    }
 #endif
 
     /* set barrier to N + 1 threads: worker threads + main */
@@ -104,15 +125,174 @@ void Scheduler::init()
 
     for (size_t i = 0; i < ARRAY_SIZE(sched_table); i++) {
         const struct sched_table *t = &sched_table[i];
+        int prio = t->prio;
+        int cpu = -1;
+        int policy = t->policy;
+        uint32_t rate = t->rate;
 
-        t->thread->set_rate(t->rate);
+        get_thread_params(t->name, prio, cpu, policy, rate);
+
+        t->thread->set_rate(rate);
         t->thread->set_stack_size(256 * 1024);
-        t->thread->start(t->name, t->policy, t->prio);
+        t->thread->set_cpu_affinity(cpu);
+        t->thread->start(t->name, policy, prio);
     }
 
 #if defined(DEBUG_STACK) && DEBUG_STACK
     register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_stack, void));
 #endif
+#if defined(DEBUG_BUS_THREADS) && DEBUG_BUS_THREADS
+    register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_bus_threads, void));
+#endif
+#if defined(DEBUG_UARTS) && DEBUG_UARTS
+    register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_uarts, void));
+#endif
+}
+
+bool Scheduler::set_thread_params(const char *name, int prio, int cpu,
+                                  int policy, uint32_t rate)
+{
+    thread_params *p = nullptr;
+
+    for (uint8_t i = 0; i < _num_thread_params; i++) {
+        if (strcmp(_thread_params[i].name, name) == 0) {
+            p = &_thread_params[i];
+            break;
+        }
+    }
+
+    if (!p) {
+        if (_num_thread_params >= LINUX_SCHEDULER_MAX_THREAD_PARAMS) {
+            hal.console->printf("Out of thread params\n");
+            return false;
+        }
+        p = &_thread_params[_num_thread_params++];
+        strncpy(p->name, name, sizeof(p->name) - 1);
+        p->name[sizeof(p->name) - 1] = '\0';
+    }
+
+    p->prio = prio;
+    p->cpu = cpu;
+    p->policy = policy;
+    p->rate = rate;
+
+    return true;
+}
+
+bool Scheduler::parse_thread_params(const char *arg)
+{
+    char name[16];
+    char policy_name[8] = "fifo";
+    int prio, cpu = -1;
+    unsigned rate = 0;
+    int policy;
+
+    if (sscanf(arg, "%15[^:]:%d:%d:%u:%7s", name, &prio, &cpu, &rate,
+               policy_name) < 2) {
+        return false;
+    }
+
+    if (strcmp(policy_name, "fifo") == 0) {
+        policy = SCHED_FIFO;
+    } else if (strcmp(policy_name, "rr") == 0) {
+        policy = SCHED_RR;
+    } else if (strcmp(policy_name, "other") == 0) {
+        policy = SCHED_OTHER;
+    } else {
+        return false;
+    }
+
+    if (prio < sched_get_priority_min(policy) ||
+        prio > sched_get_priority_max(policy)) {
+        return false;
+    }
+
+    // -1 leaves the affinity alone, anything else must be a CPU we have
+    if (cpu < -1 || cpu >= CPU_SETSIZE || cpu >= sysconf(_SC_NPROCESSORS_CONF)) {
+        return false;
+    }
+
+    return set_thread_params(name, prio, cpu, policy, rate);
+}
+
+bool Scheduler::load_thread_config(const char *path)
+{
+    FILE *f = fopen(path, "re");
+    if (!f) {
+        fprintf(stderr, "Scheduler: failed to open %s: %s\n", path,
+                strerror(errno));
+        return false;
+    }
+
+    char line[64];
+    unsigned lineno = 0;
+    bool ret = true;
+
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        line[strcspn(line, "\r\n")] = '\0';
+
+        const char *p = line + strspn(line, " \t");
+        if (*p == '\0' || *p == '#') {
+            continue;
+        }
+
+        if (!parse_thread_params(p)) {
+            fprintf(stderr, "Scheduler: invalid thread parameters at %s:%u: %s\n",
+                    path, lineno, p);
+            ret = false;
+        }
+    }
+
+    fclose(f);
+    return ret;
+}
+
+bool Scheduler::get_thread_params(const char *name, int &prio, int &cpu) const
+{
+    int policy;
+    uint32_t rate;
+
+    return get_thread_params(name, prio, cpu, policy, rate);
+}
+
+bool Scheduler::get_thread_params(const char *name, int &prio, int &cpu,
+                                  int &policy, uint32_t &rate) const
+{
+    for (uint8_t i = 0; i < _num_thread_params; i++) {
+        if (strcmp(_thread_params[i].name, name) == 0) {
+            prio = _thread_params[i].prio;
+            cpu = _thread_params[i].cpu;
+            policy = _thread_params[i].policy;
+            if (_thread_params[i].rate) {
+                rate = _thread_params[i].rate;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool Scheduler::get_thread_stats(uint8_t i, const char *&name,
+                                 PeriodicThread::Stats &stats)
+{
+    PeriodicThread *threads[] = {
+        &_timer_thread,
+        &_uart_thread,
+        &_rcin_thread,
+        &_tonealarm_thread,
+        &_io_thread,
+    };
+
+    if (i >= ARRAY_SIZE(threads)) {
+        return false;
+    }
+
+    name = threads[i]->get_name();
+    threads[i]->take_stats(stats);
+
+    return true;
 }
 
 void Scheduler::_debug_stack()
@@ -135,6 +315,32 @@ void Scheduler::_debug_stack()
     }
 }
 
+void Scheduler::_debug_bus_threads()
+{
+    uint64_t now = AP_HAL::millis64();
+
+    if (now - _last_bus_debug_msec > 5000) {
+        SPIDeviceManager::from(hal.spi)->print_stats();
+        I2CDeviceManager::from(hal.i2c_mgr)->print_stats();
+        _last_bus_debug_msec = now;
+    }
+}
+
+void Scheduler::_debug_uarts()
+{
+    uint64_t now = AP_HAL::millis64();
+
+    if (now - _last_uart_debug_msec > 5000) {
+        UARTDriver::from(hal.uartA)->print_stats("uartA");
+        UARTDriver::from(hal.uartB)->print_stats("uartB");
+        UARTDriver::from(hal.uartC)->print_stats("uartC");
+        UARTDriver::from(hal.uartD)->print_stats("uartD");
+        UARTDriver::from(hal.uartE)->print_stats("uartE");
+        UARTDriver::from(hal.uartF)->print_stats("uartF");
+        _last_uart_debug_msec = now;
+    }
+}
+
 void Scheduler::microsleep(uint32_t usec)
 {
     struct timespec ts;
@@ -385,6 +591,31 @@ void Scheduler::_run_uarts()
     UARTDriver::from(hal.uartF)->_timer_tick();
 }
 
+/*
+  write the data queued by the UARTs which woke up the uart thread
+ */
+void Scheduler::_poll_uarts()
+{
+    UARTDriver::from(hal.uartA)->_poller_tick();
+    UARTDriver::from(hal.uartB)->_poller_tick();
+    UARTDriver::from(hal.uartC)->_poller_tick();
+    UARTDriver::from(hal.uartD)->_poller_tick();
+    UARTDriver::from(hal.uartE)->_poller_tick();
+    UARTDriver::from(hal.uartF)->_poller_tick();
+}
+
+Poller *Scheduler::get_uart_poller()
+{
+#if HAL_LINUX_UARTS_ON_TIMER_THREAD
+    return nullptr;
+#else
+    if (!_uart_thread.get_poller() || !_uart_thread.is_current_thread()) {
+        return nullptr;
+    }
+    return &_uart_thread.get_poller();
+#endif
+}
+
 void Scheduler::_rcin_task()
 {
 #if !HAL_LINUX_UARTS_ON_TIMER_THREAD
@@ -466,8 +697,74 @@ bool Scheduler::SchedulerThread::_run()
     return PeriodicThread::_run();
 }
 
+bool Scheduler::UARTThread::_run()
+{
+    if (HAL_LINUX_UARTS_ON_TIMER_THREAD || !_poller) {
+        return SchedulerThread::_run();
+    }
+
+    if (_period_usec == 0) {
+        return false;
+    }
+
+    _sched._wait_all_threads();
+
+    uint64_t next_run_usec = AP_HAL::micros64() + _period_usec;
+
+    while (!_should_exit) {
+        uint64_t now_usec = AP_HAL::micros64();
+        if (now_usec >= next_run_usec) {
+            _update_stats(now_usec - next_run_usec);
+            next_run_usec += _period_usec;
+            if (next_run_usec <= now_usec) {
+                // we've lost sync - restart
+                next_run_usec = now_usec + _period_usec;
+                _add_overrun();
+            }
+            _task();
+        }
+
+        _poller.poll((next_run_usec - now_usec + 999) / 1000);
+        _sched._poll_uarts();
+    }
+
+    _started = false;
+    _should_exit = false;
+
+    return true;
+}
+
+bool Scheduler::UARTThread::stop()
+{
+    if (!PeriodicThread::stop()) {
+        return false;
+    }
+
+    _poller.wakeup();
+
+    return true;
+}
+
+bool Scheduler::register_thread(Thread *thread)
+{
+    if (_num_external_threads >= LINUX_SCHEDULER_MAX_EXTERNAL_THREADS) {
+        return false;
+    }
+
+    _external_threads[_num_external_threads++] = thread;
+
+    return true;
+}
+
 void Scheduler::teardown()
 {
+    for (uint8_t i = 0; i < _num_external_threads; i++) {
+        _external_threads[i]->stop();
+    }
+    for (uint8_t i = 0; i < _num_external_threads; i++) {
+        _external_threads[i]->join();
+    }
+
     _timer_thread.stop();
     _io_thread.stop();
     _rcin_thread.stop();
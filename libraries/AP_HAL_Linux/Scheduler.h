@@ -1,14 +1,18 @@
 #pragma once
 
 #include <pthread.h>
+#include <sched.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "Semaphores.h"
 #include "Thread.h"
 
 #define LINUX_SCHEDULER_MAX_TIMER_PROCS 10
 #define LINUX_SCHEDULER_MAX_TIMESLICED_PROCS 10
 #define LINUX_SCHEDULER_MAX_IO_PROCS 10
+#define LINUX_SCHEDULER_MAX_THREAD_PARAMS 16
+#define LINUX_SCHEDULER_MAX_EXTERNAL_THREADS 4
 
 #define AP_LINUX_SENSORS_STACK_SIZE  256 * 1024
 #define AP_LINUX_SENSORS_SCHED_POLICY  SCHED_FIFO
@@ -52,6 +56,58 @@ public:
 
     void teardown();
 
+    /*
+     * Override the scheduling policy, priority, CPU affinity and rate of
+     * the HAL thread called @name, e.g. "ap-timer", "ap-spi-0" or
+     * "ap-main" for the main thread. Must be called before the thread is
+     * started. A negative @cpu doesn't pin the thread and a zero @rate
+     * keeps its default rate.
+     */
+    bool set_thread_params(const char *name, int prio, int cpu,
+                           int policy = SCHED_FIFO, uint32_t rate = 0);
+
+    /*
+     * Parse thread parameters in the form NAME:PRIO[:CPU[:RATE[:POLICY]]]
+     * as given in the command line and call set_thread_params(). POLICY
+     * is one of "fifo", "rr" or "other".
+     */
+    bool parse_thread_params(const char *arg);
+
+    /*
+     * Read thread parameters from @path, one NAME:PRIO[:CPU[:RATE[:POLICY]]]
+     * per line. Empty lines and lines starting with '#' are skipped.
+     */
+    bool load_thread_config(const char *path);
+
+    /*
+     * Get the parameters for thread @name. The arguments are left
+     * untouched if they weren't overridden.
+     */
+    bool get_thread_params(const char *name, int &prio, int &cpu) const;
+    bool get_thread_params(const char *name, int &prio, int &cpu,
+                           int &policy, uint32_t &rate) const;
+
+    /*
+     * Get the name and wakeup statistics of the periodic HAL thread number
+     * @i since the previous call, restarting them. Returns false past the
+     * last one.
+     */
+    bool get_thread_stats(uint8_t i, const char *&name,
+                          PeriodicThread::Stats &stats);
+
+    /*
+     * Stop and join @thread in teardown(), before the HAL threads. For
+     * threads started outside of the HAL, e.g. by the vehicle.
+     */
+    bool register_thread(Thread *thread);
+
+    /*
+     * Poller of the uart thread, to be used by UARTs to wait for their
+     * devices from that thread. nullptr when called from another thread or
+     * when UARTs are only serviced periodically.
+     */
+    Poller *get_uart_poller();
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -66,9 +122,32 @@ private:
         Scheduler &_sched;
     };
 
+    /*
+     * Thread servicing the UARTs: it sleeps on a poller waking it up when
+     * their devices are readable or writable, and runs its task at its
+     * rate for the UARTs without a file descriptor.
+     */
+    class UARTThread : public SchedulerThread {
+    public:
+        UARTThread(Thread::task_t t, Scheduler &sched)
+            : SchedulerThread(t, sched)
+        { }
+
+        Poller &get_poller() { return _poller; }
+
+        bool stop() override;
+
+    protected:
+        bool _run() override;
+
+        Poller _poller{};
+    };
+
     void _wait_all_threads();
 
     void     _debug_stack();
+    void     _debug_bus_threads();
+    void     _debug_uarts();
 
     AP_HAL::Proc _delay_cb;
     uint16_t _min_delay_cb_ms;
@@ -98,7 +177,7 @@ private:
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
-    SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
+    UARTThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
     SchedulerThread _tonealarm_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_tonealarm_task, void), *this};
 
     void _timer_task();
@@ -109,10 +188,26 @@ private:
 
     void _run_io();
     void _run_uarts();
+    void _poll_uarts();
     bool _register_timesliced_proc(AP_HAL::MemberProc, uint8_t);
 
+    struct thread_params {
+        char name[16];
+        int prio;
+        int cpu;
+        int policy;
+        uint32_t rate;
+    };
+    thread_params _thread_params[LINUX_SCHEDULER_MAX_THREAD_PARAMS];
+    uint8_t _num_thread_params;
+
+    Thread *_external_threads[LINUX_SCHEDULER_MAX_EXTERNAL_THREADS];
+    uint8_t _num_external_threads;
+
     uint64_t _stopped_clock_usec;
     uint64_t _last_stack_debug_msec;
+    uint64_t _last_bus_debug_msec;
+    uint64_t _last_uart_debug_msec;
 
     Semaphore _timer_semaphore;
     Semaphore _io_semaphore;
@@ -6,6 +6,18 @@ extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
 
+Semaphore::Semaphore(bool prio_inherit)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    if (prio_inherit) {
+        pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    }
+    pthread_mutex_init(&_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
 bool Semaphore::give()
 {
     return pthread_mutex_unlock(&_lock) == 0;
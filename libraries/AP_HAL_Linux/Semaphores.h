@@ -10,9 +10,11 @@ namespace Linux {
 
 class Semaphore : public AP_HAL::Semaphore {
 public:
-    Semaphore() {
-        pthread_mutex_init(&_lock, nullptr);
-    }
+    /*
+     * @prio_inherit makes a thread holding the semaphore run at the
+     * priority of the highest priority thread waiting for it
+     */
+    Semaphore(bool prio_inherit = false);
     bool give();
     bool take(uint32_t timeout_ms);
     bool take_nonblocking();
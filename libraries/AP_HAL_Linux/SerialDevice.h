@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 
 #include "AP_HAL_Linux.h"
 
@@ -13,6 +14,38 @@ public:
     virtual bool close() = 0;
     virtual ssize_t write(const uint8_t *buf, uint16_t n) = 0;
     virtual ssize_t read(uint8_t *buf, uint16_t n) = 0;
+
+    /*
+     * Scatter/gather versions of read() and write(), so both halves of a
+     * ring buffer are transferred with a single system call. The default
+     * falls back to one read() or write() per element.
+     */
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt)
+    {
+        return _transfer(iov, iovcnt, false);
+    }
+    virtual ssize_t writev(const struct iovec *iov, int iovcnt)
+    {
+        return _transfer(iov, iovcnt, true);
+    }
+
+    /*
+     * File descriptor to wait on for the device to become readable or
+     * writable, or -1 if it can't be waited on. It may change when the
+     * device is opened or closed, or when a client connects.
+     */
+    virtual int get_fd() const { return -1; }
+
+    /*
+     * Room the read buffer needs for a read() to make progress, e.g. for
+     * a whole packet. The device isn't waited on for reading while there
+     * is less room than that.
+     */
+    virtual uint16_t get_min_read_space() const { return 1; }
+
+    /* print statistics of the device to stderr, prefixed by @name */
+    virtual void print_stats(const char *name) const { }
+
     virtual void set_blocking(bool blocking) = 0;
     virtual void set_speed(uint32_t speed) = 0;
     virtual AP_HAL::UARTDriver::flow_control get_flow_control(void) { return AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE; }
@@ -20,4 +53,26 @@ public:
     {
         /* most devices simply igmore this setting */
     };
+
+private:
+    ssize_t _transfer(const struct iovec *iov, int iovcnt, bool out)
+    {
+        ssize_t total = 0;
+
+        for (int i = 0; i < iovcnt; i++) {
+            uint8_t *buf = (uint8_t *)iov[i].iov_base;
+            ssize_t ret = out ? write(buf, iov[i].iov_len) : read(buf, iov[i].iov_len);
+            if (ret < 0) {
+                return total > 0 ? total : ret;
+            }
+            total += ret;
+
+            /* stop at a short transfer */
+            if ((size_t)ret < iov[i].iov_len) {
+                break;
+            }
+        }
+
+        return total;
+    }
 };
@@ -3,19 +3,30 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/edc.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 using namespace Linux;
 
 /*
-  This stores 'eeprom' data on the SD card, with a 4k size, and a
+  This stores 'eeprom' data on the SD card, with a 16k size, and a
   in-memory buffer. This keeps the latency down.
+
+  Changes are not written in place: the dirty lines are appended to a
+  journal as one checksummed record, committed with a single fsync, so
+  that a burst of saves costs one write and a power cut leaves either
+  the old or the new lines. At boot the valid records are replayed over
+  the storage file, stopping at the first torn one. Once the journal
+  grows past LINUX_STORAGE_JOURNAL_MAX it is folded back into the
+  storage file, which is rewritten a chunk per tick into a new file and
+  renamed over the old one, so the SD card sees mostly appends.
  */
 
 // name the storage file after the sketch so you can use the same board
@@ -28,21 +39,39 @@ using namespace Linux;
 #define STORAGE_DIR "/var/APM"
 #endif
 #define STORAGE_FILE STORAGE_DIR "/" SKETCHNAME ".stg"
+#define STORAGE_JOURNAL_FILE STORAGE_DIR "/" SKETCHNAME ".jnl"
+#define STORAGE_COMPACT_FILE STORAGE_DIR "/" SKETCHNAME ".stg.new"
+
+#define STORAGE_JOURNAL_MAGIC 0x4C4E4A41 // "AJNL"
 
 extern const AP_HAL::HAL& hal;
 
+Storage::Storage()
+    : _journal_fd(-1)
+    , _compact_fd(-1)
+    , _initialised(false)
+    , _dirty_mask(0)
+    , _dir_name(STORAGE_DIR)
+    , _file_name(STORAGE_FILE)
+    , _journal_name(STORAGE_JOURNAL_FILE)
+    , _compact_name(STORAGE_COMPACT_FILE)
+{
+}
+
 void Storage::_storage_create(void)
 {
-    mkdir(STORAGE_DIR, 0777);
-    unlink(STORAGE_FILE);
-    int fd = open(STORAGE_FILE, O_RDWR|O_CREAT|O_CLOEXEC, 0666);
+    mkdir(_dir_name, 0777);
+    unlink(_file_name);
+    // the journal only makes sense on top of the file it was written for
+    unlink(_journal_name);
+    int fd = open(_file_name, O_RDWR|O_CREAT|O_CLOEXEC, 0666);
     if (fd == -1) {
-        AP_HAL::panic("Failed to create " STORAGE_FILE);
+        AP_HAL::panic("Failed to create %s", _file_name);
     }
     for (uint16_t loc=0; loc<sizeof(_buffer); loc += LINUX_STORAGE_MAX_WRITE) {
         if (write(fd, &_buffer[loc], LINUX_STORAGE_MAX_WRITE) != LINUX_STORAGE_MAX_WRITE) {
             perror("write");
-            AP_HAL::panic("Error filling " STORAGE_FILE);
+            AP_HAL::panic("Error filling %s", _file_name);
         }
     }
     // ensure the directory is updated with the new size
@@ -57,12 +86,12 @@ void Storage::_storage_open(void)
     }
 
     _dirty_mask = 0;
-    int fd = open(STORAGE_FILE, O_RDWR|O_CLOEXEC);
+    int fd = open(_file_name, O_RDWR|O_CLOEXEC);
     if (fd == -1) {
         _storage_create();
-        fd = open(STORAGE_FILE, O_RDWR|O_CLOEXEC);
+        fd = open(_file_name, O_RDWR|O_CLOEXEC);
         if (fd == -1) {
-            AP_HAL::panic("Failed to open " STORAGE_FILE);
+            AP_HAL::panic("Failed to open %s", _file_name);
         }
     }
     memset(_buffer, 0, sizeof(_buffer));
@@ -73,25 +102,91 @@ void Storage::_storage_open(void)
     ssize_t ret = read(fd, _buffer, sizeof(_buffer));
     if (ret == 4096 && ret != sizeof(_buffer)) {
         if (ftruncate(fd, sizeof(_buffer)) != 0) {
-            AP_HAL::panic("Failed to expand " STORAGE_FILE);
+            AP_HAL::panic("Failed to expand %s", _file_name);
         }
         ret = sizeof(_buffer);
     }
     if (ret != sizeof(_buffer)) {
         close(fd);
         _storage_create();
-        fd = open(STORAGE_FILE, O_RDONLY|O_CLOEXEC);
+        fd = open(_file_name, O_RDONLY|O_CLOEXEC);
         if (fd == -1) {
-            AP_HAL::panic("Failed to open " STORAGE_FILE);
+            AP_HAL::panic("Failed to open %s", _file_name);
         }
         if (read(fd, _buffer, sizeof(_buffer)) != sizeof(_buffer)) {
-            AP_HAL::panic("Failed to read " STORAGE_FILE);
+            AP_HAL::panic("Failed to read %s", _file_name);
         }
     }
     close(fd);
+    _journal_replay();
     _initialised = true;
 }
 
+// crc of a journal record, over the fields after the magic and the lines
+uint16_t Storage::_journal_crc(const uint8_t *record, uint32_t len)
+{
+    const uint32_t start = offsetof(journal_record, seq);
+    const uint32_t crc_ofs = offsetof(journal_record, crc);
+    uint16_t crc = crc16_ccitt(&record[start], crc_ofs - start, 0);
+    return crc16_ccitt(&record[sizeof(journal_record)],
+                       len - sizeof(journal_record), crc);
+}
+
+static uint8_t count_lines(uint32_t mask)
+{
+    return __builtin_popcount(mask);
+}
+
+/*
+  apply the journal to the storage read from the storage file. Records
+  are applied in order until one is incomplete or fails its checks,
+  which is where a write was interrupted, and the journal is cut there
+  so that new records follow the last good one
+ */
+void Storage::_journal_replay(void)
+{
+    _journal_fd = open(_journal_name, O_RDWR|O_CREAT|O_CLOEXEC, 0666);
+    if (_journal_fd == -1) {
+        AP_HAL::panic("Failed to open %s", _journal_name);
+    }
+
+    _journal_ofs = 0;
+    _journal_seq = 0;
+
+    journal_record rec;
+    while (pread(_journal_fd, &rec, sizeof(rec), _journal_ofs) == sizeof(rec)) {
+        if (rec.magic != STORAGE_JOURNAL_MAGIC || rec.seq != _journal_seq ||
+            rec.line_mask == 0) {
+            break;
+        }
+        const uint32_t len = count_lines(rec.line_mask) * LINUX_STORAGE_LINE_SIZE;
+        if (pread(_journal_fd, &_staging[sizeof(rec)], len, _journal_ofs + sizeof(rec)) != (ssize_t)len) {
+            break;
+        }
+        memcpy(_staging, &rec, sizeof(rec));
+        if (_journal_crc(_staging, sizeof(rec) + len) != rec.crc) {
+            break;
+        }
+
+        const uint8_t *line_data = &_staging[sizeof(rec)];
+        for (uint8_t line = 0; line < LINUX_STORAGE_NUM_LINES; line++) {
+            if (rec.line_mask & (1U << line)) {
+                memcpy(&_buffer[line << LINUX_STORAGE_LINE_SHIFT], line_data, LINUX_STORAGE_LINE_SIZE);
+                line_data += LINUX_STORAGE_LINE_SIZE;
+            }
+        }
+        _journal_ofs += sizeof(rec) + len;
+        _journal_seq++;
+    }
+
+    struct stat st;
+    if (fstat(_journal_fd, &st) == 0 && st.st_size != (off_t)_journal_ofs) {
+        if (ftruncate(_journal_fd, _journal_ofs) != 0) {
+            AP_HAL::panic("Failed to truncate %s", _journal_name);
+        }
+    }
+}
+
 /*
   mark some lines as dirty. Note that there is no attempt to avoid
   the race condition between this code and the _timer_tick() code
@@ -130,61 +225,139 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
     }
 }
 
-void Storage::_timer_tick(void)
+/*
+  append all the dirty lines to the journal as one record. This also
+  updates _dirty_mask. Note that because this is a SCHED_FIFO thread it
+  will not be preempted by the main task except during blocking
+  calls. This means we don't need a semaphore around the _dirty_mask
+  updates. The lines are copied before the checksum is taken so that a
+  write_block() racing with the commit can't invalidate the record; it
+  marks its lines dirty again for the next one
+ */
+void Storage::_journal_commit(void)
 {
-    if (!_initialised || _dirty_mask == 0) {
-        return;
-    }
-
-    if (_fd == -1) {
-        _fd = open(STORAGE_FILE, O_WRONLY|O_CLOEXEC);
-        if (_fd == -1) {
+    if (_journal_fd == -1) {
+        _journal_fd = open(_journal_name, O_WRONLY|O_CLOEXEC);
+        if (_journal_fd == -1) {
             return;
         }
     }
 
-    // write out the first dirty set of lines. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint8_t i, n;
-    for (i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask & (1<<i)) {
-            break;
+    const uint32_t write_mask = _dirty_mask;
+    _dirty_mask &= ~write_mask;
+
+    uint8_t *line_data = &_staging[sizeof(journal_record)];
+    for (uint8_t line = 0; line < LINUX_STORAGE_NUM_LINES; line++) {
+        if (write_mask & (1U << line)) {
+            memcpy(line_data, &_buffer[line << LINUX_STORAGE_LINE_SHIFT], LINUX_STORAGE_LINE_SIZE);
+            line_data += LINUX_STORAGE_LINE_SIZE;
         }
     }
-    if (i == LINUX_STORAGE_NUM_LINES) {
-        // this shouldn't be possible
+    const uint32_t len = line_data - _staging;
+
+    journal_record rec;
+    rec.magic = STORAGE_JOURNAL_MAGIC;
+    rec.seq = _journal_seq;
+    rec.line_mask = write_mask;
+    rec.crc = 0;
+    memcpy(_staging, &rec, sizeof(rec));
+    rec.crc = _journal_crc(_staging, len);
+    memcpy(_staging, &rec, sizeof(rec));
+
+    if (pwrite(_journal_fd, _staging, len, _journal_ofs) != (ssize_t)len ||
+        fdatasync(_journal_fd) != 0) {
+        // write error - likely EINTR. The record is written again at
+        // the same place, a torn one is never followed by a valid one
+        _dirty_mask |= write_mask;
+        close(_journal_fd);
+        _journal_fd = -1;
         return;
     }
-    uint32_t write_mask = (1U<<i);
-    // see how many lines to write
-    for (n=1; (i+n) < LINUX_STORAGE_NUM_LINES &&
-             n < (LINUX_STORAGE_MAX_WRITE>>LINUX_STORAGE_LINE_SHIFT); n++) {
-        if (!(_dirty_mask & (1<<(n+i)))) {
-            break;
-        }
-        // mark that line clean
-        write_mask |= (1<<(n+i));
+
+    _journal_ofs += len;
+    _journal_seq++;
+
+    // compact now while the journal and the buffer agree, as a steady
+    // stream of saves may not leave a tick without dirty lines
+    if (_journal_ofs >= LINUX_STORAGE_JOURNAL_MAX && _dirty_mask == 0) {
+        _compact_start();
     }
+}
 
-    /*
-      write the lines. This also updates _dirty_mask. Note that
-      because this is a SCHED_FIFO thread it will not be preempted
-      by the main task except during blocking calls. This means we
-      don't need a semaphore around the _dirty_mask updates.
-     */
-    if (lseek(_fd, i<<LINUX_STORAGE_LINE_SHIFT, SEEK_SET) == (i<<LINUX_STORAGE_LINE_SHIFT)) {
-        _dirty_mask &= ~write_mask;
-        if (write(_fd, &_buffer[i<<LINUX_STORAGE_LINE_SHIFT], n<<LINUX_STORAGE_LINE_SHIFT) != n<<LINUX_STORAGE_LINE_SHIFT) {
-            // write error - likely EINTR
-            _dirty_mask |= write_mask;
-            close(_fd);
-            _fd = -1;
+/*
+  start folding the journal into the storage file. This is only done
+  when there are no dirty lines, so the image taken is exactly the
+  storage file with the journal applied, and replaying the journal over
+  the new file is harmless if we crash before truncating it
+ */
+void Storage::_compact_start(void)
+{
+    memcpy(_staging, _buffer, sizeof(_buffer));
+    _compact_ofs = 0;
+    _compact_fd = open(_compact_name, O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC, 0666);
+}
+
+/*
+  write the next chunk of the new storage file, and once it is all
+  written replace the storage file with it and empty the journal
+ */
+void Storage::_compact_step(void)
+{
+    if (_compact_ofs < sizeof(_buffer)) {
+        if (pwrite(_compact_fd, &_staging[_compact_ofs], LINUX_STORAGE_COMPACT_WRITE, _compact_ofs) != LINUX_STORAGE_COMPACT_WRITE) {
+            goto failed;
         }
-        if (_dirty_mask == 0) {
-            if (fsync(_fd) != 0) {
-                close(_fd);
-                _fd = -1;
-            }
+        _compact_ofs += LINUX_STORAGE_COMPACT_WRITE;
+        return;
+    }
+
+    if (fsync(_compact_fd) != 0) {
+        goto failed;
+    }
+    close(_compact_fd);
+    _compact_fd = -1;
+    if (rename(_compact_name, _file_name) != 0) {
+        unlink(_compact_name);
+        return;
+    }
+
+    {
+        // make the rename durable before dropping the journal
+        int dir_fd = open(_dir_name, O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+        if (dir_fd != -1) {
+            fsync(dir_fd);
+            close(dir_fd);
         }
     }
+
+    if (_journal_fd == -1) {
+        _journal_fd = open(_journal_name, O_WRONLY|O_CLOEXEC);
+    }
+    if (_journal_fd != -1 && ftruncate(_journal_fd, 0) == 0 && fsync(_journal_fd) == 0) {
+        _journal_ofs = 0;
+        _journal_seq = 0;
+    }
+    return;
+
+failed:
+    close(_compact_fd);
+    _compact_fd = -1;
+    unlink(_compact_name);
+}
+
+void Storage::_timer_tick(void)
+{
+    if (!_initialised) {
+        return;
+    }
+
+    // new records wait for the compaction, which takes a few ticks
+    if (_compact_fd != -1) {
+        _compact_step();
+        return;
+    }
+
+    if (_dirty_mask != 0) {
+        _journal_commit();
+    }
 }
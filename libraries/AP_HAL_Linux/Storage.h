@@ -8,12 +8,17 @@
 #define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
 #define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
 
+// size of the journal above which it is folded into the storage file
+#define LINUX_STORAGE_JOURNAL_MAX (128*1024)
+// bytes of the storage file rewritten per tick while compacting
+#define LINUX_STORAGE_COMPACT_WRITE 4096
+
 namespace Linux {
 
 class Storage : public AP_HAL::Storage
 {
 public:
-    Storage() : _fd(-1),_dirty_mask(0) { }
+    Storage();
 
     static Storage *from(AP_HAL::Storage *storage) {
         return static_cast<Storage*>(storage);
@@ -35,10 +40,41 @@ protected:
     void _mark_dirty(uint16_t loc, uint16_t length);
     virtual void _storage_create(void);
     virtual void _storage_open(void);
-    int _fd;
+    void _journal_replay(void);
+    void _journal_commit(void);
+    void _compact_start(void);
+    void _compact_step(void);
+
+    /*
+      header of a journal record, followed by the lines set in
+      line_mask in increasing order
+     */
+    struct PACKED journal_record {
+        uint32_t magic;
+        uint32_t seq;
+        uint32_t line_mask;
+        uint16_t crc;   // crc16_ccitt of seq, line_mask and the lines
+    };
+
+    // record is len bytes, with its header
+    static uint16_t _journal_crc(const uint8_t *record, uint32_t len);
+
+    int _journal_fd;
+    uint32_t _journal_ofs;
+    uint32_t _journal_seq;
+    int _compact_fd;
+    uint16_t _compact_ofs;
     volatile bool _initialised;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+    // a record being committed, or the image being compacted
+    uint8_t _staging[sizeof(journal_record) + LINUX_STORAGE_SIZE];
     volatile uint32_t _dirty_mask;
+
+    // the storage directory and files, elsewhere for the tests
+    const char *_dir_name;
+    const char *_file_name;
+    const char *_journal_name;
+    const char *_compact_name;
 };
 
 }
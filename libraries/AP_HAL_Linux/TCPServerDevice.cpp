@@ -3,6 +3,7 @@
 #include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
@@ -32,11 +33,19 @@ ssize_t TCPServerDevice::write(const uint8_t *buf, uint16_t n)
     return sock->send(buf, n);
 }
 
+ssize_t TCPServerDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    if (sock == nullptr) {
+        return -1;
+    }
+    return ::writev(sock->get_fd(), iov, iovcnt);
+}
+
 /*
-  when we try to read we accept new connections if one isn't already
-  established
+  accept a new connection if one isn't already established, returning
+  true if there is one
  */
-ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
+bool TCPServerDevice::_accept()
 {
     if (sock == nullptr) {
         sock = listener.accept(0);
@@ -44,7 +53,16 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
             sock->set_blocking(_blocking);
         }
     }
-    if (sock == nullptr) {
+    return sock != nullptr;
+}
+
+/*
+  when we try to read we accept new connections if one isn't already
+  established
+ */
+ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
+{
+    if (!_accept()) {
         return -1;
     }
     ssize_t ret = sock->recv(buf, n, 1);
@@ -57,6 +75,21 @@ ssize_t TCPServerDevice::read(uint8_t *buf, uint16_t n)
     return ret;
 }
 
+ssize_t TCPServerDevice::readv(const struct iovec *iov, int iovcnt)
+{
+    if (!_accept()) {
+        return -1;
+    }
+    ssize_t ret = ::readv(sock->get_fd(), iov, iovcnt);
+    if (ret == 0) {
+        // EOF, go back to waiting for a new connection
+        delete sock;
+        sock = nullptr;
+        return -1;
+    }
+    return ret;
+}
+
 bool TCPServerDevice::open()
 {
     listener.reuseaddress();
@@ -17,8 +17,11 @@
 #include "Thread.h"
 
 #include <alloca.h>
+#include <errno.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #include <utility>
 
@@ -184,6 +187,17 @@ bool Thread::start(const char *name, int policy, int prio)
         }
     }
 
+    if (_cpu >= 0) {
+        cpu_set_t cpuset;
+
+        CPU_ZERO(&cpuset);
+        CPU_SET(_cpu, &cpuset);
+        if ((r = pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset)) != 0) {
+            AP_HAL::panic("Failed to set affinity for thread '%s': %s",
+                          name, strerror(r));
+        }
+    }
+
     r = pthread_create(&_ctx, &attr, &Thread::_run_trampoline, this);
     if (r != 0) {
         AP_HAL::panic("Failed to create thread '%s': %s",
@@ -193,6 +207,7 @@ bool Thread::start(const char *name, int policy, int prio)
 
     if (name) {
         pthread_setname_np(_ctx, name);
+        strncpy(_name, name, sizeof(_name) - 1);
     }
 
     _started = true;
@@ -244,6 +259,17 @@ bool Thread::set_stack_size(size_t stack_size)
     return true;
 }
 
+bool Thread::set_cpu_affinity(int cpu)
+{
+    if (_started || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+
+    _cpu = cpu < 0 ? -1 : cpu;
+
+    return true;
+}
+
 bool PeriodicThread::_run()
 {
     if (_period_usec == 0) {
@@ -257,8 +283,10 @@ bool PeriodicThread::_run()
         if (dt > _period_usec) {
             // we've lost sync - restart
             next_run_usec = AP_HAL::micros64();
+            _add_overrun();
         } else {
             Scheduler::from(hal.scheduler)->microsleep(dt);
+            _update_stats(AP_HAL::micros64() - next_run_usec);
         }
         next_run_usec += _period_usec;
 
@@ -271,6 +299,35 @@ bool PeriodicThread::_run()
     return true;
 }
 
+void PeriodicThread::_update_stats(uint64_t latency_usec)
+{
+    // sleeping never ends early, this is only guarding against a bad clock
+    if (latency_usec > UINT32_MAX) {
+        latency_usec = 0;
+    }
+
+    _stats_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    _stats.count++;
+    _stats.max_latency_usec = MAX(_stats.max_latency_usec, (uint32_t)latency_usec);
+    _stats.avg_latency_usec += (latency_usec - _stats.avg_latency_usec) / _stats.count;
+    _stats_sem.give();
+}
+
+void PeriodicThread::_add_overrun()
+{
+    _stats_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    _stats.overruns++;
+    _stats_sem.give();
+}
+
+void PeriodicThread::take_stats(Stats &stats)
+{
+    _stats_sem.take(HAL_SEMAPHORE_BLOCK_FOREVER);
+    stats = _stats;
+    _stats = {};
+    _stats_sem.give();
+}
+
 bool PeriodicThread::stop()
 {
     if (!is_started()) {
@@ -282,4 +339,61 @@ bool PeriodicThread::stop()
     return true;
 }
 
+WorkerThread::WorkerThread(Thread::task_t t)
+    : Thread(t)
+{
+    sem_init(&_run_sem, 0, 0);
+    sem_init(&_done_sem, 0, 0);
+}
+
+WorkerThread::~WorkerThread()
+{
+    sem_destroy(&_run_sem);
+    sem_destroy(&_done_sem);
+}
+
+void WorkerThread::run()
+{
+    sem_post(&_run_sem);
+}
+
+void WorkerThread::wait()
+{
+    while (sem_wait(&_done_sem) != 0 && errno == EINTR) {
+    }
+}
+
+bool WorkerThread::_run()
+{
+    while (true) {
+        if (sem_wait(&_run_sem) != 0) {
+            continue;
+        }
+        if (_should_exit) {
+            break;
+        }
+
+        _task();
+
+        sem_post(&_done_sem);
+    }
+
+    _started = false;
+    _should_exit = false;
+
+    return true;
+}
+
+bool WorkerThread::stop()
+{
+    if (!is_started()) {
+        return false;
+    }
+
+    _should_exit = true;
+    sem_post(&_run_sem);
+
+    return true;
+}
+
 }
@@ -18,10 +18,13 @@
 
 #include <pthread.h>
 #include <inttypes.h>
+#include <semaphore.h>
 #include <stdlib.h>
 
 #include <AP_HAL/utility/functor.h>
 
+#include "Semaphores.h"
+
 namespace Linux {
 
 /*
@@ -41,10 +44,21 @@ public:
 
     bool is_started() const { return _started; }
 
+    /* name given to start(), empty before */
+    const char *get_name() const { return _name; }
+
     size_t get_stack_usage();
 
     bool set_stack_size(size_t stack_size);
 
+    /*
+     * Pin the thread to CPU @cpu when it's started. A negative value
+     * means the thread can run on any CPU (the default).
+     */
+    bool set_cpu_affinity(int cpu);
+
+    int get_cpu_affinity() const { return _cpu; }
+
     virtual bool stop() { return false; }
 
     bool join();
@@ -62,6 +76,7 @@ protected:
     void _poison_stack();
 
     task_t _task;
+    char _name[16] {};
     bool _started = false;
     bool _should_exit = false;
     pthread_t _ctx = 0;
@@ -72,6 +87,7 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+    int _cpu = -1;
 };
 
 class PeriodicThread : public Thread {
@@ -84,10 +100,59 @@ public:
 
     bool stop() override;
 
+    /*
+     * Wakeup latency of the thread: the time from the start of a period to
+     * the task actually starting to run. Overruns are periods missed
+     * because the task ran late.
+     */
+    struct Stats {
+        uint32_t count;
+        uint32_t overruns;
+        uint32_t max_latency_usec;
+        float avg_latency_usec;
+    };
+
+    /*
+     * Copy the statistics to @stats and restart them from 0, so each call
+     * gets the figures of the wakeups since the previous one. Safe to call
+     * from another thread.
+     */
+    void take_stats(Stats &stats);
+
 protected:
     bool _run() override;
 
+    void _update_stats(uint64_t latency_usec);
+    void _add_overrun();
+
     uint64_t _period_usec = 0;
+
+    Stats _stats{};
+    Semaphore _stats_sem{true};
+};
+
+/*
+ * Thread running its task once each time it's woken up by run(). The
+ * caller hands work over with run() and later blocks in wait() until the
+ * task has returned, e.g. to split a computation across CPUs.
+ */
+class WorkerThread : public Thread {
+public:
+    WorkerThread(Thread::task_t t);
+
+    ~WorkerThread();
+
+    void run();
+
+    void wait();
+
+    bool stop() override;
+
+protected:
+    bool _run() override;
+
+    sem_t _run_sem;
+    sem_t _done_sem;
 };
 
 }
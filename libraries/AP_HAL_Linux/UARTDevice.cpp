@@ -4,6 +4,7 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <stdio.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -67,6 +68,20 @@ ssize_t UARTDevice::write(const uint8_t *buf, uint16_t n)
     return ret;
 }
 
+ssize_t UARTDevice::readv(const struct iovec *iov, int iovcnt)
+{
+    return ::readv(_fd, iov, iovcnt);
+}
+
+/*
+  unlike write() this doesn't poll first: it's called when the poller
+  reported the port as writable, and fails with EAGAIN otherwise
+ */
+ssize_t UARTDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    return ::writev(_fd, iov, iovcnt);
+}
+
 void UARTDevice::set_blocking(bool blocking)
 {
     int flags = fcntl(_fd, F_GETFL, 0);
@@ -4,22 +4,28 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
 
 #include "ConsoleDevice.h"
+#include "MAVLinkServerDevice.h"
+#include "Scheduler.h"
 #include "TCPServerDevice.h"
 #include "UARTDevice.h"
 #include "UARTQFlight.h"
@@ -31,6 +37,9 @@ extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
 
+/* maximum number of datagrams read from a packet device in one wakeup */
+#define UART_MAX_DATAGRAMS 8
+
 UARTDriver::UARTDriver(bool default_console) :
     device_path(nullptr),
     _packetise(false),
@@ -120,6 +129,7 @@ void UARTDriver::_deallocate_buffers()
         - /dev/ttyO1
         - tcp:*:1243:wait
         - udp:192.168.2.15:1243
+        - server:0.0.0.0:14550:20000
 */
 AP_HAL::OwnPtr<SerialDevice> UARTDriver::_parseDevicePath(const char *arg)
 {
@@ -133,7 +143,8 @@ AP_HAL::OwnPtr<SerialDevice> UARTDriver::_parseDevicePath(const char *arg)
 #endif
     } else if (strncmp(arg, "tcp:", 4) != 0 &&
                strncmp(arg, "udp:", 4) != 0 &&
-               strncmp(arg, "udpin:", 6)) {
+               strncmp(arg, "udpin:", 6) != 0 &&
+               strncmp(arg, "server:", 7) != 0) {
         return nullptr;
     }
 
@@ -169,7 +180,7 @@ AP_HAL::OwnPtr<SerialDevice> UARTDriver::_parseDevicePath(const char *arg)
     _base_port = (uint16_t) atoi(port);
     _ip = strdup(ip);
 
-    /* Optional flag for TCP */
+    /* Optional flag for TCP, UDP broadcast or the server rate limit */
     if (flag != nullptr) {
         _flag = strdup(flag);
     }
@@ -188,6 +199,10 @@ AP_HAL::OwnPtr<SerialDevice> UARTDriver::_parseDevicePath(const char *arg)
             device = new UDPDevice(_ip, _base_port, false, true);
 
         }
+    } else if (strcmp(protocol, "server") == 0) {
+        // the flag is the rate limit of each client, in bytes per second
+        _packetise = true;
+        device = new MAVLinkServerDevice(_ip, _base_port, _flag ? atoi(_flag) : 0);
     } else {
         bool wait = (_flag && strcmp(_flag, "wait") == 0);
         device = new TCPServerDevice(_ip, _base_port, wait);
@@ -209,6 +224,7 @@ void UARTDriver::end()
         hal.scheduler->delay(1);
     }
 
+    _unregister_pollable();
     _device->close();
     _deallocate_buffers();
 }
@@ -282,6 +298,14 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+ssize_t UARTDriver::read(uint8_t *buffer, uint16_t count)
+{
+    if (!_initialised) {
+        return 0;
+    }
+    return _readbuf.read(buffer, count);
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -295,7 +319,12 @@ size_t UARTDriver::write(uint8_t c)
         }
         hal.scheduler->delay(1);
     }
-    return _writebuf.write(&c, 1);
+    if (_writebuf.available() == 0) {
+        _tx_queued_usec = AP_HAL::micros();
+    }
+    size_t ret = _writebuf.write(&c, 1);
+    _kick_poller();
+    return ret;
 }
 
 /*
@@ -318,7 +347,12 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
         return ret;
     }
 
-    return _writebuf.write(buffer, size);
+    if (_writebuf.available() == 0) {
+        _tx_queued_usec = AP_HAL::micros();
+    }
+    size_t ret = _writebuf.write(buffer, size);
+    _kick_poller();
+    return ret;
 }
 
 /*
@@ -340,6 +374,23 @@ int UARTDriver::_write_fd(const uint8_t *buf, uint16_t n)
     return _device->write(buf, n);
 }
 
+/*
+  try writing the n_vec parts of vec with a single call
+ */
+int UARTDriver::_writev_fd(const ByteBuffer::IoVec *vec, int n_vec)
+{
+    if (!_connected) {
+        return 0;
+    }
+
+    struct iovec iov[2];
+    for (int i = 0; i < n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+    return _device->writev(iov, n_vec);
+}
+
 /*
   try reading n bytes, handling an unresponsive port
  */
@@ -415,22 +466,46 @@ bool UARTDriver::_write_pending_bytes(void)
     if (n > 0) {
         int ret;
 
-        if (_packetise) {
+        if (_pollable.get_fd() >= 0) {
+            // both parts of the buffer, or the whole packet, in one call
+            ByteBuffer::IoVec vec[2];
+            const auto n_vec = _writebuf.peekiovec(vec, n);
+            errno = 0;
+            ret = _writev_fd(vec, n_vec);
+            _stats.tx_calls++;
+            if (ret > 0) {
+                _writebuf.advance(ret);
+                _stats.tx_bytes += ret;
+            }
+            // wait for the device to be writable before trying again if
+            // it's full. Other failures are retried by _timer_tick(): a
+            // UDP socket without a peer or without a route stays writable
+            if (ret < 0) {
+                _tx_blocked = errno == EAGAIN || errno == EWOULDBLOCK;
+            } else {
+                _tx_blocked = ret < n;
+            }
+        } else if (_packetise) {
             // keep as a single UDP packet
             uint8_t tmpbuf[n];
             _writebuf.peekbytes(tmpbuf, n);
             ret = _write_fd(tmpbuf, n);
-            if (ret > 0)
+            _stats.tx_calls++;
+            if (ret > 0) {
                 _writebuf.advance(ret);
+                _stats.tx_bytes += ret;
+            }
         } else {
             ByteBuffer::IoVec vec[2];
             const auto n_vec = _writebuf.peekiovec(vec, n);
             for (int i = 0; i < n_vec; i++) {
                 ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
+                _stats.tx_calls++;
                 if (ret < 0) {
                     break;
                 }
                 _writebuf.advance(ret);
+                _stats.tx_bytes += ret;
 
                 /* We wrote less than we asked for, stop */
                 if ((unsigned)ret != vec[i].len) {
@@ -440,6 +515,13 @@ bool UARTDriver::_write_pending_bytes(void)
         }
     }
 
+    if (available_bytes > 0 && _writebuf.available() == 0) {
+        const uint32_t latency_usec = AP_HAL::micros() - _tx_queued_usec;
+        _stats.tx_latency_count++;
+        _stats.max_tx_latency_usec = MAX(_stats.max_tx_latency_usec, latency_usec);
+        _stats.avg_tx_latency_usec += (latency_usec - _stats.avg_tx_latency_usec) / _stats.tx_latency_count;
+    }
+
     return _writebuf.available() != available_bytes;
 }
 
@@ -447,6 +529,10 @@ bool UARTDriver::_write_pending_bytes(void)
   push any pending bytes to/from the serial port. This is called at
   1kHz in the timer thread. Doing it this way reduces the system call
   overhead in the main task enormously.
+
+  Devices with a file descriptor are also registered with the poller of
+  the uart thread, which reads them as soon as data arrives: for those
+  this only pushes out pending bytes.
  */
 void UARTDriver::_timer_tick(void)
 {
@@ -454,11 +540,20 @@ void UARTDriver::_timer_tick(void)
 
     _in_timer = true;
 
+    // allow write() to wake up the poller again
+    _tx_kicked = false;
+
     uint8_t num_send = 10;
     while (num_send != 0 && _write_pending_bytes()) {
         num_send--;
     }
 
+    if (_pollable.get_fd() >= 0) {
+        _update_pollable();
+        _in_timer = false;
+        return;
+    }
+
     // try to fill the read buffer
     int ret;
     ByteBuffer::IoVec vec[2];
@@ -466,10 +561,12 @@ void UARTDriver::_timer_tick(void)
     const auto n_vec = _readbuf.reserve(vec, _readbuf.space());
     for (int i = 0; i < n_vec; i++) {
         ret = _read_fd(vec[i].data, vec[i].len);
+        _stats.rx_calls++;
         if (ret < 0) {
             break;
         }
         _readbuf.commit((unsigned)ret);
+        _stats.rx_bytes += ret;
 
         /* stop reading as we read less than we asked for */
         if ((unsigned)ret < vec[i].len) {
@@ -477,5 +574,233 @@ void UARTDriver::_timer_tick(void)
         }
     }
 
+    // register the device with the poller once it's connected
+    _update_pollable();
+
+    _in_timer = false;
+}
+
+void UARTDriver::_poller_tick(void)
+{
+    if (!_initialised || !_tx_kicked || _pollable.get_fd() < 0) {
+        return;
+    }
+
+    _in_timer = true;
+
+    uint8_t num_send = 10;
+    while (num_send != 0 && _write_pending_bytes()) {
+        num_send--;
+    }
+    _update_pollable();
+
+    _in_timer = false;
+}
+
+/*
+  fill the read buffer from a device with a file descriptor. A stream is
+  drained by a single read, but datagrams are read one at a time
+ */
+void UARTDriver::_fill_read_buffer()
+{
+    for (uint8_t i = 0; i < UART_MAX_DATAGRAMS; i++) {
+        if (_readbuf.space() < _device->get_min_read_space()) {
+            break;
+        }
+        ByteBuffer::IoVec vec[2];
+        const auto n_vec = _readbuf.reserve(vec, _readbuf.space());
+        if (n_vec == 0) {
+            break;
+        }
+
+        struct iovec iov[2];
+        for (int j = 0; j < n_vec; j++) {
+            iov[j].iov_base = vec[j].data;
+            iov[j].iov_len = vec[j].len;
+        }
+
+        ssize_t ret = _device->readv(iov, n_vec);
+        _stats.rx_calls++;
+        if (ret <= 0) {
+            break;
+        }
+        _readbuf.commit((unsigned)ret);
+        _stats.rx_bytes += ret;
+
+        if (!_packetise) {
+            break;
+        }
+    }
+}
+
+void UARTDriver::_on_can_read()
+{
+    if (!_initialised) {
+        return;
+    }
+
+    _in_timer = true;
+
+    _stats.wakeups++;
+    _fill_read_buffer();
+
+    // the file descriptor changes when a TCP client connects or leaves
+    _update_pollable();
+
+    _in_timer = false;
+}
+
+void UARTDriver::_on_can_write()
+{
+    if (!_initialised) {
+        return;
+    }
+
+    _in_timer = true;
+
+    _stats.wakeups++;
+    uint8_t num_send = 10;
+    while (num_send != 0 && _write_pending_bytes()) {
+        num_send--;
+    }
+    _update_pollable();
+
+    _in_timer = false;
+}
+
+/*
+  a socket reports an error until it's read, and the error is often
+  transient, e.g. an ICMP port unreachable for a UDP peer not listening
+  yet: clear it and keep the registration. A file descriptor whose error
+  can't be cleared would be reported again forever, so it's handled like
+  a hang up
+ */
+void UARTDriver::_on_error()
+{
+    if (!_initialised) {
+        return;
+    }
+
+    const int fd = _pollable.get_fd();
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0) {
+        _on_hang_up();
+    }
+}
+
+/*
+  a hang up is reported until the file descriptor is closed: give the
+  device a chance to notice it with a read, e.g. for a TCP client, and
+  otherwise go back to polling it in _timer_tick()
+ */
+void UARTDriver::_on_hang_up()
+{
+    if (!_initialised) {
+        return;
+    }
+
+    _in_timer = true;
+
+    const int fd = _pollable.get_fd();
+    _fill_read_buffer();
+    if (_device->get_fd() == fd) {
+        _hung_up_fd = fd;
+    }
+    _update_pollable();
+
     _in_timer = false;
 }
+
+/*
+  keep the registration of the device with the poller of the uart thread
+  in sync with its file descriptor, and wait for it to be readable while
+  there is room in the read buffer and writable while a write was short
+ */
+void UARTDriver::_update_pollable()
+{
+    Poller *poller = _get_poller();
+    if (poller == nullptr) {
+        return;
+    }
+
+    int fd = _connected ? _device->get_fd() : -1;
+    if (fd != _hung_up_fd) {
+        _hung_up_fd = -1;
+    } else {
+        fd = -1;
+    }
+
+    if (fd != _pollable.get_fd()) {
+        _unregister_pollable();
+        if (fd < 0) {
+            return;
+        }
+        _pollable.set_fd(fd);
+        if (!poller->register_pollable(&_pollable, EPOLLIN)) {
+            _pollable.set_fd(-1);
+            return;
+        }
+        _poll_events = EPOLLIN;
+        _tx_blocked = false;
+        _poller = poller;
+    }
+
+    // a device needing more room than is left would be readable without
+    // anything to read into: wait for the main loop to make room
+    uint32_t events = 0;
+    if (_readbuf.space() >= _device->get_min_read_space()) {
+        events |= EPOLLIN;
+    }
+    if (_tx_blocked && _writebuf.available() > 0) {
+        events |= EPOLLOUT;
+    }
+    if (events != _poll_events && poller->modify_pollable(&_pollable, events)) {
+        _poll_events = events;
+    }
+}
+
+Poller *UARTDriver::_get_poller()
+{
+    return Scheduler::from(hal.scheduler)->get_uart_poller();
+}
+
+void UARTDriver::_unregister_pollable()
+{
+    Poller *poller = _poller;
+
+    _poller = nullptr;
+    if (poller != nullptr && _pollable.get_fd() >= 0) {
+        poller->unregister_pollable(&_pollable);
+    }
+    _pollable.set_fd(-1);
+    _poll_events = 0;
+}
+
+/*
+  wake up the uart thread to write data just queued, at most once per
+  _timer_tick() so that a burst of small writes doesn't cost a wakeup
+  each
+ */
+void UARTDriver::_kick_poller()
+{
+    Poller *poller = _poller;
+
+    if (poller != nullptr && !_tx_kicked) {
+        _tx_kicked = true;
+        poller->wakeup();
+    }
+}
+
+void UARTDriver::print_stats(const char *name) const
+{
+    fprintf(stderr, "%-16s rx: %" PRIu64 " bytes in %" PRIu32 " reads\t"
+            "tx: %" PRIu64 " bytes in %" PRIu32 " writes\t"
+            "wakeups: %" PRIu32 "\t"
+            "tx latency max: %" PRIu32 "us\t"
+            "avg: %.1fus\n",
+            name, _stats.rx_bytes, _stats.rx_calls,
+            _stats.tx_bytes, _stats.tx_calls, _stats.wakeups,
+            _stats.max_tx_latency_usec, (double)_stats.avg_tx_latency_usec);
+    _device->print_stats(name);
+}
@@ -4,6 +4,7 @@
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 
 namespace Linux {
@@ -29,6 +30,7 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    ssize_t read(uint8_t *buffer, uint16_t count) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c);
@@ -39,6 +41,35 @@ public:
     bool _write_pending_bytes(void);
     virtual void _timer_tick(void);
 
+    /*
+     * Called by the uart thread each time its poller wakes up, to write
+     * the data queued since the poller was woken up by write()
+     */
+    void _poller_tick(void);
+
+    /*
+     * Throughput and latency of the port. The write latency is the time
+     * from data being queued in an empty write buffer to the buffer being
+     * drained.
+     */
+    struct Stats {
+        uint64_t rx_bytes;
+        uint64_t tx_bytes;
+        uint32_t rx_calls;
+        uint32_t tx_calls;
+        uint32_t wakeups;
+        uint32_t max_tx_latency_usec;
+        float avg_tx_latency_usec;
+        uint32_t tx_latency_count;
+    };
+
+    const Stats &get_stats() const { return _stats; }
+
+    /*
+     * Print the statistics of this port to stderr, prefixed by @name
+     */
+    void print_stats(const char *name) const;
+
     virtual enum flow_control get_flow_control(void) override
     {
         return _device->get_flow_control();
@@ -50,25 +81,74 @@ public:
    }
 
 private:
+    /*
+     * Events of the device when it has a file descriptor, so the port is
+     * serviced as soon as it's readable or writable rather than on each
+     * _timer_tick()
+     */
+    class DevicePollable : public Pollable {
+    public:
+        DevicePollable(UARTDriver &uart) : _uart(uart) { }
+
+        /* the file descriptor belongs to the SerialDevice */
+        ~DevicePollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _uart._on_can_read(); }
+        void on_can_write() override { _uart._on_can_write(); }
+        void on_error() override { _uart._on_error(); }
+        void on_hang_up() override { _uart._on_hang_up(); }
+
+    private:
+        UARTDriver &_uart;
+    };
+
     AP_HAL::OwnPtr<SerialDevice> _device;
-    bool _nonblocking_writes;
-    bool _console;
-    volatile bool _in_timer;
-    uint16_t _base_port;
-    char *_ip;
-    char *_flag;
-    bool _connected; // true if a client has connected
+    bool _nonblocking_writes = false;
+    bool _console = false;
+    volatile bool _in_timer = false;
+    uint16_t _base_port = 0;
+    char *_ip = nullptr;
+    char *_flag = nullptr;
+    bool _connected = false; // true if a client has connected
     bool _packetise; // true if writes should try to be on mavlink boundaries
 
     void _allocate_buffers(uint16_t rxS, uint16_t txS);
     void _deallocate_buffers();
 
     AP_HAL::OwnPtr<SerialDevice> _parseDevicePath(const char *arg);
-    uint64_t _last_write_time;
+    uint64_t _last_write_time = 0;
+
+    void _on_can_read();
+    void _on_can_write();
+    void _on_error();
+    void _on_hang_up();
+    void _fill_read_buffer();
+    int _writev_fd(const ByteBuffer::IoVec *vec, int n_vec);
+    void _update_pollable();
+    void _unregister_pollable();
+    void _kick_poller();
+
+    DevicePollable _pollable{*this};
+    Poller * volatile _poller = nullptr;
+    uint32_t _poll_events = 0;
+    int _hung_up_fd = -1;
+    volatile bool _tx_kicked = false;
+    bool _tx_blocked = false;
+    volatile uint32_t _tx_queued_usec = 0;
+
+    Stats _stats{};
 
 protected:
+    /*
+     * The poller the device is registered with: the one of the uart
+     * thread, when called from it
+     */
+    virtual Poller *_get_poller();
+
     const char *device_path;
-    volatile bool _initialised;
+    volatile bool _initialised = false;
 
     // we use in-task ring buffers to reduce the system call cost
     // of ::read() and ::write() in the main loop
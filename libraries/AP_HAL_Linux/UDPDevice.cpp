@@ -1,8 +1,12 @@
 #include "UDPDevice.h"
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 #include <AP_HAL/AP_HAL.h>
 
@@ -21,6 +25,7 @@ UDPDevice::~UDPDevice()
 ssize_t UDPDevice::write(const uint8_t *buf, uint16_t n)
 {
     if (!socket.pollout(0)) {
+        errno = EAGAIN;
         return -1;
     }
     if (_connected) {
@@ -28,6 +33,7 @@ ssize_t UDPDevice::write(const uint8_t *buf, uint16_t n)
     }
     if (_input) {
         // can't send yet
+        errno = ENOTCONN;
         return -1;
     }
     return socket.sendto(buf, n, _ip, _port);
@@ -45,6 +51,41 @@ ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
     return ret;
 }
 
+/*
+  a datagram is received into, or sent from, all the elements at once
+  so that the two halves of a ring buffer hold a single packet
+ */
+ssize_t UDPDevice::readv(const struct iovec *iov, int iovcnt)
+{
+    if (!_connected) {
+        // read() connects to the sender of the first packet
+        return SerialDevice::readv(iov, iovcnt);
+    }
+    return ::readv(socket.get_fd(), iov, iovcnt);
+}
+
+ssize_t UDPDevice::writev(const struct iovec *iov, int iovcnt)
+{
+    if (!_connected) {
+        // sendto() needs the packet in one piece
+        size_t len = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            len += iov[i].iov_len;
+        }
+        uint8_t buf[len];
+        size_t ofs = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            memcpy(&buf[ofs], iov[i].iov_base, iov[i].iov_len);
+            ofs += iov[i].iov_len;
+        }
+        return write(buf, len);
+    }
+    struct msghdr msg {};
+    msg.msg_iov = const_cast<struct iovec *>(iov);
+    msg.msg_iovlen = iovcnt;
+    return ::sendmsg(socket.get_fd(), &msg, 0);
+}
+
 bool UDPDevice::open()
 {
     if (_input) {
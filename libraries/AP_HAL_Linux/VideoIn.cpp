@@ -265,10 +265,10 @@ void VideoIn::shrink_8bpp(uint8_t *buffer, uint8_t *new_buffer,
 
     /* selection offset */
     block_y = top * width;
-    block_position = left + block_y;
 
     for (i = 0; i < out_height; i++) {
         block_x = left;
+        block_position = block_x + block_y;
         for (j = 0; j < out_width; j++) {
             px = 0;
 
@@ -319,6 +319,52 @@ void VideoIn::yuyv_to_grey(uint8_t *buffer, uint32_t buffer_size,
     }
 }
 
+void VideoIn::downscale_to_grey(const uint8_t *buffer, uint32_t width,
+                                uint32_t pixel_size, uint32_t left,
+                                uint32_t top, uint32_t scale,
+                                uint32_t out_width, uint32_t out_height,
+                                uint8_t *new_buffer)
+{
+    const uint32_t line_size = width * pixel_size;
+    const uint8_t *line = buffer + top * line_size + left * pixel_size;
+
+    if (scale == 1) {
+        for (uint32_t j = 0; j < out_height; j++) {
+            if (pixel_size == 1) {
+                memcpy(new_buffer, line, out_width);
+            } else {
+                for (uint32_t i = 0; i < out_width; i++) {
+                    new_buffer[i] = line[i * pixel_size];
+                }
+            }
+            new_buffer += out_width;
+            line += line_size;
+        }
+        return;
+    }
+
+    /* divide the sums by the size of the blocks with a multiplication,
+     * exact since a sum is below 2^32 / block_size */
+    const uint64_t block_inv = (1ULL << 32) / (scale * scale) + 1;
+
+    for (uint32_t j = 0; j < out_height; j++) {
+        for (uint32_t i = 0; i < out_width; i++) {
+            const uint8_t *block = line + i * scale * pixel_size;
+            uint32_t px = 0;
+
+            for (uint32_t k = 0; k < scale; k++) {
+                for (uint32_t kk = 0; kk < scale; kk++) {
+                    px += block[kk * pixel_size];
+                }
+                block += line_size;
+            }
+            new_buffer[i] = (px * block_inv) >> 32;
+        }
+        new_buffer += out_width;
+        line += scale * line_size;
+    }
+}
+
 uint32_t VideoIn::_timeval_to_us(struct timeval& tv)
 {
     return (1.0e6 * tv.tv_sec + tv.tv_usec);
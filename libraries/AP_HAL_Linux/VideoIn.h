@@ -66,6 +66,17 @@ public:
     static void yuyv_to_grey(uint8_t *buffer, uint32_t buffer_size,
                              uint8_t *new_buffer);
 
+    /* Crop, shrink and convert to grey in a single pass: each pixel of
+     * the out_width x out_height new_buffer is the mean of a scale x scale
+     * block of the luma of buffer, starting at left, top. buffer is
+     * width pixels wide with pixel_size bytes per pixel, the luma being
+     * the first byte: 1 for GREY and NV12, 2 for YUYV */
+    static void downscale_to_grey(const uint8_t *buffer, uint32_t width,
+                                  uint32_t pixel_size, uint32_t left,
+                                  uint32_t top, uint32_t scale,
+                                  uint32_t out_width, uint32_t out_height,
+                                  uint8_t *new_buffer);
+
 private:
     void _queue_buffer(int index);
     bool _set_streaming(bool enable);
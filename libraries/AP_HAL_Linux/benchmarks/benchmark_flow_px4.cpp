@@ -0,0 +1,81 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+#include <AP_HAL/AP_HAL.h>
+
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BBBMINI
+
+#include <stdio.h>
+
+#include <AP_HAL_Linux/Flow_PX4.h>
+
+/*
+ * Flow between a textured frame and the same frame moved by 2 pixels
+ * right and 1 pixel down, at the square sizes given as argument. The
+ * items per second reported are the frames per second compute_flow()
+ * can sustain.
+ */
+static void BM_ComputeFlow(benchmark::State& state)
+{
+    const uint32_t width = state.range_x();
+    uint8_t *image1 = (uint8_t *)malloc(width * width);
+    uint8_t *image2 = (uint8_t *)malloc(width * width);
+    if (!image1 || !image2) {
+        fprintf(stderr, "error: couldn't malloc images\n");
+        return;
+    }
+
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < width * width; i++) {
+        seed = seed * 1103515245 + 12345;
+        image1[i] = seed >> 24;
+    }
+    for (uint32_t y = 0; y < width; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            const uint32_t sx = x >= 2 ? x - 2 : x;
+            const uint32_t sy = y >= 1 ? y - 1 : y;
+            image2[y * width + x] = image1[sy * width + sx];
+        }
+    }
+
+    Linux::Flow_PX4 flow(width, width,
+                         HAL_FLOW_PX4_MAX_FLOW_PIXEL,
+                         HAL_FLOW_PX4_BOTTOM_FLOW_FEATURE_THRESHOLD,
+                         HAL_FLOW_PX4_BOTTOM_FLOW_VALUE_THRESHOLD);
+    float flow_x = 0, flow_y = 0;
+    uint8_t qual = 0;
+
+    while (state.KeepRunning()) {
+        qual = flow.compute_flow(image1, image2, 0, &flow_x, &flow_y);
+        gbenchmark_escape(&flow_x);
+        gbenchmark_escape(&flow_y);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+
+    char label[48];
+    snprintf(label, sizeof(label), "flow %.2f %.2f qual %u", flow_x, flow_y, qual);
+    state.SetLabel(label);
+
+    free(image1);
+    free(image2);
+}
+
+BENCHMARK(BM_ComputeFlow)->Arg(HAL_OPTFLOW_ONBOARD_OUTPUT_WIDTH)->Arg(128)->Arg(240);
+#endif
+
+BENCHMARK_MAIN()
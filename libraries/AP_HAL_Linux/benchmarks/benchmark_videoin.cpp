@@ -62,6 +62,40 @@ static void BM_YuyvToGrey(benchmark::State& state)
 }
 
 BENCHMARK(BM_YuyvToGrey)->Arg(64 * 64)->Arg(320 * 240)->Arg(640 * 480);
+
+/* the conversion of the optical flow from a YUYV frame of the given size,
+ * made square by removing the lateral edges and shrunk to 64x64 */
+static void BM_DownscaleToGrey(benchmark::State& state)
+{
+    uint8_t *buffer, *new_buffer;
+    uint32_t width = state.range_x();
+    uint32_t height = state.range_y();
+    uint32_t scale = height / 64;
+    uint32_t left = (width - 64 * scale) / 2;
+    uint32_t top = (height - 64 * scale) / 2;
+
+    buffer = (uint8_t *)malloc(width * height * 2);
+    if (!buffer) {
+        fprintf(stderr, "error: couldn't malloc buffer\n");
+        return;
+    }
+
+    new_buffer = (uint8_t *)malloc(64 * 64);
+    if (!new_buffer) {
+        fprintf(stderr, "error: couldn't malloc new_buffer\n");
+        return;
+    }
+
+    while (state.KeepRunning()) {
+        Linux::VideoIn::downscale_to_grey(buffer, width, 2, left, top, scale,
+                                          64, 64, new_buffer);
+    }
+
+    free(buffer);
+    free(new_buffer);
+}
+
+BENCHMARK(BM_DownscaleToGrey)->ArgPair(64, 64)->ArgPair(320, 240)->ArgPair(640, 480);
 #endif
 
 BENCHMARK_MAIN()
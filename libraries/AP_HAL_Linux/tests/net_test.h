@@ -0,0 +1,130 @@
+/*
+ * Socket and MAVLink packet helpers shared by the tests of the network
+ * backed devices
+ */
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+static inline struct sockaddr_in loopback(uint16_t port)
+{
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+static inline uint16_t local_port(int fd)
+{
+    struct sockaddr_in addr {};
+    socklen_t len = sizeof(addr);
+    if (getsockname(fd, (struct sockaddr *)&addr, &len) != 0) {
+        return 0;
+    }
+    return ntohs(addr.sin_port);
+}
+
+/* a socket bound to a free loopback port */
+static inline int bound_socket(int type, uint16_t &port)
+{
+    int fd = socket(AF_INET, type | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = loopback(0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    port = local_port(fd);
+    return fd;
+}
+
+/* a loopback port free for both UDP and TCP */
+static inline uint16_t free_port()
+{
+    for (uint8_t i = 0; i < 10; i++) {
+        uint16_t port = 0;
+        int tcp = bound_socket(SOCK_STREAM, port);
+        if (tcp < 0) {
+            continue;
+        }
+        int udp = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        struct sockaddr_in addr = loopback(port);
+        const bool ok = bind(udp, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+        close(udp);
+        close(tcp);
+        if (ok) {
+            return port;
+        }
+    }
+    return 0;
+}
+
+static inline int udp_client(uint16_t port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = loopback(port);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* a TCP client, with a receive buffer of rcvbuf bytes if not zero */
+static inline int tcp_client(uint16_t port, int rcvbuf = 0)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (rcvbuf > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+    struct sockaddr_in addr = loopback(port);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static inline bool readable(int fd, int timeout_ms)
+{
+    struct pollfd pfd {};
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    return poll(&pfd, 1, timeout_ms) == 1;
+}
+
+/* a MAVLink 1 packet with len bytes of payload */
+static inline std::vector<uint8_t> packet1(uint8_t len, uint8_t seq)
+{
+    std::vector<uint8_t> pkt(len + 8);
+    pkt[0] = MAVLINK_STX_MAVLINK1;
+    pkt[1] = len;
+    pkt[2] = seq;
+    for (uint16_t i = 3; i < pkt.size(); i++) {
+        pkt[i] = seq + i;
+    }
+    return pkt;
+}
+
+/* a MAVLink 2 packet with len bytes of payload */
+static inline std::vector<uint8_t> packet2(uint8_t len, uint8_t seq)
+{
+    std::vector<uint8_t> pkt(len + 12);
+    pkt[0] = MAVLINK_STX;
+    pkt[1] = len;
+    pkt[2] = 0;
+    for (uint16_t i = 3; i < pkt.size(); i++) {
+        pkt[i] = seq + i;
+    }
+    return pkt;
+}
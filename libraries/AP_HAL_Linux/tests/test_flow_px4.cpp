@@ -0,0 +1,109 @@
+#include <AP_gtest.h>
+
+#include <stdlib.h>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BBBMINI
+
+#include <AP_HAL_Linux/Flow_PX4.h>
+
+using namespace Linux;
+
+class TestFlow : public Flow_PX4 {
+public:
+    using Flow_PX4::_simd;
+    using Flow_PX4::_compute_sad_8x8;
+    using Flow_PX4::_compute_subpixel_8x8;
+};
+
+#define NUM_WINDOWS 2000
+
+/*
+ * Without SIMD both paths are the scalar code, so there is nothing to
+ * compare. GTEST_SKIP() is only in newer googletest, older ones just pass
+ */
+#ifdef GTEST_SKIP
+#define SKIP_WITHOUT_SIMD() do { if (!TestFlow::_simd) { GTEST_SKIP() << "no SIMD in this build"; } } while (0)
+#else
+#define SKIP_WITHOUT_SIMD() do { if (!TestFlow::_simd) { return; } } while (0)
+#endif
+
+static std::vector<uint8_t> random_image(uint16_t row_size, uint16_t rows)
+{
+    std::vector<uint8_t> image(row_size * rows);
+    for (uint8_t &b : image) {
+        b = rand();
+    }
+    return image;
+}
+
+// windows at random places in images of random widths, with room for
+// the pixels around them read by the subpixel shifts
+static void random_window(uint16_t &row_size, uint16_t &x, uint16_t &y)
+{
+    row_size = 10 + rand() % 120;
+    x = 1 + rand() % (row_size - 9);
+    y = 1 + rand() % 20;
+}
+
+TEST(FlowPX4Test, sad_8x8)
+{
+    SKIP_WITHOUT_SIMD();
+    srand(1);
+    for (uint16_t n = 0; n < NUM_WINDOWS; n++) {
+        uint16_t row_size, x, y;
+        random_window(row_size, x, y);
+        const std::vector<uint8_t> image1 = random_image(row_size, 30);
+        std::vector<uint8_t> image2 = random_image(row_size, 30);
+        if (n % 4 == 0) {
+            // saturated pixels and the largest SAD
+            for (uint8_t &b : image2) {
+                b = b < 128 ? 255 : 0;
+            }
+        }
+        const uint8_t *p1 = &image1[y * row_size + x];
+        const uint8_t *p2 = &image2[(y + rand() % 2) * row_size + x];
+
+        EXPECT_EQ(TestFlow::_compute_sad_8x8(p1, p2, row_size, true),
+                  TestFlow::_compute_sad_8x8(p1, p2, row_size, false))
+            << "row_size " << row_size << " x " << x << " y " << y;
+    }
+}
+
+TEST(FlowPX4Test, subpixel_8x8)
+{
+    SKIP_WITHOUT_SIMD();
+    srand(2);
+    for (uint16_t n = 0; n < NUM_WINDOWS; n++) {
+        uint16_t row_size, x, y;
+        random_window(row_size, x, y);
+        const std::vector<uint8_t> image1 = random_image(row_size, 30);
+        std::vector<uint8_t> image2 = random_image(row_size, 30);
+        if (n % 4 == 0) {
+            for (uint8_t &b : image2) {
+                b = b < 128 ? 255 : 0;
+            }
+        }
+        const uint8_t *p1 = &image1[y * row_size + x];
+        const uint8_t *p2 = &image2[y * row_size + x];
+
+        uint32_t acc_simd[8];
+        uint32_t acc_scalar[8];
+        TestFlow::_compute_subpixel_8x8(p1, p2, acc_simd, row_size, true);
+        TestFlow::_compute_subpixel_8x8(p1, p2, acc_scalar, row_size, false);
+        for (uint8_t k = 0; k < 8; k++) {
+            EXPECT_EQ(acc_simd[k], acc_scalar[k])
+                << "shift " << (int)k << " row_size " << row_size
+                << " x " << x << " y " << y;
+        }
+    }
+}
+#endif
+
+AP_GTEST_MAIN()
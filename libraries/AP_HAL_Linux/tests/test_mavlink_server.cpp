@@ -0,0 +1,511 @@
+#include <AP_gtest.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/MAVLinkServerDevice.h>
+
+#include "net_test.h"
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * A server on a free loopback port, with a clock set by the test
+ */
+class TestServer : public MAVLinkServerDevice {
+public:
+    TestServer(uint16_t port, uint32_t client_rate = 0)
+        : MAVLinkServerDevice("127.0.0.1", port, client_rate)
+    { }
+
+    uint32_t now_ms = 1;
+
+protected:
+    uint32_t _millis() const override { return now_ms; }
+};
+
+/* read from the server until it returns something, for up to a second */
+static ssize_t read_server(TestServer &server, uint8_t *buf, uint16_t n)
+{
+    for (uint8_t i = 0; i < 100; i++) {
+        readable(server.get_fd(), 10);
+        ssize_t ret = server.read(buf, n);
+        if (ret > 0) {
+            return ret;
+        }
+    }
+    return -1;
+}
+
+/* have the server accept a TCP client */
+static void accept_client(TestServer &server)
+{
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    for (uint8_t i = 0; i < 10 && readable(server.get_fd(), 10); i++) {
+        server.read(buf, sizeof(buf));
+    }
+}
+
+/* a MAVLink 1 COMMAND_LONG from sysid/compid for the targets */
+static std::vector<uint8_t> command_long(uint8_t sysid, uint8_t compid,
+                                         uint8_t target_system, uint8_t target_component)
+{
+    const mavlink_msg_entry_t *entry = mavlink_get_msg_entry(MAVLINK_MSG_ID_COMMAND_LONG);
+    std::vector<uint8_t> pkt = packet1(MAVLINK_MSG_ID_COMMAND_LONG_LEN, 0);
+    pkt[3] = sysid;
+    pkt[4] = compid;
+    pkt[5] = MAVLINK_MSG_ID_COMMAND_LONG;
+    pkt[6 + entry->target_system_ofs] = target_system;
+    pkt[6 + entry->target_component_ofs] = target_component;
+    return pkt;
+}
+
+static ssize_t send_all(int fd, const std::vector<uint8_t> &buf)
+{
+    return send(fd, buf.data(), buf.size(), MSG_NOSIGNAL);
+}
+
+static ssize_t write_server(TestServer &server, const std::vector<uint8_t> &buf)
+{
+    return server.write(buf.data(), buf.size());
+}
+
+/* expect exactly buf, or nothing if it's empty, on a UDP client */
+static void expect_datagram(int fd, const std::vector<uint8_t> &buf)
+{
+    uint8_t rx[MAVLINK_SERVER_MAX_DATAGRAM];
+    ssize_t ret = recv(fd, rx, sizeof(rx), buf.empty() ? MSG_DONTWAIT : 0);
+    if (buf.empty()) {
+        EXPECT_EQ(ret, -1);
+        return;
+    }
+    ASSERT_EQ(ret, (ssize_t)buf.size());
+    EXPECT_EQ(memcmp(rx, buf.data(), buf.size()), 0);
+}
+
+/* expect exactly buf next on a TCP client */
+static void expect_stream(int fd, const std::vector<uint8_t> &buf)
+{
+    std::vector<uint8_t> rx(buf.size());
+    ASSERT_EQ(recv(fd, rx.data(), rx.size(), MSG_WAITALL), (ssize_t)rx.size());
+    EXPECT_EQ(rx, buf);
+}
+
+/*
+  whole packets are read from a TCP stream, skipping what isn't one
+ */
+TEST(MAVLinkServer, tcp_framing)
+{
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    int client = tcp_client(port);
+    ASSERT_GE(client, 0);
+    accept_client(server);
+
+    const auto a = packet1(10, 1);
+    const auto b = packet2(20, 2);
+    const auto c = packet1(30, 3);
+    const std::vector<uint8_t> junk { 'x', 'y', 'z' };
+
+    std::vector<uint8_t> data;
+    data.insert(data.end(), junk.begin(), junk.end());
+    data.insert(data.end(), a.begin(), a.end());
+    data.insert(data.end(), b.begin(), b.begin() + 7);
+    ASSERT_EQ(send_all(client, data), (ssize_t)data.size());
+
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)a.size());
+    EXPECT_EQ(memcmp(buf, a.data(), a.size()), 0);
+
+    // the rest of b is still to come
+    EXPECT_EQ(server.read(buf, sizeof(buf)), -1);
+
+    data.assign(b.begin() + 7, b.end());
+    data.insert(data.end(), junk.begin(), junk.end());
+    data.insert(data.end(), c.begin(), c.end());
+    ASSERT_EQ(send_all(client, data), (ssize_t)data.size());
+
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)b.size());
+    EXPECT_EQ(memcmp(buf, b.data(), b.size()), 0);
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)c.size());
+    EXPECT_EQ(memcmp(buf, c.data(), c.size()), 0);
+
+    close(client);
+}
+
+/*
+  a broadcast packet from a client goes to the UART and to the other
+  clients, and a packet written to all of them
+ */
+TEST(MAVLinkServer, relay)
+{
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    int tcp = tcp_client(port);
+    ASSERT_GE(tcp, 0);
+    accept_client(server);
+
+    int udp = udp_client(port);
+    ASSERT_GE(udp, 0);
+
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    const auto p = packet2(40, 1);
+    ASSERT_EQ(send_all(udp, p), (ssize_t)p.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)p.size());
+    EXPECT_EQ(memcmp(buf, p.data(), p.size()), 0);
+    expect_stream(tcp, p);
+    expect_datagram(udp, {});
+
+    const auto q = packet1(50, 2);
+    ASSERT_EQ(send_all(tcp, q), (ssize_t)q.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)q.size());
+    EXPECT_EQ(memcmp(buf, q.data(), q.size()), 0);
+    expect_datagram(udp, q);
+
+    const auto r = packet1(60, 3);
+    ASSERT_EQ(write_server(server, r), (ssize_t)r.size());
+    expect_datagram(udp, r);
+    expect_stream(tcp, r);
+
+    close(udp);
+    close(tcp);
+}
+
+/*
+  a packet from a client only goes to the clients its target was seen
+  on, and to none if it's for this vehicle
+ */
+TEST(MAVLinkServer, relay_by_target)
+{
+    mavlink_system.sysid = 1;
+    mavlink_system.compid = 1;
+
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    int gcs = udp_client(port);
+    int a = udp_client(port);
+    int b = udp_client(port);
+    ASSERT_GE(gcs, 0);
+    ASSERT_GE(a, 0);
+    ASSERT_GE(b, 0);
+
+    // broadcasts from each client teach the server where they are
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    const auto from_gcs = command_long(255, 190, 0, 0);
+    ASSERT_EQ(send_all(gcs, from_gcs), (ssize_t)from_gcs.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)from_gcs.size());
+    const auto from_a = command_long(20, 1, 0, 0);
+    ASSERT_EQ(send_all(a, from_a), (ssize_t)from_a.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)from_a.size());
+    expect_datagram(gcs, from_a);
+    const auto from_b = command_long(30, 1, 0, 0);
+    ASSERT_EQ(send_all(b, from_b), (ssize_t)from_b.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)from_b.size());
+    expect_datagram(gcs, from_b);
+    expect_datagram(a, from_b);
+
+    // to the system on a, any of its components
+    const auto to_a = command_long(255, 190, 20, 5);
+    ASSERT_EQ(send_all(gcs, to_a), (ssize_t)to_a.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)to_a.size());
+    expect_datagram(a, to_a);
+    expect_datagram(b, {});
+
+    // to this vehicle, or to a system on no client
+    const auto to_vehicle = command_long(255, 190, 1, 1);
+    ASSERT_EQ(send_all(gcs, to_vehicle), (ssize_t)to_vehicle.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)to_vehicle.size());
+    const auto to_nobody = command_long(255, 190, 40, 1);
+    ASSERT_EQ(send_all(gcs, to_nobody), (ssize_t)to_nobody.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)to_nobody.size());
+    expect_datagram(a, {});
+    expect_datagram(b, {});
+
+    // the vehicle's own packets still go to all of them
+    const auto p = packet1(10, 1);
+    ASSERT_EQ(write_server(server, p), (ssize_t)p.size());
+    expect_datagram(gcs, p);
+    expect_datagram(a, p);
+    expect_datagram(b, p);
+
+    close(gcs);
+    close(a);
+    close(b);
+}
+
+/*
+  a client gets its rate limit, also when written to more often than it
+  earns whole tokens
+ */
+TEST(MAVLinkServer, token_bucket)
+{
+    const uint16_t port = free_port();
+    // half a byte per ms, with the minimum burst of one packet
+    TestServer server(port, 500);
+    ASSERT_TRUE(server.open());
+
+    int udp = udp_client(port);
+    ASSERT_GE(udp, 0);
+    const auto hello = packet1(0, 0);
+    ASSERT_EQ(send_all(udp, hello), (ssize_t)hello.size());
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)hello.size());
+
+    // the burst of MAVLINK_MAX_PACKET_LEN bytes takes two packets
+    const auto p = packet1(92, 1);
+    uint16_t sent = 0;
+    for (uint8_t i = 0; i < 3; i++) {
+        ASSERT_EQ(write_server(server, p), (ssize_t)p.size());
+    }
+    while (recv(udp, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+        sent++;
+    }
+    EXPECT_EQ(sent, 2);
+
+    // 80 bytes left, and 500 more over a second
+    for (uint16_t i = 0; i < 1000; i++) {
+        server.now_ms++;
+        ASSERT_EQ(write_server(server, p), (ssize_t)p.size());
+    }
+    sent = 0;
+    while (recv(udp, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+        sent++;
+    }
+    EXPECT_EQ(sent, 5);
+
+    close(udp);
+}
+
+/*
+  a TCP client whose socket is full gets the rest of a packet sent before
+  anything else, and write() is refused while it's the only client
+ */
+TEST(MAVLinkServer, tcp_partial_send)
+{
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    int client = tcp_client(port, 4096);
+    ASSERT_GE(client, 0);
+    accept_client(server);
+
+    // packets of 263 bytes, so the socket fills up mid-packet
+    uint32_t n_blocked = 0;
+    std::vector<uint8_t> rx;
+    auto write_packet = [&](uint32_t seq) {
+        const auto p = packet1(255, seq);
+        while (write_server(server, p) < 0) {
+            ASSERT_EQ(errno, EAGAIN);
+            n_blocked++;
+
+            uint8_t buf[8192];
+            ASSERT_TRUE(readable(client, 1000));
+            ssize_t ret = recv(client, buf, sizeof(buf), MSG_DONTWAIT);
+            ASSERT_GT(ret, 0);
+            rx.insert(rx.end(), buf, buf + ret);
+        }
+    };
+
+    // the socket buffers grow with the traffic: write until the client
+    // blocks, then some more
+    uint32_t n_packets = 0;
+    uint32_t n_received = 0;
+    while (n_blocked == 0 || n_packets < 20000) {
+        write_packet(n_packets++);
+        ASSERT_LT(n_packets, 1000000U);
+
+        // the packets received so far are whole and in order
+        while (rx.size() >= 263) {
+            const auto expected = packet1(255, n_received++);
+            ASSERT_TRUE(std::equal(expected.begin(), expected.end(), rx.begin()));
+            rx.erase(rx.begin(), rx.begin() + expected.size());
+        }
+    }
+    EXPECT_GT(n_blocked, 0U);
+
+    // the rest of the last packet goes out with the next one
+    write_packet(n_packets);
+    while (n_received < n_packets) {
+        const auto expected = packet1(255, n_received++);
+        while (rx.size() < expected.size()) {
+            uint8_t buf[8192];
+            ASSERT_TRUE(readable(client, 1000));
+            ssize_t ret = recv(client, buf, sizeof(buf), MSG_DONTWAIT);
+            ASSERT_GT(ret, 0);
+            rx.insert(rx.end(), buf, buf + ret);
+        }
+        ASSERT_TRUE(std::equal(expected.begin(), expected.end(), rx.begin()));
+        rx.erase(rx.begin(), rx.begin() + expected.size());
+    }
+
+    close(client);
+}
+
+/*
+  write() is refused only when there are clients and none could take the
+  data
+ */
+TEST(MAVLinkServer, eagain)
+{
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    // no client: the data goes nowhere, but is taken
+    const auto p = packet1(255, 0);
+    EXPECT_EQ(write_server(server, p), (ssize_t)p.size());
+
+    // a client which doesn't read
+    int tcp = tcp_client(port, 4096);
+    ASSERT_GE(tcp, 0);
+    accept_client(server);
+    ssize_t ret;
+    for (uint32_t i = 0; (ret = write_server(server, p)) > 0; i++) {
+        ASSERT_LT(i, 1000000U);
+    }
+    EXPECT_EQ(ret, -1);
+    EXPECT_EQ(errno, EAGAIN);
+
+    // a client which can take it
+    int udp = udp_client(port);
+    ASSERT_GE(udp, 0);
+    const auto hello = packet1(0, 0);
+    ASSERT_EQ(send_all(udp, hello), (ssize_t)hello.size());
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)hello.size());
+
+    EXPECT_EQ(write_server(server, p), (ssize_t)p.size());
+    expect_datagram(udp, p);
+
+    close(udp);
+    close(tcp);
+}
+
+/*
+  UDP clients are dropped when they stay silent, also when the server
+  is only written to
+ */
+TEST(MAVLinkServer, udp_expiry)
+{
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    int a = udp_client(port);
+    int b = udp_client(port);
+    ASSERT_GE(a, 0);
+    ASSERT_GE(b, 0);
+
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    const auto hello = packet1(0, 0);
+    ASSERT_EQ(send_all(a, hello), (ssize_t)hello.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)hello.size());
+    ASSERT_EQ(send_all(b, hello), (ssize_t)hello.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)hello.size());
+    expect_datagram(a, hello);
+
+    server.now_ms += 5000;
+    ASSERT_EQ(send_all(b, hello), (ssize_t)hello.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)hello.size());
+    expect_datagram(a, hello);
+
+    // a has been silent for over 10s, b for 5s: a is dropped on the next
+    // write without any read
+    server.now_ms += 5001;
+
+    const auto p = packet1(10, 1);
+    EXPECT_EQ(write_server(server, p), (ssize_t)p.size());
+    expect_datagram(b, p);
+    expect_datagram(a, {});
+
+    close(a);
+    close(b);
+}
+
+/*
+  a datagram is only read whole
+ */
+TEST(MAVLinkServer, udp_no_truncation)
+{
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    int udp = udp_client(port);
+    ASSERT_GE(udp, 0);
+
+    // two packets in a datagram
+    auto data = packet2(200, 1);
+    const auto p = packet2(180, 2);
+    data.insert(data.end(), p.begin(), p.end());
+    ASSERT_EQ(send_all(udp, data), (ssize_t)data.size());
+
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    ASSERT_TRUE(readable(server.get_fd(), 1000));
+    EXPECT_EQ(server.read(buf, 300), -1);
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)data.size());
+    EXPECT_EQ(memcmp(buf, data.data(), data.size()), 0);
+
+    // one which can never be read is dropped
+    const std::vector<uint8_t> huge(MAVLINK_SERVER_MAX_DATAGRAM + 1, MAVLINK_STX);
+    ASSERT_EQ(send_all(udp, huge), (ssize_t)huge.size());
+    ASSERT_EQ(send_all(udp, p), (ssize_t)p.size());
+    ASSERT_EQ(read_server(server, buf, sizeof(buf)), (ssize_t)p.size());
+    EXPECT_EQ(memcmp(buf, p.data(), p.size()), 0);
+
+    close(udp);
+}
+
+/*
+  a TCP client isn't read from while its packets wait, and the device
+  stays readable until they have all been read
+ */
+TEST(MAVLinkServer, tcp_backpressure)
+{
+    const uint16_t port = free_port();
+    TestServer server(port);
+    ASSERT_TRUE(server.open());
+
+    int client = tcp_client(port);
+    ASSERT_GE(client, 0);
+    accept_client(server);
+
+    std::vector<uint8_t> data;
+    for (uint8_t i = 0; i < 5; i++) {
+        const auto p = packet1(192, i);
+        data.insert(data.end(), p.begin(), p.end());
+    }
+    ASSERT_EQ(send_all(client, data), (ssize_t)data.size());
+
+    // no room for a packet: the buffer of the client fills up
+    uint8_t buf[MAVLINK_SERVER_MAX_DATAGRAM];
+    for (uint8_t i = 0; i < 10; i++) {
+        ASSERT_TRUE(readable(server.get_fd(), 1000));
+        EXPECT_EQ(server.read(buf, 100), -1);
+    }
+
+    for (uint8_t i = 0; i < 5; i++) {
+        ASSERT_TRUE(readable(server.get_fd(), 1000));
+        ASSERT_EQ(server.read(buf, sizeof(buf)), 200);
+        const auto p = packet1(192, i);
+        EXPECT_EQ(memcmp(buf, p.data(), p.size()), 0);
+    }
+    EXPECT_FALSE(readable(server.get_fd(), 0));
+
+    close(client);
+}
+
+AP_GTEST_MAIN()
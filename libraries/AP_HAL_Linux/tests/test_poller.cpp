@@ -0,0 +1,61 @@
+#include <AP_gtest.h>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Poller.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class TestPollable : public Pollable {
+public:
+    TestPollable(int fd) : Pollable(fd) { }
+
+    void on_can_read() override { n_read++; }
+    void on_can_write() override { n_write++; }
+
+    int n_read = 0;
+    int n_write = 0;
+};
+
+TEST(LinuxPoller, timeout)
+{
+    Poller poller;
+    ASSERT_TRUE((bool)poller);
+
+    EXPECT_EQ(poller.poll(10), 0);
+}
+
+TEST(LinuxPoller, modify)
+{
+    Poller poller;
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+
+    TestPollable rd(fds[0]);
+    TestPollable wr(fds[1]);
+
+    EXPECT_TRUE(poller.register_pollable(&rd, EPOLLIN));
+    EXPECT_TRUE(poller.register_pollable(&wr, 0));
+
+    // nothing to read and not waiting for the write end
+    EXPECT_EQ(poller.poll(10), 0);
+
+    EXPECT_TRUE(poller.modify_pollable(&wr, EPOLLOUT));
+    EXPECT_EQ(poller.poll(10), 1);
+    EXPECT_EQ(wr.n_write, 1);
+
+    EXPECT_TRUE(poller.modify_pollable(&wr, 0));
+    EXPECT_EQ(write(fds[1], "x", 1), 1);
+    EXPECT_EQ(poller.poll(10), 1);
+    EXPECT_EQ(rd.n_read, 1);
+    EXPECT_EQ(wr.n_write, 1);
+
+    poller.unregister_pollable(&rd);
+    poller.unregister_pollable(&wr);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,370 @@
+#include <AP_gtest.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Storage.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define TEST_JOURNAL_MAGIC 0x4C4E4A41
+
+/*
+  storage kept in a directory of its own, with access to the journal
+  records to write damaged ones
+ */
+class TestStorage : public Storage {
+public:
+    using Storage::journal_record;
+
+    TestStorage(const char *dir)
+    {
+        snprintf(_dir, sizeof(_dir), "%s", dir);
+        snprintf(_file, sizeof(_file), "%s/test.stg", dir);
+        snprintf(_journal, sizeof(_journal), "%s/test.jnl", dir);
+        snprintf(_compact, sizeof(_compact), "%s/test.stg.new", dir);
+        _dir_name = _dir;
+        _file_name = _file;
+        _journal_name = _journal;
+        _compact_name = _compact;
+    }
+
+    ~TestStorage()
+    {
+        if (_journal_fd != -1) {
+            close(_journal_fd);
+        }
+        if (_compact_fd != -1) {
+            close(_compact_fd);
+        }
+    }
+
+    // run the timer until the dirty lines are in the journal and any
+    // compaction is done
+    void flush()
+    {
+        while (_dirty_mask != 0 || _compact_fd != -1) {
+            _timer_tick();
+        }
+    }
+
+    bool compacting() const { return _compact_fd != -1; }
+
+    static uint16_t crc(const uint8_t *record, uint32_t len)
+    {
+        return _journal_crc(record, len);
+    }
+
+private:
+    char _dir[64];
+    char _file[80];
+    char _journal[80];
+    char _compact[80];
+};
+
+class LinuxStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        snprintf(dir, sizeof(dir), "/tmp/ap_storage_XXXXXX");
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        snprintf(file, sizeof(file), "%s/test.stg", dir);
+        snprintf(journal, sizeof(journal), "%s/test.jnl", dir);
+        snprintf(compact, sizeof(compact), "%s/test.stg.new", dir);
+    }
+
+    void TearDown() override
+    {
+        unlink(file);
+        unlink(journal);
+        unlink(compact);
+        rmdir(dir);
+    }
+
+    static void fill_line(uint8_t *line, uint8_t n)
+    {
+        for (uint16_t i = 0; i < LINUX_STORAGE_LINE_SIZE; i++) {
+            line[i] = n + i * 7;
+        }
+    }
+
+    static void write_line(Storage &storage, uint8_t line, uint8_t n)
+    {
+        uint8_t data[LINUX_STORAGE_LINE_SIZE];
+        fill_line(data, n);
+        storage.write_block(line * LINUX_STORAGE_LINE_SIZE, data, sizeof(data));
+    }
+
+    // true if the line holds the pattern n, or zeros for n = 0
+    static bool line_is(Storage &storage, uint8_t line, uint8_t n)
+    {
+        uint8_t data[LINUX_STORAGE_LINE_SIZE];
+        uint8_t expected[LINUX_STORAGE_LINE_SIZE] {};
+        if (n != 0) {
+            fill_line(expected, n);
+        }
+        storage.read_block(data, line * LINUX_STORAGE_LINE_SIZE, sizeof(data));
+        return memcmp(data, expected, sizeof(data)) == 0;
+    }
+
+    static off_t file_size(const char *name)
+    {
+        struct stat st;
+        if (stat(name, &st) != 0) {
+            return -1;
+        }
+        return st.st_size;
+    }
+
+    // append a record with a valid crc for the given lines to the journal
+    void append_record(uint32_t seq, uint32_t line_mask, uint8_t n)
+    {
+        uint8_t record[sizeof(TestStorage::journal_record) + LINUX_STORAGE_SIZE];
+        uint8_t *line_data = &record[sizeof(TestStorage::journal_record)];
+        for (uint8_t line = 0; line < LINUX_STORAGE_NUM_LINES; line++) {
+            if (line_mask & (1U << line)) {
+                fill_line(line_data, n);
+                line_data += LINUX_STORAGE_LINE_SIZE;
+            }
+        }
+        const uint32_t len = line_data - record;
+
+        TestStorage::journal_record rec;
+        rec.magic = TEST_JOURNAL_MAGIC;
+        rec.seq = seq;
+        rec.line_mask = line_mask;
+        rec.crc = 0;
+        memcpy(record, &rec, sizeof(rec));
+        rec.crc = TestStorage::crc(record, len);
+        memcpy(record, &rec, sizeof(rec));
+
+        int fd = open(journal, O_WRONLY|O_APPEND);
+        ASSERT_NE(fd, -1);
+        EXPECT_EQ(write(fd, record, len), (ssize_t)len);
+        close(fd);
+    }
+
+    void corrupt_byte(const char *name, off_t ofs)
+    {
+        int fd = open(name, O_RDWR);
+        ASSERT_NE(fd, -1);
+        uint8_t b;
+        ASSERT_EQ(pread(fd, &b, 1, ofs), 1);
+        b ^= 0x5A;
+        EXPECT_EQ(pwrite(fd, &b, 1, ofs), 1);
+        close(fd);
+    }
+
+    char dir[64];
+    char file[80];
+    char journal[80];
+    char compact[80];
+
+    // size of the first record written
+    off_t record_len;
+};
+
+TEST_F(LinuxStorageTest, replay)
+{
+    {
+        TestStorage storage(dir);
+        write_line(storage, 0, 1);
+        write_line(storage, 5, 1);
+        storage.flush();
+        write_line(storage, 5, 2);
+        write_line(storage, 7, 3);
+        storage.flush();
+    }
+
+    TestStorage storage(dir);
+    EXPECT_TRUE(line_is(storage, 0, 1));
+    EXPECT_TRUE(line_is(storage, 5, 2));
+    EXPECT_TRUE(line_is(storage, 7, 3));
+    EXPECT_TRUE(line_is(storage, 1, 0));
+}
+
+TEST_F(LinuxStorageTest, torn_record)
+{
+    {
+        TestStorage storage(dir);
+        write_line(storage, 2, 1);
+        storage.flush();
+        record_len = file_size(journal);
+        write_line(storage, 2, 2);
+        write_line(storage, 3, 2);
+        storage.flush();
+    }
+    // power cut in the middle of the second record
+    ASSERT_EQ(truncate(journal, record_len + 100), 0);
+
+    {
+        TestStorage storage(dir);
+        EXPECT_TRUE(line_is(storage, 2, 1));
+        EXPECT_TRUE(line_is(storage, 3, 0));
+        // the torn record is cut off and new ones follow the good one
+        EXPECT_EQ(file_size(journal), record_len);
+        write_line(storage, 4, 3);
+        storage.flush();
+    }
+    EXPECT_GT(file_size(journal), record_len);
+
+    TestStorage storage(dir);
+    EXPECT_TRUE(line_is(storage, 2, 1));
+    EXPECT_TRUE(line_is(storage, 4, 3));
+}
+
+TEST_F(LinuxStorageTest, truncated_header)
+{
+    {
+        TestStorage storage(dir);
+        write_line(storage, 1, 1);
+        storage.flush();
+        record_len = file_size(journal);
+        write_line(storage, 1, 2);
+        storage.flush();
+    }
+    ASSERT_EQ(truncate(journal, record_len + 5), 0);
+
+    TestStorage storage(dir);
+    EXPECT_TRUE(line_is(storage, 1, 1));
+    EXPECT_EQ(file_size(journal), record_len);
+}
+
+TEST_F(LinuxStorageTest, bad_crc)
+{
+    {
+        TestStorage storage(dir);
+        for (uint8_t n = 1; n <= 3; n++) {
+            write_line(storage, 6, n);
+            storage.flush();
+            if (n == 1) {
+                record_len = file_size(journal);
+            }
+        }
+    }
+    // damage the lines of the second record: the third one is valid but
+    // must not be applied without the second
+    corrupt_byte(journal, record_len + sizeof(TestStorage::journal_record) + 10);
+
+    TestStorage storage(dir);
+    EXPECT_TRUE(line_is(storage, 6, 1));
+    EXPECT_EQ(file_size(journal), record_len);
+}
+
+TEST_F(LinuxStorageTest, bad_header)
+{
+    {
+        TestStorage storage(dir);
+        write_line(storage, 6, 1);
+        storage.flush();
+        record_len = file_size(journal);
+        write_line(storage, 6, 2);
+        storage.flush();
+    }
+    // the line mask is covered by the crc
+    corrupt_byte(journal, record_len + offsetof(TestStorage::journal_record, line_mask));
+
+    TestStorage storage(dir);
+    EXPECT_TRUE(line_is(storage, 6, 1));
+    EXPECT_EQ(file_size(journal), record_len);
+}
+
+TEST_F(LinuxStorageTest, out_of_sequence)
+{
+    {
+        TestStorage storage(dir);
+        write_line(storage, 8, 1);
+        storage.flush();
+        record_len = file_size(journal);
+    }
+    // valid records left from an older journal, with the wrong sequence
+    append_record(5, 1U << 8, 2);
+    append_record(0, 1U << 9, 3);
+
+    {
+        TestStorage storage(dir);
+        EXPECT_TRUE(line_is(storage, 8, 1));
+        EXPECT_TRUE(line_is(storage, 9, 0));
+        EXPECT_EQ(file_size(journal), record_len);
+    }
+
+    // a record with the right sequence is applied
+    append_record(1, (1U << 8) | (1U << 9), 4);
+    TestStorage storage(dir);
+    EXPECT_TRUE(line_is(storage, 8, 4));
+    EXPECT_TRUE(line_is(storage, 9, 4));
+}
+
+TEST_F(LinuxStorageTest, compaction)
+{
+    uint8_t expected[LINUX_STORAGE_SIZE];
+    uint8_t *saved_journal = new uint8_t[LINUX_STORAGE_JOURNAL_MAX + LINUX_STORAGE_SIZE];
+    ssize_t saved_journal_len = -1;
+
+    {
+        TestStorage storage(dir);
+        for (uint16_t n = 1; !storage.compacting(); n++) {
+            ASSERT_LT(n, 1000);
+            // a whole line also marks the next one dirty, keep that
+            // in the storage
+            write_line(storage, n % (LINUX_STORAGE_NUM_LINES - 1), n);
+            storage._timer_tick();
+        }
+        storage.read_block(expected, 0, sizeof(expected));
+
+        // the journal as left by a crash before it is emptied
+        int fd = open(journal, O_RDONLY);
+        ASSERT_NE(fd, -1);
+        saved_journal_len = read(fd, saved_journal, LINUX_STORAGE_JOURNAL_MAX + LINUX_STORAGE_SIZE);
+        close(fd);
+        EXPECT_GE(saved_journal_len, LINUX_STORAGE_JOURNAL_MAX);
+
+        // the new file is written over a few ticks, then renamed over
+        // the old one and the journal is emptied
+        storage.flush();
+        EXPECT_EQ(file_size(compact), -1);
+        EXPECT_EQ(file_size(journal), 0);
+    }
+
+    uint8_t data[LINUX_STORAGE_SIZE];
+    int fd = open(file, O_RDONLY);
+    ASSERT_NE(fd, -1);
+    EXPECT_EQ(read(fd, data, sizeof(data)), (ssize_t)sizeof(data));
+    close(fd);
+    EXPECT_EQ(memcmp(data, expected, sizeof(data)), 0);
+
+    {
+        // new records start again from the empty journal
+        TestStorage storage(dir);
+        storage.read_block(data, 0, sizeof(data));
+        EXPECT_EQ(memcmp(data, expected, sizeof(data)), 0);
+        write_line(storage, 0, 200);
+        storage.flush();
+        EXPECT_GT(file_size(journal), 0);
+    }
+    {
+        TestStorage storage(dir);
+        EXPECT_TRUE(line_is(storage, 0, 200));
+    }
+
+    // replaying the journal from before the compaction over the new
+    // file gives the same storage
+    fd = open(journal, O_WRONLY|O_TRUNC);
+    ASSERT_NE(fd, -1);
+    EXPECT_EQ(write(fd, saved_journal, saved_journal_len), saved_journal_len);
+    close(fd);
+    delete[] saved_journal;
+
+    TestStorage storage(dir);
+    storage.read_block(data, 0, sizeof(data));
+    EXPECT_EQ(memcmp(data, expected, sizeof(data)), 0);
+}
+
+AP_GTEST_MAIN()
@@ -117,4 +117,67 @@ TEST(LinuxThread, periodic_thread)
     EXPECT_TRUE(thr.join());
 }
 
+TEST(LinuxThread, periodic_thread_stats)
+{
+    TestPeriodicThread1 thr;
+    EXPECT_TRUE(thr.set_rate(1000));
+    EXPECT_TRUE(thr.start("ap-test", 0, 0));
+
+    while (!thr.is_started()) {
+        usleep(1000);
+    }
+
+    usleep(20000);
+
+    EXPECT_STREQ(thr.get_name(), "ap-test");
+
+    PeriodicThread::Stats stats;
+    thr.take_stats(stats);
+    EXPECT_GT(stats.count, 0U);
+    EXPECT_GE((float)stats.max_latency_usec, stats.avg_latency_usec);
+
+    EXPECT_TRUE(thr.stop());
+    EXPECT_TRUE(thr.join());
+
+    // each take restarts all the figures: once the wakeups up to the stop
+    // are taken there's nothing left
+    thr.take_stats(stats);
+    thr.take_stats(stats);
+    EXPECT_EQ(stats.count, 0U);
+    EXPECT_EQ(stats.overruns, 0U);
+    EXPECT_EQ(stats.max_latency_usec, 0U);
+    EXPECT_EQ(stats.avg_latency_usec, 0.0f);
+}
+
+class TestWorkerThread1 : public WorkerThread {
+public:
+    TestWorkerThread1() : WorkerThread{FUNCTOR_BIND_MEMBER(&TestWorkerThread1::_task, void)} { }
+
+    int n_runs = 0;
+
+protected:
+    void _task() {
+        n_runs++;
+    }
+};
+
+TEST(LinuxThread, worker_thread)
+{
+    TestWorkerThread1 thr;
+    EXPECT_TRUE(thr.start(nullptr, 0, 0));
+
+    // the task only runs when asked to, once each time
+    usleep(10000);
+    EXPECT_EQ(thr.n_runs, 0);
+
+    for (int i = 1; i <= 100; i++) {
+        thr.run();
+        thr.wait();
+        EXPECT_EQ(thr.n_runs, i);
+    }
+
+    EXPECT_TRUE(thr.stop());
+    EXPECT_TRUE(thr.join());
+}
+
 AP_GTEST_MAIN()
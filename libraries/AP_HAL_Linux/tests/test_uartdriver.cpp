@@ -0,0 +1,337 @@
+#include <AP_gtest.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Poller.h>
+#include <AP_HAL_Linux/UARTDriver.h>
+#include <AP_Math/AP_Math.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+#include "net_test.h"
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+ * A UART registered with a poller of the test rather than with the one of
+ * the uart thread, so the test drives its events with poll()
+ */
+class TestUART : public UARTDriver {
+public:
+    TestUART(const char *proto, uint16_t port)
+        : UARTDriver(false)
+    {
+        snprintf(_path, sizeof(_path), "%s:127.0.0.1:%u", proto, (unsigned)port);
+        set_device_path(_path);
+    }
+
+    ~TestUART() { end(); }
+
+    void start()
+    {
+        begin(115200);
+        set_blocking_writes(false);
+        // registers the device with the poller
+        _timer_tick();
+    }
+
+    Poller poller;
+
+protected:
+    Poller *_get_poller() override { return &poller; }
+
+private:
+    char _path[32];
+};
+
+/* poll until the UART has n bytes to read, for up to a second */
+static bool poll_available(TestUART &uart, uint32_t n)
+{
+    for (uint8_t i = 0; i < 100 && uart.available() < n; i++) {
+        uart.poller.poll(10);
+    }
+    return uart.available() == n;
+}
+
+static uint8_t pattern(uint32_t i)
+{
+    return i % 251;
+}
+
+/* fill the write buffer with the pattern, up to byte total of it */
+static void queue_pattern(TestUART &uart, uint32_t &queued, uint32_t total)
+{
+    uint8_t buf[1000];
+    const uint32_t n = MIN(MIN(uart.txspace(), sizeof(buf)), total - queued);
+    for (uint32_t i = 0; i < n; i++) {
+        buf[i] = pattern(queued + i);
+    }
+    queued += uart.write(buf, n);
+}
+
+/*
+  each MAVLink packet goes in its own datagram, also when it wraps around
+  the end of the write buffer
+ */
+TEST(LinuxUARTDriver, udp_packet_boundaries)
+{
+    uint16_t port;
+    int rx = bound_socket(SOCK_DGRAM, port);
+    ASSERT_GE(rx, 0);
+
+    TestUART uart("udp", port);
+    uart.start();
+    ASSERT_TRUE(uart.is_initialized());
+
+    // 96 byte packets don't divide the 32000 byte write buffer: the second
+    // round of writes has a packet straddling its end
+    const uint8_t len = 88;
+    std::vector<uint8_t> pkt;
+    uint8_t seq = 0;
+    uint8_t next_seq = 0;
+    uint16_t received = 0;
+
+    for (uint8_t round = 0; round < 2; round++) {
+        uint16_t n = round == 0 ? 1000 : 10;
+        while (n-- > 0 && uart.txspace() >= len + 8U) {
+            pkt = packet1(len, seq++);
+            ASSERT_EQ(uart.write(pkt.data(), pkt.size()), pkt.size());
+        }
+
+        while (uart.tx_pending()) {
+            uart._timer_tick();
+
+            uint8_t buf[512];
+            ssize_t ret;
+            while ((ret = recv(rx, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+                pkt = packet1(len, next_seq++);
+                ASSERT_EQ(ret, (ssize_t)pkt.size());
+                ASSERT_EQ(memcmp(buf, pkt.data(), pkt.size()), 0);
+                received++;
+            }
+        }
+    }
+
+    EXPECT_EQ(received, (uint16_t)(uart.get_stats().tx_bytes / (len + 8U)));
+    EXPECT_EQ(next_seq, seq);
+
+    close(rx);
+}
+
+/*
+  datagrams are read into both parts of the read buffer when it wraps
+ */
+TEST(LinuxUARTDriver, udp_read_wrapped)
+{
+    const uint16_t port = free_port();
+    TestUART uart("udpin", port);
+    uart.start();
+    ASSERT_TRUE(uart.is_initialized());
+
+    int tx = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(tx, 0);
+    struct sockaddr_in addr = loopback(port);
+
+    // 8 datagrams fill the 8192 byte read buffer up to 8000 bytes, and the
+    // next one wraps
+    uint32_t sent = 0;
+    uint32_t nread = 0;
+    for (uint8_t round = 0; round < 2; round++) {
+        const uint8_t n = round == 0 ? 8 : 4;
+        for (uint8_t i = 0; i < n; i++) {
+            uint8_t buf[1000];
+            for (uint16_t j = 0; j < sizeof(buf); j++) {
+                buf[j] = pattern(sent++);
+            }
+            ASSERT_EQ(sendto(tx, buf, sizeof(buf), 0, (struct sockaddr *)&addr, sizeof(addr)),
+                      (ssize_t)sizeof(buf));
+        }
+
+        ASSERT_TRUE(poll_available(uart, n * 1000));
+        while (uart.available() > 0) {
+            ASSERT_EQ(uart.read(), pattern(nread++));
+        }
+    }
+    EXPECT_EQ(nread, sent);
+
+    close(tx);
+}
+
+/*
+  a udpin port can't send before a peer has sent to it. Its socket is
+  always writable, so that must not arm EPOLLOUT: the packet waits for the
+  timer instead of waking the poller up over and over
+ */
+TEST(LinuxUARTDriver, udpin_no_peer)
+{
+    const uint16_t port = free_port();
+    TestUART uart("udpin", port);
+    uart.start();
+    ASSERT_TRUE(uart.is_initialized());
+
+    const std::vector<uint8_t> pkt = packet1(12, 0);
+    ASSERT_EQ(uart.write(pkt.data(), pkt.size()), pkt.size());
+    uart._timer_tick();
+    EXPECT_TRUE(uart.tx_pending());
+
+    // nothing to do once the wakeup from write() is handled
+    uart.poller.poll(0);
+    EXPECT_EQ(uart.poller.poll(0), 0);
+
+    // once a peer has sent to it the packet goes out
+    int peer = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(peer, 0);
+    struct sockaddr_in addr = loopback(port);
+    ASSERT_EQ(sendto(peer, pkt.data(), pkt.size(), 0, (struct sockaddr *)&addr, sizeof(addr)),
+              (ssize_t)pkt.size());
+    ASSERT_TRUE(poll_available(uart, pkt.size()));
+    uart._timer_tick();
+    EXPECT_FALSE(uart.tx_pending());
+
+    uint8_t buf[32];
+    ASSERT_EQ(recv(peer, buf, sizeof(buf), 0), (ssize_t)pkt.size());
+    EXPECT_EQ(memcmp(buf, pkt.data(), pkt.size()), 0);
+
+    close(peer);
+}
+
+/*
+  a short write arms EPOLLOUT: the poller alone pushes the rest of the
+  write buffer out once the client reads, across the end of the buffer
+ */
+TEST(LinuxUARTDriver, tcp_blocked_write)
+{
+    const uint16_t port = free_port();
+    TestUART uart("tcp", port);
+    uart.start();
+
+    int client = tcp_client(port, 4096);
+    ASSERT_GE(client, 0);
+
+    // the connection is accepted on the first read
+    uart.poller.poll(100);
+
+    // fill the socket buffers until a write is short. The send buffer
+    // grows with the traffic, up to a few MB
+    uint32_t queued = 0;
+    while (!uart.tx_pending() && queued < 64 * 1024 * 1024) {
+        queue_pattern(uart, queued, UINT32_MAX);
+        uart._timer_tick();
+    }
+    ASSERT_TRUE(uart.tx_pending());
+
+    // the client isn't reading: nothing to do once the wakeup from write()
+    // is handled
+    uart.poller.poll(0);
+    EXPECT_EQ(uart.poller.poll(0), 0);
+
+    // the socket gets writable as the client reads, and the poller alone
+    // has the UART write more
+    uint32_t received = 0;
+    const uint64_t tx_bytes = uart.get_stats().tx_bytes;
+    for (uint8_t i = 0; i < 100 && uart.get_stats().tx_bytes == tx_bytes; i++) {
+        uint8_t buf[4096];
+        ssize_t ret;
+        while ((ret = recv(client, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+            for (ssize_t j = 0; j < ret; j++) {
+                ASSERT_EQ(buf[j], pattern(received++));
+            }
+        }
+        uart.poller.poll(10);
+    }
+    EXPECT_GT(uart.get_stats().tx_bytes, tx_bytes);
+
+    // the rest goes out from _timer_tick(), across the end of the buffer
+    const uint32_t total = queued + 100000;
+    while (received < total) {
+        uint8_t buf[4096];
+        ssize_t ret = recv(client, buf, sizeof(buf), MSG_DONTWAIT);
+        for (ssize_t j = 0; j < ret; j++) {
+            ASSERT_EQ(buf[j], pattern(received++));
+        }
+        queue_pattern(uart, queued, total);
+        uart._timer_tick();
+        if (ret <= 0) {
+            uart.poller.poll(10);
+        }
+    }
+    EXPECT_FALSE(uart.tx_pending());
+
+    close(client);
+}
+
+/*
+  the device goes back to waiting for a connection when the client leaves,
+  and the next client is registered in turn
+ */
+TEST(LinuxUARTDriver, tcp_reconnect)
+{
+    const uint16_t port = free_port();
+    TestUART uart("tcp", port);
+    uart.start();
+
+    for (uint8_t i = 0; i < 2; i++) {
+        int client = tcp_client(port);
+        ASSERT_GE(client, 0);
+
+        const uint8_t msg[] = { 'a', 'b', (uint8_t)('0' + i) };
+        ASSERT_EQ(send(client, msg, sizeof(msg), 0), (ssize_t)sizeof(msg));
+        ASSERT_TRUE(poll_available(uart, sizeof(msg)));
+        uint8_t buf[sizeof(msg)];
+        ASSERT_EQ(uart.read(buf, sizeof(buf)), (ssize_t)sizeof(buf));
+        EXPECT_EQ(memcmp(buf, msg, sizeof(msg)), 0);
+
+        ASSERT_EQ(uart.write(msg, sizeof(msg)), sizeof(msg));
+        uart._timer_tick();
+        ASSERT_EQ(recv(client, buf, sizeof(buf), 0), (ssize_t)sizeof(buf));
+        EXPECT_EQ(memcmp(buf, msg, sizeof(msg)), 0);
+
+        // EOF on the next read
+        close(client);
+        uart.poller.poll(100);
+    }
+}
+
+/*
+  an ICMP port unreachable is reported as an error on the socket, which
+  stays registered with the poller
+ */
+TEST(LinuxUARTDriver, udp_error)
+{
+    const uint16_t port = free_port();
+    TestUART uart("udp", port);
+    uart.start();
+
+    const std::vector<uint8_t> pkt = packet1(12, 0);
+    ASSERT_EQ(uart.write(pkt.data(), pkt.size()), pkt.size());
+    uart._timer_tick();
+    EXPECT_GT(uart.poller.poll(100), 0);
+
+    // now somebody listens
+    int peer = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr = loopback(port);
+    ASSERT_EQ(bind(peer, (struct sockaddr *)&addr, sizeof(addr)), 0);
+
+    ASSERT_EQ(uart.write(pkt.data(), pkt.size()), pkt.size());
+    uart._timer_tick();
+
+    struct sockaddr_in from {};
+    socklen_t from_len = sizeof(from);
+    uint8_t buf[32];
+    ASSERT_EQ(recvfrom(peer, buf, sizeof(buf), 0, (struct sockaddr *)&from, &from_len),
+              (ssize_t)pkt.size());
+
+    // the reply wakes up the poller
+    ASSERT_EQ(sendto(peer, pkt.data(), pkt.size(), 0, (struct sockaddr *)&from, from_len),
+              (ssize_t)pkt.size());
+    EXPECT_TRUE(poll_available(uart, pkt.size()));
+
+    close(peer);
+}
+
+AP_GTEST_MAIN()
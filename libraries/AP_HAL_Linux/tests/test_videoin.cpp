@@ -0,0 +1,140 @@
+#include <AP_gtest.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BEBOP ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_MINLURE ||\
+    CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_BBBMINI
+
+#include <AP_HAL_Linux/VideoIn.h>
+
+using namespace Linux;
+
+#define OUT_SIZE 64
+
+static std::vector<uint8_t> random_frame(uint32_t width, uint32_t height,
+                                         uint32_t pixel_size)
+{
+    std::vector<uint8_t> frame(width * height * pixel_size);
+    for (uint8_t &b : frame) {
+        b = rand();
+    }
+    return frame;
+}
+
+/*
+  the conversion as it was done before downscale_to_grey(): convert a
+  YUYV frame to grey, then crop or shrink it
+ */
+static std::vector<uint8_t> reference(std::vector<uint8_t> frame,
+                                      uint32_t width, uint32_t height,
+                                      uint32_t pixel_size, uint32_t left,
+                                      uint32_t top, uint32_t scale)
+{
+    std::vector<uint8_t> grey(width * height);
+    if (pixel_size == 2) {
+        VideoIn::yuyv_to_grey(frame.data(), frame.size(), grey.data());
+    } else {
+        memcpy(grey.data(), frame.data(), grey.size());
+    }
+
+    std::vector<uint8_t> out(OUT_SIZE * OUT_SIZE);
+    if (scale == 1) {
+        VideoIn::crop_8bpp(grey.data(), out.data(), width,
+                           left, OUT_SIZE, top, OUT_SIZE);
+    } else {
+        VideoIn::shrink_8bpp(grey.data(), out.data(), width, height,
+                             left, OUT_SIZE * scale, top, OUT_SIZE * scale,
+                             scale, scale);
+    }
+    return out;
+}
+
+static void check_downscale(uint32_t width, uint32_t height,
+                            uint32_t pixel_size, uint32_t left,
+                            uint32_t top, uint32_t scale)
+{
+    const std::vector<uint8_t> frame = random_frame(width, height, pixel_size);
+    const std::vector<uint8_t> expected = reference(frame, width, height,
+                                                    pixel_size, left, top, scale);
+
+    std::vector<uint8_t> out(OUT_SIZE * OUT_SIZE);
+    VideoIn::downscale_to_grey(frame.data(), width, pixel_size, left, top,
+                               scale, OUT_SIZE, OUT_SIZE, out.data());
+    EXPECT_TRUE(out == expected) << "pixel_size " << pixel_size
+                                 << " scale " << scale
+                                 << " left " << left << " top " << top;
+}
+
+TEST(VideoInTest, crop)
+{
+    srand(1);
+    // centred and off centre
+    check_downscale(320, 240, 2, 128, 88, 1);
+    check_downscale(320, 240, 2, 0, 0, 1);
+    check_downscale(320, 240, 2, 255, 175, 1);
+    check_downscale(320, 240, 1, 128, 88, 1);
+    check_downscale(320, 240, 1, 3, 5, 1);
+}
+
+TEST(VideoInTest, shrink)
+{
+    srand(2);
+    for (uint32_t scale = 2; scale <= 3; scale++) {
+        const uint32_t left = (320 - OUT_SIZE * scale) / 2;
+        const uint32_t top = (240 - OUT_SIZE * scale) / 2;
+        check_downscale(320, 240, 2, left, top, scale);
+        check_downscale(320, 240, 1, left, top, scale);
+        check_downscale(320, 240, 2, 0, 0, scale);
+        check_downscale(320, 240, 1, 1, 1, scale);
+    }
+    // the largest block
+    check_downscale(640, 480, 2, 0, 0, 7);
+    check_downscale(640, 480, 1, 96, 16, 7);
+}
+
+/*
+  the first column of each row comes from the block at the left of the
+  selection, which shrink_8bpp() used to take from the end of the
+  previous row
+ */
+TEST(VideoInTest, first_column)
+{
+    srand(3);
+    const uint32_t width = 320;
+    const uint32_t height = 240;
+    const uint32_t scale = 3;
+    const uint32_t left = 10;
+    const uint32_t top = 20;
+
+    for (uint32_t pixel_size = 1; pixel_size <= 2; pixel_size++) {
+        const std::vector<uint8_t> frame = random_frame(width, height, pixel_size);
+        std::vector<uint8_t> out(OUT_SIZE * OUT_SIZE);
+        VideoIn::downscale_to_grey(frame.data(), width, pixel_size, left, top,
+                                   scale, OUT_SIZE, OUT_SIZE, out.data());
+
+        for (uint32_t j = 0; j < OUT_SIZE; j++) {
+            uint32_t sum = 0;
+            for (uint32_t y = 0; y < scale; y++) {
+                for (uint32_t x = 0; x < scale; x++) {
+                    const uint32_t row = top + j * scale + y;
+                    sum += frame[(row * width + left + x) * pixel_size];
+                }
+            }
+            EXPECT_EQ(out[j * OUT_SIZE], sum / (scale * scale)) << "row " << j;
+        }
+
+        const std::vector<uint8_t> expected = reference(frame, width, height,
+                                                        pixel_size, left, top, scale);
+        EXPECT_TRUE(out == expected);
+    }
+}
+#endif
+
+AP_GTEST_MAIN()
@@ -9,6 +9,7 @@ public:
     size_t write(uint8_t);
     size_t write(const uint8_t *buffer, size_t size);
     int16_t read() override;
+    using AP_HAL::Stream::read;
     uint32_t available() override;
     uint32_t txspace() override;
 private:
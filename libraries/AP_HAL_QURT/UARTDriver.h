@@ -41,6 +41,7 @@ public:
     int16_t available();
     int16_t txspace();
     int16_t read();
+    using AP_HAL::UARTDriver::read;
 
     /* QURT implementations of Print virtual methods */
     size_t write(uint8_t c);
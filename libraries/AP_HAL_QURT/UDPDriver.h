@@ -36,6 +36,7 @@ public:
     int16_t available();
     int16_t txspace();
     int16_t read();
+    using AP_HAL::UARTDriver::read;
 
     size_t write(uint8_t c);
     size_t write(const uint8_t *buffer, size_t size);
@@ -131,6 +131,17 @@ int16_t UARTDriver::read(void)
     return c;
 }
 
+ssize_t UARTDriver::read(uint8_t *buffer, uint16_t count)
+{
+    _check_connection();
+
+    if (!_connected) {
+        return 0;
+    }
+
+    return _readbuffer.read(buffer, count);
+}
+
 void UARTDriver::flush(void)
 {
 }
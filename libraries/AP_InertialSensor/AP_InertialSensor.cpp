@@ -441,6 +441,7 @@ AP_InertialSensor::AP_InertialSensor() :
     _board_orientation(ROTATION_NONE),
     _primary_gyro(0),
     _primary_accel(0),
+    _gyro_sample_cb_set(false),
     _hil_mode(false),
     _calibrating(false),
     _log_raw_data(false),
@@ -1498,6 +1499,21 @@ AuxiliaryBus *AP_InertialSensor::get_auxiliary_bus(int16_t backend_id, uint8_t i
     return backend->get_auxiliary_bus();
 }
 
+/*
+  set the callback run for each filtered sample of the primary gyro. The
+  functor is written before the flag releasing it to the sensor threads,
+  which only read it once they see the flag
+ */
+bool AP_InertialSensor::set_gyro_sample_callback(gyro_sample_cb_t cb)
+{
+    if (_gyro_sample_cb_set.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    _gyro_sample_cb = cb;
+    _gyro_sample_cb_set.store(true, std::memory_order_release);
+    return true;
+}
+
 // calculate vibration levels and check for accelerometer clipping (called by a backends)
 void AP_InertialSensor::calc_vibration_and_clipping(uint8_t instance, const Vector3f &accel, float dt)
 {
@@ -16,6 +16,7 @@
 #define INS_MAX_BACKENDS  6
 #define INS_VIBRATION_CHECK_INSTANCES 2
 
+#include <atomic>
 #include <stdint.h>
 
 #include <AP_AccelCal/AP_AccelCal.h>
@@ -88,6 +89,10 @@ public:
     const Vector3f     &get_gyro(uint8_t i) const { return _gyro[i]; }
     const Vector3f     &get_gyro(void) const { return get_gyro(_primary_gyro); }
 
+    // time in microseconds the latest sample in the current gyro values was taken
+    uint64_t get_gyro_sample_us(uint8_t i) const { return _gyro_sample_us[i]; }
+    uint64_t get_gyro_sample_us(void) const { return get_gyro_sample_us(_primary_gyro); }
+
     // set gyro offsets in radians/sec
     const Vector3f &get_gyro_offsets(uint8_t i) const { return _gyro_offset[i]; }
     const Vector3f &get_gyro_offsets(void) const { return get_gyro_offsets(_primary_gyro); }
@@ -203,6 +208,16 @@ public:
     // enable/disable raw gyro/accel logging
     void set_raw_logging(bool enable) { _log_raw_data = enable; }
 
+    /*
+      set a callback run from the sensor thread each time a raw sample of
+      the primary gyro has been filtered. It's given the filtered gyro,
+      rotated and corrected, and the time the sample was taken. Can only
+      be set once: the sensor threads may already be running, so it's
+      published to them with a flag rather than swapped under them
+     */
+    FUNCTOR_TYPEDEF(gyro_sample_cb_t, void, const Vector3f &, uint64_t);
+    bool set_gyro_sample_callback(gyro_sample_cb_t cb);
+
     // calculate vibration levels and check for accelerometer clipping (called by a backends)
     void calc_vibration_and_clipping(uint8_t instance, const Vector3f &accel, float dt);
 
@@ -304,11 +319,13 @@ private:
     LowPassFilter2pVector3f _gyro_filter[INS_MAX_INSTANCES];
     Vector3f _accel_filtered[INS_MAX_INSTANCES];
     Vector3f _gyro_filtered[INS_MAX_INSTANCES];
+    uint64_t _gyro_filtered_sample_us[INS_MAX_INSTANCES];
     bool _new_accel_data[INS_MAX_INSTANCES];
     bool _new_gyro_data[INS_MAX_INSTANCES];
 
     // Most recent gyro reading
     Vector3f _gyro[INS_MAX_INSTANCES];
+    uint64_t _gyro_sample_us[INS_MAX_INSTANCES];
     Vector3f _delta_angle[INS_MAX_INSTANCES];
     float _delta_angle_dt[INS_MAX_INSTANCES];
     bool _delta_angle_valid[INS_MAX_INSTANCES];
@@ -370,6 +387,11 @@ private:
     uint8_t _primary_gyro;
     uint8_t _primary_accel;
 
+    // called for each filtered sample of the primary gyro, once
+    // _gyro_sample_cb_set is true
+    gyro_sample_cb_t _gyro_sample_cb;
+    std::atomic<bool> _gyro_sample_cb_set;
+
     // has wait_for_sample() found a sample?
     bool _have_sample:1;
 
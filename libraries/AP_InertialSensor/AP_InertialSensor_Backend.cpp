@@ -77,6 +77,11 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
 
     dt = 1.0f / _imu._gyro_raw_sample_rates[instance];
 
+    // backends not timestamping their samples get them when they're read
+    if (sample_us == 0) {
+        sample_us = AP_HAL::micros64();
+    }
+
     // call gyro_sample hook if any
     AP_Module::call_hook_gyro_sample(instance, dt, gyro);
 
@@ -113,8 +118,15 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
         if (_imu._gyro_filtered[instance].is_nan() || _imu._gyro_filtered[instance].is_inf()) {
             _imu._gyro_filter[instance].reset();
         }
+        _imu._gyro_filtered_sample_us[instance] = sample_us;
         _imu._new_gyro_data[instance] = true;
+        const Vector3f gyro_filtered = _imu._gyro_filtered[instance];
         _sem->give();
+
+        if (instance == _imu._primary_gyro &&
+            _imu._gyro_sample_cb_set.load(std::memory_order_acquire)) {
+            _imu._gyro_sample_cb(gyro_filtered, sample_us);
+        }
     }
 
     DataFlash_Class *dataflash = get_dataflash();
@@ -279,6 +291,7 @@ void AP_InertialSensor_Backend::update_gyro(uint8_t instance)
 
     if (_imu._new_gyro_data[instance]) {
         _publish_gyro(instance, _imu._gyro_filtered[instance]);
+        _imu._gyro_sample_us[instance] = _imu._gyro_filtered_sample_us[instance];
         _imu._new_gyro_data[instance] = false;
     }
 
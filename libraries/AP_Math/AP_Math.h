@@ -10,6 +10,7 @@
 
 #include "definitions.h"
 #include "edc.h"
+#include "fast_trig.h"
 #include "location.h"
 #include "matrix3.h"
 #include "polygon.h"
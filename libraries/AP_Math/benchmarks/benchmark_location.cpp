@@ -0,0 +1,93 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#define NUM_LOCATIONS 64
+
+/*
+ * a polygon fence or a set of rally points around an origin, each point a
+ * few hundred meters from the next one
+ */
+struct location_inputs {
+    Location origin {};
+    Location locs[NUM_LOCATIONS] {};
+
+    location_inputs()
+    {
+        origin.lat = -353632610;
+        origin.lng = 1491652300;
+        for (uint8_t i = 0; i < NUM_LOCATIONS; i++) {
+            locs[i].lat = origin.lat + (int32_t)(20000 * sinf(i * 0.1f));
+            locs[i].lng = origin.lng + (int32_t)(25000 * cosf(i * 0.1f));
+        }
+    }
+};
+
+static const location_inputs inputs;
+
+static void BM_LocationDiff(benchmark::State& state)
+{
+    Vector2f ne[NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < NUM_LOCATIONS; i++) {
+            ne[i] = location_diff(inputs.origin, inputs.locs[i]);
+        }
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_LocationFrameGetNE(benchmark::State& state)
+{
+    Vector2f ne[NUM_LOCATIONS];
+
+    while (state.KeepRunning()) {
+        const LocationFrame frame(inputs.origin);
+        frame.get_ne(inputs.locs, ne, NUM_LOCATIONS);
+        gbenchmark_escape(ne);
+    }
+}
+
+static void BM_GetDistance(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        float sum = 0;
+        for (uint8_t i = 0; i < NUM_LOCATIONS; i++) {
+            sum += get_distance(inputs.origin, inputs.locs[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+}
+
+static void BM_LocationFrameGetDistance(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        const LocationFrame frame(inputs.origin);
+        float sum = 0;
+        for (uint8_t i = 0; i < NUM_LOCATIONS; i++) {
+            sum += frame.get_distance(inputs.locs[i]);
+        }
+        gbenchmark_escape(&sum);
+    }
+}
+
+BENCHMARK(BM_LocationDiff);
+BENCHMARK(BM_LocationFrameGetNE);
+BENCHMARK(BM_GetDistance);
+BENCHMARK(BM_LocationFrameGetDistance);
+
+BENCHMARK_MAIN()
@@ -17,6 +17,71 @@ static void BM_MatrixMultiplication(benchmark::State& state)
     }
 }
 
+static void BM_MatrixVectorMultiplication(benchmark::State& state)
+{
+    Matrix3f m(Vector3f(1.0f, 2.0f, 3.0f),
+               Vector3f(4.0f, 5.0f, 6.0f),
+               Vector3f(7.0f, 8.0f, 9.0f));
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        Vector3f r = m * v;
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_MatrixMulTranspose(benchmark::State& state)
+{
+    Matrix3f m(Vector3f(1.0f, 2.0f, 3.0f),
+               Vector3f(4.0f, 5.0f, 6.0f),
+               Vector3f(7.0f, 8.0f, 9.0f));
+    Vector3f v(1.0f, 2.0f, 3.0f);
+
+    while (state.KeepRunning()) {
+        Vector3f r = m.mul_transpose(v);
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_VectorDotProduct(benchmark::State& state)
+{
+    Vector3f v1(1.0f, 2.0f, 3.0f);
+    Vector3f v2(4.0f, 5.0f, 6.0f);
+
+    while (state.KeepRunning()) {
+        float r = v1 * v2;
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_VectorCrossProduct(benchmark::State& state)
+{
+    Vector3f v1(1.0f, 2.0f, 3.0f);
+    Vector3f v2(4.0f, 5.0f, 6.0f);
+
+    while (state.KeepRunning()) {
+        Vector3f r = v1 % v2;
+        gbenchmark_escape(&r);
+    }
+}
+
+static void BM_QuaternionMultiplication(benchmark::State& state)
+{
+    Quaternion q1, q2;
+    q1.from_euler(0.1f, 0.2f, 0.3f);
+    q2.from_euler(-0.3f, 0.5f, 1.0f);
+
+    while (state.KeepRunning()) {
+        Quaternion q3 = q1 * q2;
+        gbenchmark_escape(&q3);
+    }
+}
+
 BENCHMARK(BM_MatrixMultiplication);
+BENCHMARK(BM_MatrixVectorMultiplication);
+BENCHMARK(BM_MatrixMulTranspose);
+BENCHMARK(BM_VectorDotProduct);
+BENCHMARK(BM_VectorCrossProduct);
+BENCHMARK(BM_QuaternionMultiplication);
 
 BENCHMARK_MAIN()
@@ -0,0 +1,90 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+#define NUM_INPUTS 256
+
+/*
+ * Inputs shaped like the ones of AP_L1_Control::update_waypoint(): a vehicle
+ * flying along a 400m track with a crosstrack error of a few meters and
+ * ground speed vectors turning through all headings
+ */
+struct trig_inputs {
+    float y[NUM_INPUTS];
+    float x[NUM_INPUTS];
+    float sine[NUM_INPUTS];
+
+    trig_inputs()
+    {
+        for (uint16_t i = 0; i < NUM_INPUTS; i++) {
+            const float heading = i * (2 * M_PI / NUM_INPUTS);
+            const float speed = 12.0f + 8.0f * (i % 7) / 7.0f;
+            y[i] = speed * sinf(heading) + 3.0f * sinf(i * 0.37f);
+            x[i] = speed * cosf(heading) + 400.0f * (i % 3 == 0);
+            sine[i] = (((i * 37) % NUM_INPUTS) / (float)(NUM_INPUTS - 1)) * 2.0f - 1.0f;
+        }
+    }
+};
+
+static const trig_inputs inputs;
+
+static void BM_Atan2f(benchmark::State& state)
+{
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        float r = atan2f(inputs.y[i], inputs.x[i]);
+        gbenchmark_escape(&r);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+static void BM_ApproxAtan2f(benchmark::State& state)
+{
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        float r = approx_atan2f(inputs.y[i], inputs.x[i]);
+        gbenchmark_escape(&r);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+static void BM_SafeAsin(benchmark::State& state)
+{
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        float r = safe_asin(inputs.sine[i]);
+        gbenchmark_escape(&r);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+static void BM_ApproxAsinf(benchmark::State& state)
+{
+    uint16_t i = 0;
+    while (state.KeepRunning()) {
+        float r = approx_asinf(inputs.sine[i]);
+        gbenchmark_escape(&r);
+        i = (i + 1) % NUM_INPUTS;
+    }
+}
+
+BENCHMARK(BM_Atan2f);
+BENCHMARK(BM_ApproxAtan2f);
+BENCHMARK(BM_SafeAsin);
+BENCHMARK(BM_ApproxAsinf);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,116 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cmath>
+
+#include "definitions.h"
+
+/*
+ * Polynomial approximations of the inverse trigonometric functions used by
+ * the navigation controllers. On microcontrollers the libm versions are
+ * software routines taking several hundred cycles, while these are a few
+ * multiply-adds plus at most one division or square root, all done by the
+ * FPU.
+ *
+ * approx_atan2f() is within 5e-6 rad of atan2f() and approx_asinf() within
+ * 1e-6 rad of asinf(), see tests/test_fast_trig.cpp.
+ *
+ * fast_atan2f() and fast_asinf() are what the controllers call: they are
+ * the approximations when AP_MATH_FAST_TRIG is 1 and the libm functions
+ * otherwise. It defaults to 1 on the boards where libm is the slowest.
+ */
+#ifndef AP_MATH_FAST_TRIG
+#if CONFIG_HAL_BOARD == HAL_BOARD_PX4 || CONFIG_HAL_BOARD == HAL_BOARD_VRBRAIN
+#define AP_MATH_FAST_TRIG 1
+#else
+#define AP_MATH_FAST_TRIG 0
+#endif
+#endif
+
+#define AP_FAST_TRIG_PI      static_cast<float>(M_PI)
+#define AP_FAST_TRIG_PI_2    static_cast<float>(M_PI_2)
+
+// atan(z) for -1 <= z <= 1, minimax polynomial in z^2
+static inline float approx_atan_unit(float z)
+{
+    const float z2 = z * z;
+    return z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f +
+           z2 * (-0.11643287f + z2 * (0.05265332f + z2 * -0.01172120f)))));
+}
+
+// atan2(y, x) in -PI ~ PI, zero when both are zero
+static inline float approx_atan2f(float y, float x)
+{
+    const float abs_x = fabsf(x);
+    const float abs_y = fabsf(y);
+
+    if (abs_x >= abs_y) {
+        if (abs_x <= 0.0f) {
+            return 0.0f;
+        }
+        const float angle = approx_atan_unit(abs_y / abs_x);
+        const float ret = x < 0.0f ? AP_FAST_TRIG_PI - angle : angle;
+        return y < 0.0f ? -ret : ret;
+    }
+
+    const float angle = AP_FAST_TRIG_PI_2 - approx_atan_unit(abs_x / abs_y);
+    const float ret = x < 0.0f ? AP_FAST_TRIG_PI - angle : angle;
+    return y < 0.0f ? -ret : ret;
+}
+
+// asin(v) with the same input handling as safe_asin(): clipped to
+// -1 ~ 1 and zero for nan
+static inline float approx_asinf(float v)
+{
+    if (std::isnan(v)) {
+        return 0.0f;
+    }
+    const float x = fabsf(v) < 1.0f ? fabsf(v) : 1.0f;
+
+    // Abramowitz and Stegun 4.4.46
+    const float p = 1.5707963050f + x * (-0.2145988016f + x * (0.0889789874f +
+                    x * (-0.0501743046f + x * (0.0308918810f + x * (-0.0170881256f +
+                    x * (0.0066700901f + x * -0.0012624911f))))));
+    const float ret = AP_FAST_TRIG_PI_2 - sqrtf(1.0f - x) * p;
+    return v < 0.0f ? -ret : ret;
+}
+
+static inline float fast_atan2f(float y, float x)
+{
+#if AP_MATH_FAST_TRIG
+    return approx_atan2f(y, x);
+#else
+    return atan2f(y, x);
+#endif
+}
+
+static inline float fast_asinf(float v)
+{
+#if AP_MATH_FAST_TRIG
+    return approx_asinf(v);
+#else
+    if (std::isnan(v)) {
+        return 0.0f;
+    }
+    if (v >= 1.0f) {
+        return AP_FAST_TRIG_PI_2;
+    }
+    if (v <= -1.0f) {
+        return -AP_FAST_TRIG_PI_2;
+    }
+    return asinf(v);
+#endif
+}
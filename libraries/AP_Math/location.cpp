@@ -331,3 +331,37 @@ bool check_latlng(Location loc)
 {
     return check_lat(loc.lat) && check_lng(loc.lng);
 }
+
+void LocationFrame::set_origin(const struct Location &origin)
+{
+    _origin = origin;
+    _lng_scale = constrain_float(cosf(origin.lat * 1.0e-7f * DEG_TO_RAD), 0.01f, 1.0f);
+    _lng_to_m = LOCATION_SCALING_FACTOR * _lng_scale;
+    _m_to_lng = LOCATION_SCALING_FACTOR_INV / _lng_scale;
+}
+
+void LocationFrame::get_ne(const struct Location *locs, Vector2f *ne, uint16_t count) const
+{
+    const int32_t origin_lat = _origin.lat;
+    const int32_t origin_lng = _origin.lng;
+    const float lng_to_m = _lng_to_m;
+
+    for (uint16_t i = 0; i < count; i++) {
+        ne[i].x = (locs[i].lat - origin_lat) * LOCATION_SCALING_FACTOR;
+        ne[i].y = (locs[i].lng - origin_lng) * lng_to_m;
+    }
+}
+
+void LocationFrame::get_location(const Vector2f &ne, struct Location &loc) const
+{
+    loc.lat = _origin.lat + (int32_t)(ne.x * LOCATION_SCALING_FACTOR_INV);
+    loc.lng = _origin.lng + (int32_t)(ne.y * _m_to_lng);
+}
+
+int32_t LocationFrame::get_bearing_cd(const struct Location &loc) const
+{
+    const Vector2f ne = get_ne(loc);
+    int32_t bearing = 9000 + atan2f(-ne.x, ne.y) * 5729.57795f;
+    if (bearing < 0) bearing += 36000;
+    return bearing;
+}
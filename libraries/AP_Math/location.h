@@ -93,3 +93,44 @@ bool        check_latlng(float lat, float lng);
 bool        check_latlng(int32_t lat, int32_t lng);
 bool        check_latlng(Location loc);
 
+/*
+  local north/east frame around an origin, for code converting many
+  locations near the same point. The longitude scale of the origin is
+  computed once in set_origin(), instead of on each call as the
+  functions above do. Offsets are in meters
+ */
+class LocationFrame {
+public:
+    LocationFrame() {}
+    LocationFrame(const struct Location &origin) { set_origin(origin); }
+
+    void set_origin(const struct Location &origin);
+    const struct Location &get_origin() const { return _origin; }
+
+    // scale of longitude at the origin, see longitude_scale()
+    float get_longitude_scale() const { return _lng_scale; }
+
+    // north/east offset from the origin to loc
+    Vector2f get_ne(const struct Location &loc) const {
+        return Vector2f((loc.lat - _origin.lat) * LOCATION_SCALING_FACTOR,
+                        (loc.lng - _origin.lng) * _lng_to_m);
+    }
+
+    // north/east offsets from the origin to count locations
+    void get_ne(const struct Location *locs, Vector2f *ne, uint16_t count) const;
+
+    // set lat and lng of loc to the point at a north/east offset from
+    // the origin. The other fields of loc are left alone
+    void get_location(const Vector2f &ne, struct Location &loc) const;
+
+    // distance in meters and bearing in centi-degrees from the origin to loc
+    float get_distance(const struct Location &loc) const { return get_ne(loc).length(); }
+    int32_t get_bearing_cd(const struct Location &loc) const;
+
+private:
+    struct Location _origin {};
+    float _lng_scale = 1.0f;
+    float _lng_to_m = LOCATION_SCALING_FACTOR;
+    float _m_to_lng = LOCATION_SCALING_FACTOR_INV;
+};
+
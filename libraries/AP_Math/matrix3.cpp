@@ -19,6 +19,7 @@
 #pragma GCC optimize("O3")
 
 #include "AP_Math.h"
+#include "simd.h"
 
 // create a rotation matrix given some euler angles
 // this is based on http://gentlenav.googlecode.com/files/EulerAngles.pdf
@@ -172,6 +173,53 @@ Matrix3<T> Matrix3<T>::operator *(const Matrix3<T> &m) const
     return temp;
 }
 
+/*
+  float versions of mul_transpose() and matrix multiplication, declared in
+  matrix3.h. With SIMD they work on whole rows: each row of the result is
+  a linear combination of the rows of the matrix on the right
+ */
+template <>
+Vector3<float> Matrix3<float>::mul_transpose(const Vector3<float> &v) const
+{
+#if AP_MATH_ALLOW_SIMD
+    const ap_float4 r = ap_float4_splat(v.x) * ap_float4_load3(&a.x) +
+                        ap_float4_splat(v.y) * ap_float4_load3(&b.x) +
+                        ap_float4_splat(v.z) * ap_float4_load3(&c.x);
+    Vector3<float> ret;
+    ap_float4_store3(&ret.x, r);
+    return ret;
+#else
+    return Vector3<float>(a.x * v.x + b.x * v.y + c.x * v.z,
+                          a.y * v.x + b.y * v.y + c.y * v.z,
+                          a.z * v.x + b.z * v.y + c.z * v.z);
+#endif
+}
+
+template <>
+Matrix3<float> Matrix3<float>::operator *(const Matrix3<float> &m) const
+{
+#if AP_MATH_ALLOW_SIMD
+    const ap_float4 ma = ap_float4_load3(&m.a.x);
+    const ap_float4 mb = ap_float4_load3(&m.b.x);
+    const ap_float4 mc = ap_float4_load3(&m.c.x);
+    Matrix3<float> temp;
+    ap_float4_store3(&temp.a.x, ap_float4_splat(a.x) * ma + ap_float4_splat(a.y) * mb + ap_float4_splat(a.z) * mc);
+    ap_float4_store3(&temp.b.x, ap_float4_splat(b.x) * ma + ap_float4_splat(b.y) * mb + ap_float4_splat(b.z) * mc);
+    ap_float4_store3(&temp.c.x, ap_float4_splat(c.x) * ma + ap_float4_splat(c.y) * mb + ap_float4_splat(c.z) * mc);
+    return temp;
+#else
+    return Matrix3<float>(Vector3<float>(a.x * m.a.x + a.y * m.b.x + a.z * m.c.x,
+                                         a.x * m.a.y + a.y * m.b.y + a.z * m.c.y,
+                                         a.x * m.a.z + a.y * m.b.z + a.z * m.c.z),
+                          Vector3<float>(b.x * m.a.x + b.y * m.b.x + b.z * m.c.x,
+                                         b.x * m.a.y + b.y * m.b.y + b.z * m.c.y,
+                                         b.x * m.a.z + b.y * m.b.z + b.z * m.c.z),
+                          Vector3<float>(c.x * m.a.x + c.y * m.b.x + c.z * m.c.x,
+                                         c.x * m.a.y + c.y * m.b.y + c.z * m.c.y,
+                                         c.x * m.a.z + c.y * m.b.z + c.z * m.c.z));
+#endif
+}
+
 template <typename T>
 Matrix3<T> Matrix3<T>::transposed(void) const
 {
@@ -264,8 +312,6 @@ template void Matrix3<float>::from_euler312(float roll, float pitch, float yaw);
 template void Matrix3<float>::from_axis_angle(const Vector3<float> &v, float theta);
 template Vector3<float> Matrix3<float>::to_euler312(void) const;
 template Vector3<float> Matrix3<float>::operator *(const Vector3<float> &v) const;
-template Vector3<float> Matrix3<float>::mul_transpose(const Vector3<float> &v) const;
-template Matrix3<float> Matrix3<float>::operator *(const Matrix3<float> &m) const;
 template Matrix3<float> Matrix3<float>::transposed(void) const;
 template float Matrix3<float>::det() const;
 template bool Matrix3<float>::inverse(Matrix3<float>& inv) const;
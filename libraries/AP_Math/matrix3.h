@@ -260,6 +260,10 @@ public:
     void        normalize(void);
 };
 
+// float specialisations, vectorised where SIMD is available
+template <> Vector3<float> Matrix3<float>::mul_transpose(const Vector3<float> &v) const;
+template <> Matrix3<float> Matrix3<float>::operator *(const Matrix3<float> &m) const;
+
 typedef Matrix3<int16_t>                Matrix3i;
 typedef Matrix3<uint16_t>               Matrix3ui;
 typedef Matrix3<int32_t>                Matrix3l;
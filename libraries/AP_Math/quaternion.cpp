@@ -19,6 +19,7 @@
 #pragma GCC optimize("O3")
 
 #include "AP_Math.h"
+#include "simd.h"
 
 // return the rotation matrix equivalent for this quaternion
 void Quaternion::rotation_matrix(Matrix3f &m) const
@@ -309,6 +310,15 @@ void Quaternion::normalize(void)
 Quaternion Quaternion::operator*(const Quaternion &v) const
 {
     Quaternion ret;
+#if AP_MATH_ALLOW_SIMD
+    // the product is v scaled by each component of this quaternion, with
+    // the components of v permuted and sign flipped per the Hamilton product
+    const ap_float4 r = ap_float4_splat(q1) * ap_float4_load(&v.q1) +
+                        ap_float4_splat(q2) * ap_float4_set(-v.q2,  v.q1, -v.q4,  v.q3) +
+                        ap_float4_splat(q3) * ap_float4_set(-v.q3,  v.q4,  v.q1, -v.q2) +
+                        ap_float4_splat(q4) * ap_float4_set(-v.q4, -v.q3,  v.q2,  v.q1);
+    ap_float4_store(&ret.q1, r);
+#else
     const float &w1 = q1;
     const float &x1 = q2;
     const float &y1 = q3;
@@ -323,12 +333,16 @@ Quaternion Quaternion::operator*(const Quaternion &v) const
     ret.q2 = w1*x2 + x1*w2 + y1*z2 - z1*y2;
     ret.q3 = w1*y2 - x1*z2 + y1*w2 + z1*x2;
     ret.q4 = w1*z2 + x1*y2 - y1*x2 + z1*w2;
+#endif
 
     return ret;
 }
 
 Quaternion &Quaternion::operator*=(const Quaternion &v)
 {
+#if AP_MATH_ALLOW_SIMD
+    *this = (*this) * v;
+#else
     float w1 = q1;
     float x1 = q2;
     float y1 = q3;
@@ -343,6 +357,7 @@ Quaternion &Quaternion::operator*=(const Quaternion &v)
     q2 = w1*x2 + x1*w2 + y1*z2 - z1*y2;
     q3 = w1*y2 - x1*z2 + y1*w2 + z1*x2;
     q4 = w1*z2 + x1*y2 - y1*x2 + z1*w2;
+#endif
 
     return *this;
 }
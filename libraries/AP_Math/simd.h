@@ -0,0 +1,104 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+ * 4 x float helpers built on GCC vector extensions, lowered by the compiler
+ * to SSE on x86 and NEON on ARM. They are meant for small kernels in
+ * translation units, never for public headers: Vector3f, Matrix3f and
+ * Quaternion keep their packed, unaligned layout since they are stored in
+ * parameters, logs and MAVLink messages, so loads and stores here never
+ * assume alignment.
+ *
+ * Define AP_MATH_ALLOW_SIMD to 0 to force the scalar implementations.
+ */
+#ifndef AP_MATH_ALLOW_SIMD
+#if defined(__GNUC__) && (defined(__SSE__) || defined(__ARM_NEON__) || defined(__aarch64__))
+#define AP_MATH_ALLOW_SIMD 1
+#else
+#define AP_MATH_ALLOW_SIMD 0
+#endif
+#endif
+
+#if AP_MATH_ALLOW_SIMD
+
+#include <stdint.h>
+#include <string.h>
+
+typedef float ap_float4 __attribute__((vector_size(16)));
+typedef int32_t ap_int4 __attribute__((vector_size(16)));
+
+static inline ap_float4 ap_float4_set(float x, float y, float z, float w)
+{
+    ap_float4 r = { x, y, z, w };
+    return r;
+}
+
+static inline ap_float4 ap_float4_splat(float f)
+{
+    ap_float4 r = { f, f, f, f };
+    return r;
+}
+
+// load 4 floats with no alignment requirement
+static inline ap_float4 ap_float4_load(const float *p)
+{
+    ap_float4 r;
+    memcpy(&r, p, sizeof(r));
+    return r;
+}
+
+// load 3 floats, the 4th lane is zero. Never reads past p[2]
+static inline ap_float4 ap_float4_load3(const float *p)
+{
+    return ap_float4_set(p[0], p[1], p[2], 0.0f);
+}
+
+static inline void ap_float4_store(float *p, ap_float4 v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+// store the first 3 lanes. Never writes past p[2]
+static inline void ap_float4_store3(float *p, ap_float4 v)
+{
+    p[0] = v[0];
+    p[1] = v[1];
+    p[2] = v[2];
+}
+
+// per lane a if mask is set, b otherwise. mask is the result of a comparison
+static inline ap_float4 ap_float4_select(ap_int4 mask, ap_float4 a, ap_float4 b)
+{
+    return mask ? a : b;
+}
+
+static inline ap_float4 ap_float4_abs(ap_float4 v)
+{
+    const ap_int4 m = { 0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff };
+    return (ap_float4)((ap_int4)v & m);
+}
+
+static inline ap_float4 ap_float4_min(ap_float4 a, ap_float4 b)
+{
+    return ap_float4_select(a < b, a, b);
+}
+
+static inline ap_float4 ap_float4_max(ap_float4 a, ap_float4 b)
+{
+    return ap_float4_select(a > b, a, b);
+}
+
+#endif // AP_MATH_ALLOW_SIMD
@@ -0,0 +1,52 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+TEST(FastTrigTest, Atan2)
+{
+    float max_error = 0.0f;
+
+    for (int i = -1000; i <= 1000; i++) {
+        for (int j = -1000; j <= 1000; j++) {
+            const float x = i * 0.013f;
+            const float y = j * 0.0071f;
+            const float error = fabsf(approx_atan2f(y, x) - atan2f(y, x));
+            max_error = MAX(max_error, error);
+        }
+    }
+    EXPECT_LT(max_error, 5.0e-6f);
+
+    // quadrants, axes and the origin
+    EXPECT_FLOAT_EQ(0.0f, approx_atan2f(0.0f, 0.0f));
+    EXPECT_FLOAT_EQ(0.0f, approx_atan2f(0.0f, 1.0f));
+    EXPECT_NEAR(M_PI_2, approx_atan2f(1.0f, 0.0f), 5.0e-6f);
+    EXPECT_NEAR(-M_PI_2, approx_atan2f(-1.0f, 0.0f), 5.0e-6f);
+    EXPECT_NEAR(M_PI, approx_atan2f(0.0f, -1.0f), 5.0e-6f);
+    EXPECT_NEAR(3 * M_PI_4, approx_atan2f(1.0f, -1.0f), 5.0e-6f);
+    EXPECT_NEAR(-3 * M_PI_4, approx_atan2f(-1.0f, -1.0f), 5.0e-6f);
+    EXPECT_NEAR(-M_PI_4, approx_atan2f(-1.0f, 1.0f), 5.0e-6f);
+
+    // large and tiny magnitudes
+    EXPECT_NEAR(atan2f(1.0e6f, 3.0f), approx_atan2f(1.0e6f, 3.0f), 5.0e-6f);
+    EXPECT_NEAR(atan2f(1.0e-6f, -3.0e-6f), approx_atan2f(1.0e-6f, -3.0e-6f), 5.0e-6f);
+}
+
+TEST(FastTrigTest, Asin)
+{
+    float max_error = 0.0f;
+
+    for (int i = -100000; i <= 100000; i++) {
+        const float v = i * 1.0e-5f;
+        const float error = fabsf(approx_asinf(v) - asinf(v));
+        max_error = MAX(max_error, error);
+    }
+    EXPECT_LT(max_error, 1.0e-6f);
+
+    // same out of range handling as safe_asin()
+    EXPECT_FLOAT_EQ(safe_asin(1.5f), approx_asinf(1.5f));
+    EXPECT_FLOAT_EQ(safe_asin(-1.5f), approx_asinf(-1.5f));
+    EXPECT_FLOAT_EQ(0.0f, approx_asinf(NAN));
+    EXPECT_NEAR(safe_asin(0.3f), fast_asinf(0.3f), 1.0e-6f);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,89 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+
+static Location make_location(int32_t lat, int32_t lng)
+{
+    Location loc {};
+    loc.lat = lat;
+    loc.lng = lng;
+    return loc;
+}
+
+TEST(LocationFrameTest, MatchesLocationFunctions)
+{
+    const Location origin = make_location(-353632610, 1491652300);
+    const LocationFrame frame(origin);
+
+    EXPECT_FLOAT_EQ(longitude_scale(origin), frame.get_longitude_scale());
+
+    for (int32_t i = -5; i <= 5; i++) {
+        const Location loc = make_location(origin.lat + i * 17000, origin.lng - i * 23000 + 5000);
+
+        const Vector2f diff = location_diff(origin, loc);
+        const Vector2f ne = frame.get_ne(loc);
+        EXPECT_NEAR(diff.x, ne.x, 1e-3f);
+        EXPECT_NEAR(diff.y, ne.y, 1e-3f);
+
+        // get_distance() scales longitude at loc rather than at the origin
+        const float distance = get_distance(origin, loc);
+        EXPECT_NEAR(distance, frame.get_distance(loc), distance * 1e-4f);
+        EXPECT_NEAR(get_bearing_cd(origin, loc), frame.get_bearing_cd(loc), 1);
+    }
+}
+
+TEST(LocationFrameTest, Batch)
+{
+    const Location origin = make_location(473977420, 85455940);
+    const LocationFrame frame(origin);
+    Location locs[16];
+    Vector2f ne[16];
+
+    for (uint8_t i = 0; i < 16; i++) {
+        locs[i] = make_location(origin.lat + i * 1000 - 8000, origin.lng + i * i * 500);
+    }
+    frame.get_ne(locs, ne, 16);
+
+    for (uint8_t i = 0; i < 16; i++) {
+        const Vector2f single = frame.get_ne(locs[i]);
+        EXPECT_FLOAT_EQ(single.x, ne[i].x);
+        EXPECT_FLOAT_EQ(single.y, ne[i].y);
+    }
+}
+
+TEST(LocationFrameTest, RoundTrip)
+{
+    const Location origin = make_location(600000000, -1500000000);
+    const LocationFrame frame(origin);
+    Location loc = make_location(0, 0);
+
+    frame.get_location(Vector2f(0, 0), loc);
+    EXPECT_EQ(origin.lat, loc.lat);
+    EXPECT_EQ(origin.lng, loc.lng);
+
+    frame.get_location(Vector2f(120.0f, -75.0f), loc);
+    const Vector2f ne = frame.get_ne(loc);
+    EXPECT_NEAR(120.0f, ne.x, 0.02f);
+    EXPECT_NEAR(-75.0f, ne.y, 0.02f);
+
+    Location offset = origin;
+    location_offset(offset, 120.0f, -75.0f);
+    EXPECT_EQ(offset.lat, loc.lat);
+    EXPECT_NEAR(offset.lng, loc.lng, 1);
+}
+
+AP_GTEST_MAIN()
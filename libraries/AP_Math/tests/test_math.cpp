@@ -63,6 +63,39 @@ TEST(VectorTest, Rotations)
     EXPECT_EQ(ROTATION_MAX, rotation_count) << "All rotations are expect to be tested";
 }
 
+TEST(QuaternionTest, Multiplication)
+{
+    Quaternion q1, q2;
+    q1.from_euler(0.1f, 0.2f, 0.3f);
+    q2.from_euler(-0.3f, 0.5f, 1.0f);
+
+    // the product must describe the same rotation as the product of
+    // the rotation matrices
+    Matrix3f m1, m2, m;
+    q1.rotation_matrix(m1);
+    q2.rotation_matrix(m2);
+    (q1 * q2).rotation_matrix(m);
+    Matrix3f expected = m1 * m2;
+
+    EXPECT_NEAR(expected.a.x, m.a.x, 1.0e-6);
+    EXPECT_NEAR(expected.a.y, m.a.y, 1.0e-6);
+    EXPECT_NEAR(expected.a.z, m.a.z, 1.0e-6);
+    EXPECT_NEAR(expected.b.x, m.b.x, 1.0e-6);
+    EXPECT_NEAR(expected.b.y, m.b.y, 1.0e-6);
+    EXPECT_NEAR(expected.b.z, m.b.z, 1.0e-6);
+    EXPECT_NEAR(expected.c.x, m.c.x, 1.0e-6);
+    EXPECT_NEAR(expected.c.y, m.c.y, 1.0e-6);
+    EXPECT_NEAR(expected.c.z, m.c.z, 1.0e-6);
+
+    Quaternion q3 = q1;
+    q3 *= q2;
+    Quaternion q4 = q1 * q2;
+    EXPECT_FLOAT_EQ(q4.q1, q3.q1);
+    EXPECT_FLOAT_EQ(q4.q2, q3.q2);
+    EXPECT_FLOAT_EQ(q4.q3, q3.q3);
+    EXPECT_FLOAT_EQ(q4.q4, q3.q4);
+}
+
 TEST(MathTest, IsZero)
 {
     EXPECT_FALSE(is_zero(0.1));
@@ -96,6 +96,49 @@ TEST_P(Matrix3fTest, Inverses)
     }
 }
 
+TEST(Matrix3fProductTest, Multiplication)
+{
+    const Matrix3f m1{
+        {1.0f,  2.0f,  3.0f},
+        {4.0f,  6.0f,  2.0f},
+        {9.0f, 18.0f, 27.0f}
+    };
+    const Matrix3f m2{
+        { 6.0f,  2.0f,  20.0f},
+        { 1.0f, -9.0f,   4.0f},
+        {-4.0f,  7.0f, -27.0f}
+    };
+
+    Matrix3f m = m1 * m2;
+
+    EXPECT_FLOAT_EQ(-4.0f, m.a.x);
+    EXPECT_FLOAT_EQ(5.0f, m.a.y);
+    EXPECT_FLOAT_EQ(-53.0f, m.a.z);
+    EXPECT_FLOAT_EQ(22.0f, m.b.x);
+    EXPECT_FLOAT_EQ(-32.0f, m.b.y);
+    EXPECT_FLOAT_EQ(50.0f, m.b.z);
+    EXPECT_FLOAT_EQ(-36.0f, m.c.x);
+    EXPECT_FLOAT_EQ(45.0f, m.c.y);
+    EXPECT_FLOAT_EQ(-477.0f, m.c.z);
+}
+
+TEST(Matrix3fProductTest, MulTranspose)
+{
+    const Matrix3f m{
+        { 6.0f,  2.0f,  20.0f},
+        { 1.0f, -9.0f,   4.0f},
+        {-4.0f,  7.0f, -27.0f}
+    };
+    const Vector3f v(1.0f, -2.0f, 3.0f);
+
+    Vector3f r1 = m.mul_transpose(v);
+    Vector3f r2 = m.transposed() * v;
+
+    EXPECT_FLOAT_EQ(r2.x, r1.x);
+    EXPECT_FLOAT_EQ(r2.y, r1.y);
+    EXPECT_FLOAT_EQ(r2.z, r1.z);
+}
+
 INSTANTIATE_TEST_CASE_P(InvertibleMatrices,
                         Matrix3fTest,
                         ::testing::ValuesIn(invertible));
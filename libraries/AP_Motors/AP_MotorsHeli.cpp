@@ -243,6 +243,9 @@ void AP_MotorsHeli::output()
     } else {
         output_disarmed();
     }
+
+    // measure the latency from the input sample to the outputs
+    update_output_latency();
 };
 
 // sends commands to the motors
@@ -19,8 +19,13 @@
  *
  */
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Math/simd.h>
 #include "AP_MotorsMatrix.h"
 
+#if AP_MATH_ALLOW_SIMD
+static_assert(AP_MOTORS_MAX_NUM_MOTORS % 4 == 0, "mixing matrix must be a whole number of ap_float4");
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 // init
@@ -163,7 +168,7 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     float   rpy_low = 0.0f;             // lowest motor value
     float   rpy_high = 0.0f;            // highest motor value
     float   yaw_allowed = 1.0f;         // amount of yaw we can fit in
-    float   unused_range;               // amount of yaw we can fit in the current channel
+    float   rpy_out[AP_MOTORS_MAX_NUM_MOTORS];      // roll, pitch and yaw output of each entry of the mixing matrix
     float   thr_adj;                    // the difference between the pilot's desired throttle and throttle_thrust_best_rpy
 
     // apply voltage and air pressure compensation
@@ -201,24 +206,37 @@ void AP_MotorsMatrix::output_armed_stabilizing()
 
     // calculate roll and pitch for each motor
     // calculate the amount of yaw input that each motor can accept
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
-            if (!is_zero(_yaw_factor[i])){
-                if (yaw_thrust * _yaw_factor[i] > 0.0f) {
-                    unused_range = fabsf((1.0f - (throttle_thrust_best_rpy + _thrust_rpyt_out[i]))/_yaw_factor[i]);
-                    if (yaw_allowed > unused_range) {
-                        yaw_allowed = unused_range;
-                    }
-                } else {
-                    unused_range = fabsf((throttle_thrust_best_rpy + _thrust_rpyt_out[i])/_yaw_factor[i]);
-                    if (yaw_allowed > unused_range) {
-                        yaw_allowed = unused_range;
-                    }
-                }
+    // this runs over every entry of the packed mixing matrix without
+    // branching. Entries past _mix.count have zero factors and leave the
+    // results unchanged
+#if AP_MATH_ALLOW_SIMD
+    {
+        const ap_float4 one = ap_float4_splat(1.0f);
+        const ap_float4 best = ap_float4_splat(throttle_thrust_best_rpy);
+        ap_float4 allowed = one;
+        for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i+=4) {
+            const ap_float4 rp = ap_float4_splat(roll_thrust) * ap_float4_load(&_mix.roll[i]) + ap_float4_splat(pitch_thrust) * ap_float4_load(&_mix.pitch[i]);
+            const ap_float4 headroom = ap_float4_select(ap_float4_splat(yaw_thrust) * ap_float4_load(&_mix.yaw[i]) > ap_float4_splat(0.0f), one - (best + rp), best + rp);
+            const ap_float4 unused = ap_float4_select(ap_float4_load(&_mix.yaw_used[i]) > ap_float4_splat(0.0f), ap_float4_abs(headroom / ap_float4_load(&_mix.yaw_div[i])), one);
+            allowed = ap_float4_min(unused, allowed);
+            ap_float4_store(&rpy_out[i], rp);
+        }
+        for (i=0; i<4; i++) {
+            if (yaw_allowed > allowed[i]) {
+                yaw_allowed = allowed[i];
             }
         }
     }
+#else
+    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        rpy_out[i] = roll_thrust * _mix.roll[i] + pitch_thrust * _mix.pitch[i];
+        const float headroom = (yaw_thrust * _mix.yaw[i] > 0.0f) ? 1.0f - (throttle_thrust_best_rpy + rpy_out[i]) : throttle_thrust_best_rpy + rpy_out[i];
+        const float unused_range = (_mix.yaw_used[i] > 0.0f) ? fabsf(headroom/_mix.yaw_div[i]) : 1.0f;
+        if (yaw_allowed > unused_range) {
+            yaw_allowed = unused_range;
+        }
+    }
+#endif
 
     // todo: make _yaw_headroom 0 to 1
     yaw_allowed = MAX(yaw_allowed, (float)_yaw_headroom/1000.0f);
@@ -231,20 +249,39 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // add yaw to intermediate numbers for each motor
     rpy_low = 0.0f;
     rpy_high = 0.0f;
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
-
-            // record lowest roll+pitch+yaw command
-            if (_thrust_rpyt_out[i] < rpy_low) {
-                rpy_low = _thrust_rpyt_out[i];
+#if AP_MATH_ALLOW_SIMD
+    {
+        ap_float4 low = ap_float4_splat(0.0f);
+        ap_float4 high = ap_float4_splat(0.0f);
+        for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i+=4) {
+            const ap_float4 rpy = ap_float4_load(&rpy_out[i]) + ap_float4_splat(yaw_thrust) * ap_float4_load(&_mix.yaw[i]);
+            low = ap_float4_min(rpy, low);
+            high = ap_float4_max(rpy, high);
+            ap_float4_store(&rpy_out[i], rpy);
+        }
+        for (i=0; i<4; i++) {
+            if (low[i] < rpy_low) {
+                rpy_low = low[i];
             }
-            // record highest roll+pitch+yaw command
-            if (_thrust_rpyt_out[i] > rpy_high) {
-                rpy_high = _thrust_rpyt_out[i];
+            if (high[i] > rpy_high) {
+                rpy_high = high[i];
             }
         }
     }
+#else
+    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        rpy_out[i] = rpy_out[i] + yaw_thrust * _mix.yaw[i];
+
+        // record lowest roll+pitch+yaw command
+        if (rpy_out[i] < rpy_low) {
+            rpy_low = rpy_out[i];
+        }
+        // record highest roll+pitch+yaw command
+        if (rpy_out[i] > rpy_high) {
+            rpy_high = rpy_out[i];
+        }
+    }
+#endif
 
     // check everything fits
     throttle_thrust_best_rpy = MIN(0.5f - (rpy_low+rpy_high)/2.0, _throttle_avg_max);
@@ -276,18 +313,9 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     }
 
     // add scaled roll, pitch, constrained yaw and throttle for each motor
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = throttle_thrust_best_rpy + thr_adj + rpy_scale*_thrust_rpyt_out[i];
-        }
-    }
-
-    // constrain all outputs to 0.0f to 1.0f
-    // test code should be run with these lines commented out as they should not do anything
-    for (i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = constrain_float(_thrust_rpyt_out[i], 0.0f, 1.0f);
-        }
+    // and constrain all outputs to 0.0f to 1.0f
+    for (i=0; i<_mix.count; i++) {
+        _thrust_rpyt_out[_mix.motor[i]] = constrain_float(throttle_thrust_best_rpy + thr_adj + rpy_scale*rpy_out[i], 0.0f, 1.0f);
     }
 }
 
@@ -333,6 +361,8 @@ void AP_MotorsMatrix::add_motor_raw(int8_t motor_num, float roll_fac, float pitc
 
         // call parent class method
         add_motor_num(motor_num);
+
+        update_mix_matrix();
     }
 }
 
@@ -363,6 +393,8 @@ void AP_MotorsMatrix::remove_motor(int8_t motor_num)
         _roll_factor[motor_num] = 0;
         _pitch_factor[motor_num] = 0;
         _yaw_factor[motor_num] = 0;
+
+        update_mix_matrix();
     }
 }
 
@@ -647,6 +679,33 @@ void AP_MotorsMatrix::normalise_rpy_factors()
             }
         }
     }
+
+    update_mix_matrix();
+}
+
+// update_mix_matrix - packs the factors of the enabled motors for output_armed_stabilizing
+void AP_MotorsMatrix::update_mix_matrix()
+{
+    memset(&_mix, 0, sizeof(_mix));
+
+    // unused entries divide by one so the mixer never divides by zero
+    for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        _mix.yaw_div[i] = 1.0f;
+    }
+
+    for (uint8_t i=0; i<AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            const uint8_t j = _mix.count++;
+            _mix.roll[j] = _roll_factor[i];
+            _mix.pitch[j] = _pitch_factor[i];
+            _mix.yaw[j] = _yaw_factor[i];
+            if (!is_zero(_yaw_factor[i])) {
+                _mix.yaw_div[j] = _yaw_factor[i];
+                _mix.yaw_used[j] = 1.0f;
+            }
+            _mix.motor[j] = i;
+        }
+    }
 }
 
 
@@ -17,7 +17,9 @@ public:
     /// Constructor
     AP_MotorsMatrix(uint16_t loop_rate, uint16_t speed_hz = AP_MOTORS_SPEED_DEFAULT) :
         AP_MotorsMulticopter(loop_rate, speed_hz)
-    {};
+    {
+        update_mix_matrix();
+    };
 
     // init
     void                init(motor_frame_class frame_class, motor_frame_type frame_type);
@@ -66,6 +68,9 @@ protected:
     // normalizes the roll, pitch and yaw factors so maximum magnitude is 0.5
     void                normalise_rpy_factors();
 
+    // rebuilds the packed mixing matrix from the per motor factors
+    void                update_mix_matrix();
+
     // call vehicle supplied thrust compensation if set
     void                thrust_compensation(void) override;
     
@@ -74,6 +79,19 @@ protected:
     float               _yaw_factor[AP_MOTORS_MAX_NUM_MOTORS];  // each motors contribution to yaw (normally 1 or -1)
     float               _thrust_rpyt_out[AP_MOTORS_MAX_NUM_MOTORS]; // combined roll, pitch, yaw and throttle outputs to motors in 0~1 range
     uint8_t             _test_order[AP_MOTORS_MAX_NUM_MOTORS];  // order of the motors in the test sequence
+
+    // mixing matrix packed to hold the enabled motors only, in motor order.
+    // Entries past count are zero so the mixer can always run over
+    // AP_MOTORS_MAX_NUM_MOTORS entries without checking motor_enabled
+    struct {
+        float           roll[AP_MOTORS_MAX_NUM_MOTORS];
+        float           pitch[AP_MOTORS_MAX_NUM_MOTORS];
+        float           yaw[AP_MOTORS_MAX_NUM_MOTORS];
+        float           yaw_div[AP_MOTORS_MAX_NUM_MOTORS];  // yaw factor, 1 if it is zero
+        float           yaw_used[AP_MOTORS_MAX_NUM_MOTORS]; // 1 if the yaw factor is not zero, 0 otherwise
+        uint8_t         motor[AP_MOTORS_MAX_NUM_MOTORS];    // output channel of each entry
+        uint8_t         count;                              // number of enabled motors
+    } _mix;
     motor_frame_class   _last_frame_class; // most recently requested frame class (i.e. quad, hexa, octa, etc)
     motor_frame_type    _last_frame_type; // most recently requested frame type (i.e. plus, x, v, etc)
 };
@@ -207,6 +207,9 @@ void AP_MotorsMulticopter::output()
     
     // convert rpy_thrust values to pwm
     output_to_motors();
+
+    // measure the latency from the input sample to the outputs
+    update_output_latency();
 };
 
 // sends minimum values out to the motors
@@ -40,7 +40,10 @@ AP_Motors::AP_Motors(uint16_t loop_rate, uint16_t speed_hz) :
     _batt_current(0.0f),
     _air_density_ratio(1.0f),
     _motor_map_mask(0),
-    _motor_fast_mask(0)
+    _motor_fast_mask(0),
+    _input_sample_us(0),
+    _output_latency_post_us(0),
+    _output_latency_max_reset(false)
 {
     // init other flags
     _flags.armed = false;
@@ -207,3 +210,33 @@ void AP_Motors::add_motor_num(int8_t motor_num)
         }
     }
 }
+
+/*
+  add the latency from the input sample to the outputs pushed by output()
+ */
+void AP_Motors::update_output_latency()
+{
+    if (_input_sample_us == 0) {
+        return;
+    }
+
+    if (_output_latency_max_reset.exchange(false)) {
+        _output_latency.max_us = 0;
+    }
+    const uint64_t now_us = AP_HAL::micros64();
+    _output_latency.add(now_us - _input_sample_us);
+    _input_sample_us = 0;
+
+    // the reader only looks at it every few seconds: don't copy the
+    // histogram on each output
+    if (now_us - _output_latency_post_us >= AP_MOTORS_LATENCY_POST_US) {
+        _output_latency_mailbox.post(_output_latency);
+        _output_latency_post_us = now_us;
+    }
+}
+
+void AP_Motors::get_output_latency(LatencyHistogram &latency)
+{
+    _output_latency_mailbox.fetch(latency);
+    _output_latency_max_reset = true;
+}
@@ -5,6 +5,10 @@
 #include <AP_Notify/AP_Notify.h>      // Notify library
 #include <SRV_Channel/SRV_Channel.h>
 #include <Filter/Filter.h>         // filter library
+#include <AP_HAL/utility/LatencyHistogram.h>
+#include <AP_HAL/utility/Mailbox.h>
+
+#include <atomic>
 
 // offsets for motors in motor_out and _motor_filtered arrays
 #define AP_MOTORS_MOT_1 0U
@@ -21,6 +25,10 @@
 // motor update rate
 #define AP_MOTORS_SPEED_DEFAULT     490 // default output rate to the motors
 
+// minimum time between two copies of the output latency histogram handed
+// over to get_output_latency()
+#define AP_MOTORS_LATENCY_POST_US   100000
+
 /// @class      AP_Motors
 class AP_Motors {
 public:
@@ -146,6 +154,17 @@ public:
     // set loop rate. Used to support loop rate as a parameter
     void                set_loop_rate(uint16_t loop_rate) { _loop_rate = loop_rate; }
 
+    // set the time the gyro sample the next output is computed from was
+    // taken, to measure the latency from that sample to the outputs. Zero
+    // if the next output isn't computed from a new sample
+    void                set_input_sample_us(uint64_t sample_us) { _input_sample_us = sample_us; }
+
+    // get the histogram of the latency from the input samples to the
+    // outputs, as of up to AP_MOTORS_LATENCY_POST_US ago. The counts are
+    // cumulative and the max is the one since the previous call. May be
+    // called from a different thread than output()
+    void                get_output_latency(LatencyHistogram &latency);
+
     enum pwm_type { PWM_TYPE_NORMAL=0, PWM_TYPE_ONESHOT=1, PWM_TYPE_ONESHOT125=2, PWM_TYPE_BRUSHED16kHz=3 };
     pwm_type            get_pwm_type(void) const { return (pwm_type)_pwm_type.get(); }
     
@@ -172,6 +191,9 @@ protected:
     // convert input in 0 to +1 range to pwm output
     int16_t calc_pwm_output_0to1(float input, const SRV_Channel *servo);
 
+    // account for the latency of the outputs just pushed
+    void update_output_latency();
+
     // flag bitmask
     struct AP_Motors_flags {
         uint8_t armed              : 1;    // 0 if disarmed, 1 if armed
@@ -207,4 +229,12 @@ protected:
     float _yaw_radio_passthrough = 0.0f;      // yaw input from pilot in -1 ~ +1 range.  used for setup and providing servo feedback while landed
 
     AP_Int8             _pwm_type;            // PWM output type
+
+    // latency from the input samples to the outputs, owned by the thread
+    // calling output() and handed over through the mailbox
+    uint64_t            _input_sample_us;
+    uint64_t            _output_latency_post_us;
+    LatencyHistogram    _output_latency;
+    ObjectMailbox<LatencyHistogram> _output_latency_mailbox;
+    std::atomic<bool>   _output_latency_max_reset;
 };
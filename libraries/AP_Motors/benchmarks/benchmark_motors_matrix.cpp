@@ -0,0 +1,64 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Motors/AP_MotorsMatrix.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class AP_MotorsMatrix_Bench : public AP_MotorsMatrix
+{
+public:
+    AP_MotorsMatrix_Bench() : AP_MotorsMatrix(400) { }
+
+    void setup(motor_frame_class frame_class, motor_frame_type frame_type)
+    {
+        setup_motors(frame_class, frame_type);
+        _throttle_thrust_max = 1.0f;
+        _throttle_filter.reset(0.5f);
+    }
+
+    void mix(float roll, float pitch, float yaw)
+    {
+        _roll_in = roll;
+        _pitch_in = pitch;
+        _yaw_in = yaw;
+        _throttle_avg_max = 0.5f;
+        output_armed_stabilizing();
+        gbenchmark_escape(_thrust_rpyt_out);
+    }
+};
+
+static void BM_MotorsMatrixMix(benchmark::State& state,
+                               AP_Motors::motor_frame_class frame_class,
+                               AP_Motors::motor_frame_type frame_type)
+{
+    AP_MotorsMatrix_Bench motors;
+    float f = 0.0f;
+
+    motors.setup(frame_class, frame_type);
+
+    while (state.KeepRunning()) {
+        motors.mix(0.3f + f, -0.2f, 0.1f - f);
+        f = f > 0.1f ? 0.0f : f + 0.01f;
+    }
+}
+
+static void BM_MotorsMatrixMixQuadX(benchmark::State& state)
+{
+    BM_MotorsMatrixMix(state, AP_Motors::MOTOR_FRAME_QUAD, AP_Motors::MOTOR_FRAME_TYPE_X);
+}
+
+static void BM_MotorsMatrixMixHexaX(benchmark::State& state)
+{
+    BM_MotorsMatrixMix(state, AP_Motors::MOTOR_FRAME_HEXA, AP_Motors::MOTOR_FRAME_TYPE_X);
+}
+
+static void BM_MotorsMatrixMixOctaX(benchmark::State& state)
+{
+    BM_MotorsMatrixMix(state, AP_Motors::MOTOR_FRAME_OCTA, AP_Motors::MOTOR_FRAME_TYPE_X);
+}
+
+BENCHMARK(BM_MotorsMatrixMixQuadX);
+BENCHMARK(BM_MotorsMatrixMixHexaX);
+BENCHMARK(BM_MotorsMatrixMixOctaX);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,271 @@
+#include <AP_gtest.h>
+
+#include <AP_Motors/AP_MotorsMatrix.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class AP_MotorsMatrix_Test : public AP_MotorsMatrix
+{
+public:
+    AP_MotorsMatrix_Test() : AP_MotorsMatrix(400) { }
+
+    bool setup(motor_frame_class frame_class, motor_frame_type frame_type)
+    {
+        setup_motors(frame_class, frame_type);
+        return initialised_ok();
+    }
+
+    uint8_t num_motors() const
+    {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    void set_inputs(float roll, float pitch, float yaw, float throttle,
+                    float throttle_avg_max, int16_t yaw_headroom)
+    {
+        _roll_in = roll;
+        _pitch_in = pitch;
+        _yaw_in = yaw;
+        _throttle_filter.reset(throttle);
+        _throttle_avg_max = throttle_avg_max;
+        _throttle_thrust_max = 1.0f;
+        _yaw_headroom.set(yaw_headroom);
+        memset(&limit, 0, sizeof(limit));
+    }
+
+    void mix(float out[AP_MOTORS_MAX_NUM_MOTORS], AP_Motors_limit &lim)
+    {
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            _thrust_rpyt_out[i] = -1.0f;
+        }
+        output_armed_stabilizing();
+        memcpy(out, _thrust_rpyt_out, sizeof(_thrust_rpyt_out));
+        lim = limit;
+    }
+
+    /*
+      the mixer as it was before the packed mixing matrix was introduced,
+      running over all outputs and skipping the disabled ones
+     */
+    void mix_reference(float out[AP_MOTORS_MAX_NUM_MOTORS], AP_Motors_limit &lim)
+    {
+        uint8_t i;
+        float   roll_thrust;
+        float   pitch_thrust;
+        float   yaw_thrust;
+        float   throttle_thrust;
+        float   throttle_thrust_best_rpy;
+        float   rpy_scale = 1.0f;
+        float   rpy_low = 0.0f;
+        float   rpy_high = 0.0f;
+        float   yaw_allowed = 1.0f;
+        float   unused_range;
+        float   thr_adj;
+
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            out[i] = -1.0f;
+        }
+
+        roll_thrust = _roll_in * get_compensation_gain();
+        pitch_thrust = _pitch_in * get_compensation_gain();
+        yaw_thrust = _yaw_in * get_compensation_gain();
+        throttle_thrust = get_throttle() * get_compensation_gain();
+
+        if (throttle_thrust <= 0.0f) {
+            throttle_thrust = 0.0f;
+            limit.throttle_lower = true;
+        }
+        if (throttle_thrust >= _throttle_thrust_max) {
+            throttle_thrust = _throttle_thrust_max;
+            limit.throttle_upper = true;
+        }
+
+        _throttle_avg_max = constrain_float(_throttle_avg_max, throttle_thrust, _throttle_thrust_max);
+
+        throttle_thrust_best_rpy = MIN(0.5f, _throttle_avg_max);
+
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
+                if (!is_zero(_yaw_factor[i])) {
+                    if (yaw_thrust * _yaw_factor[i] > 0.0f) {
+                        unused_range = fabsf((1.0f - (throttle_thrust_best_rpy + out[i]))/_yaw_factor[i]);
+                        if (yaw_allowed > unused_range) {
+                            yaw_allowed = unused_range;
+                        }
+                    } else {
+                        unused_range = fabsf((throttle_thrust_best_rpy + out[i])/_yaw_factor[i]);
+                        if (yaw_allowed > unused_range) {
+                            yaw_allowed = unused_range;
+                        }
+                    }
+                }
+            }
+        }
+
+        yaw_allowed = MAX(yaw_allowed, (float)_yaw_headroom/1000.0f);
+
+        if (fabsf(yaw_thrust) > yaw_allowed) {
+            yaw_thrust = constrain_float(yaw_thrust, -yaw_allowed, yaw_allowed);
+            limit.yaw = true;
+        }
+
+        rpy_low = 0.0f;
+        rpy_high = 0.0f;
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                out[i] = out[i] + yaw_thrust * _yaw_factor[i];
+                if (out[i] < rpy_low) {
+                    rpy_low = out[i];
+                }
+                if (out[i] > rpy_high) {
+                    rpy_high = out[i];
+                }
+            }
+        }
+
+        throttle_thrust_best_rpy = MIN(0.5f - (rpy_low+rpy_high)/2.0, _throttle_avg_max);
+        if (is_zero(rpy_low)) {
+            rpy_scale = 1.0f;
+        } else {
+            rpy_scale = constrain_float(-throttle_thrust_best_rpy/rpy_low, 0.0f, 1.0f);
+        }
+
+        thr_adj = throttle_thrust - throttle_thrust_best_rpy;
+        if (rpy_scale < 1.0f) {
+            limit.roll_pitch = true;
+            limit.yaw = true;
+            if (thr_adj > 0.0f) {
+                limit.throttle_upper = true;
+            }
+            thr_adj = 0.0f;
+        } else {
+            if (thr_adj < -(throttle_thrust_best_rpy+rpy_low)) {
+                thr_adj = -(throttle_thrust_best_rpy+rpy_low);
+            } else if (thr_adj > 1.0f - (throttle_thrust_best_rpy+rpy_high)) {
+                thr_adj = 1.0f - (throttle_thrust_best_rpy+rpy_high);
+                limit.throttle_upper = true;
+            }
+        }
+
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                out[i] = throttle_thrust_best_rpy + thr_adj + rpy_scale*out[i];
+            }
+        }
+
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                out[i] = constrain_float(out[i], 0.0f, 1.0f);
+            }
+        }
+
+        lim = limit;
+    }
+};
+
+static uint32_t float_bits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static const AP_Motors::motor_frame_class frame_classes[] = {
+    AP_Motors::MOTOR_FRAME_QUAD,
+    AP_Motors::MOTOR_FRAME_HEXA,
+    AP_Motors::MOTOR_FRAME_OCTA,
+    AP_Motors::MOTOR_FRAME_OCTAQUAD,
+    AP_Motors::MOTOR_FRAME_Y6,
+};
+
+static const AP_Motors::motor_frame_type frame_types[] = {
+    AP_Motors::MOTOR_FRAME_TYPE_PLUS,
+    AP_Motors::MOTOR_FRAME_TYPE_X,
+    AP_Motors::MOTOR_FRAME_TYPE_V,
+    AP_Motors::MOTOR_FRAME_TYPE_H,
+    AP_Motors::MOTOR_FRAME_TYPE_VTAIL,
+    AP_Motors::MOTOR_FRAME_TYPE_ATAIL,
+    AP_Motors::MOTOR_FRAME_TYPE_Y6B,
+};
+
+static const float axis_inputs[] = {
+    -1.0f, -0.7f, -0.25f, -0.01f, 0.0f, 0.003f, 0.1f, 0.4f, 0.9f, 1.0f
+};
+
+static const float throttle_inputs[] = {
+    0.0f, 0.05f, 0.3f, 0.5f, 0.75f, 1.0f
+};
+
+static void check_mix(AP_MotorsMatrix_Test &motors, float roll, float pitch,
+                      float yaw, float throttle, float throttle_avg_max,
+                      int16_t yaw_headroom)
+{
+    float expected[AP_MOTORS_MAX_NUM_MOTORS];
+    float out[AP_MOTORS_MAX_NUM_MOTORS];
+    AP_Motors::AP_Motors_limit expected_limit;
+    AP_Motors::AP_Motors_limit out_limit;
+
+    motors.set_inputs(roll, pitch, yaw, throttle, throttle_avg_max, yaw_headroom);
+    motors.mix_reference(expected, expected_limit);
+    motors.set_inputs(roll, pitch, yaw, throttle, throttle_avg_max, yaw_headroom);
+    motors.mix(out, out_limit);
+
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        ASSERT_EQ(float_bits(expected[i]), float_bits(out[i]))
+            << "motor " << (unsigned)i << " rpyt " << roll << " " << pitch
+            << " " << yaw << " " << throttle << " avg max " << throttle_avg_max
+            << " headroom " << yaw_headroom;
+    }
+    ASSERT_EQ(expected_limit.roll_pitch, out_limit.roll_pitch);
+    ASSERT_EQ(expected_limit.yaw, out_limit.yaw);
+    ASSERT_EQ(expected_limit.throttle_lower, out_limit.throttle_lower);
+    ASSERT_EQ(expected_limit.throttle_upper, out_limit.throttle_upper);
+}
+
+TEST(AP_MotorsMatrixTest, MixingMatchesReference)
+{
+    static const int16_t yaw_headrooms[] = { 0, 200, 1000 };
+    AP_MotorsMatrix_Test motors;
+    unsigned frame_count = 0;
+
+    for (const auto frame_class : frame_classes) {
+        for (const auto frame_type : frame_types) {
+            if (!motors.setup(frame_class, frame_type)) {
+                continue;
+            }
+            frame_count++;
+            SCOPED_TRACE(testing::Message() << "class " << frame_class << " type " << frame_type);
+            ASSERT_GT(motors.num_motors(), 0);
+
+            for (const float roll : axis_inputs) {
+                for (const float pitch : axis_inputs) {
+                    for (const float yaw : axis_inputs) {
+                        for (const float throttle : throttle_inputs) {
+                            for (const float avg_max : throttle_inputs) {
+                                for (const int16_t yaw_headroom : yaw_headrooms) {
+                                    check_mix(motors, roll, pitch, yaw, throttle, avg_max, yaw_headroom);
+                                    if (HasFatalFailure()) {
+                                        return;
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // quad: plus, x, v, h, vtail, atail. hexa: plus, x. octa: plus, x, v.
+    // octaquad: plus, x, v, h. y6: y6b, any other type gets the default layout
+    EXPECT_EQ(22U, frame_count);
+}
+
+AP_GTEST_MAIN()
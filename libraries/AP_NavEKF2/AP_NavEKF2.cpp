@@ -6,6 +6,14 @@
 #include <GCS_MAVLink/GCS.h>
 #include <DataFlash/DataFlash.h>
 
+#if EK2_CORE_THREADS
+#include <stdio.h>
+#include <AP_HAL_Linux/Scheduler.h>
+#include <AP_HAL_Linux/Thread.h>
+
+#define EK2_CORE_THREAD_PRIO 12
+#endif
+
 /*
   parameter defaults for different types of vehicle. The
   APM_BUILD_DIRECTORY is taken from the main vehicle directory name
@@ -527,6 +535,14 @@ const AP_Param::GroupInfo NavEKF2::var_info[] = {
     // @Units: m/s
     AP_GROUPINFO("RNG_USE_SPD", 47, NavEKF2, _useRngSwSpd, 2.0f),
 
+    // @Param: THREADS
+    // @DisplayName: Run the EKF cores on their own threads
+    // @Description: On Linux boards running more than one core, this runs the prediction and fusion step of each core concurrently on its own thread instead of one after the other on the main thread. The results are identical. The priority and CPU of the thread running core N can be set with the --thread ap-ekf2-N:PRIO:CPU command line option.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    // @RebootRequired: True
+    AP_GROUPINFO("THREADS", 48, NavEKF2, _coreThreads, 0),
+
     AP_GROUPEND
 };
 
@@ -652,6 +668,12 @@ bool NavEKF2::InitialiseFilter(void)
 
         // Set the primary initially to be the lowest index
         primary = 0;
+
+#if EK2_CORE_THREADS
+        if (_coreThreads == 1 && num_cores > 1) {
+            start_core_threads();
+        }
+#endif
     }
 
     // initialse the cores. We return success only if all cores
@@ -682,6 +704,9 @@ void NavEKF2::UpdateFilter(void)
     const AP_InertialSensor &ins = _ahrs->get_ins();
 
     bool statePredictEnabled[num_cores];
+#if EK2_CORE_THREADS
+    bool updateStates[num_cores];
+#endif
     for (uint8_t i=0; i<num_cores; i++) {
         // if the previous core has only recently finished a new state prediction cycle, then
         // don't start a new cycle to allow time for fusion operations to complete if the update
@@ -691,9 +716,58 @@ void NavEKF2::UpdateFilter(void)
         } else {
             statePredictEnabled[i] = true;
         }
+#if EK2_CORE_THREADS
+        if (core_threads != nullptr) {
+            // predict and fuse on the thread of the core while the next
+            // cores read their inputs. The first core runs on this thread
+            // once all the others have started
+            updateStates[i] = core[i].UpdateFilterInputs(statePredictEnabled[i]);
+            if (i > 0 && updateStates[i]) {
+                core_threads[i-1]->run();
+            }
+            continue;
+        }
+#endif
         core[i].UpdateFilter(statePredictEnabled[i]);
     }
 
+#if EK2_CORE_THREADS
+    if (core_threads != nullptr) {
+        if (updateStates[0]) {
+            core[0].UpdateFilterStates();
+        }
+        for (uint8_t i=1; i<num_cores; i++) {
+            if (updateStates[i]) {
+                core_threads[i-1]->wait();
+            }
+        }
+    }
+#endif
+
+    // the logging flags are bitfields sharing a byte, so they are only
+    // written here once all the cores have run
+    if (logging.enabled) {
+        bool log_compass = logging.log_compass;
+        bool log_gps = logging.log_gps;
+        bool log_baro = logging.log_baro;
+        bool log_imu = logging.log_imu;
+        for (uint8_t i=0; i<num_cores; i++) {
+            core[i].collectLogFlags(log_compass, log_gps, log_baro, log_imu);
+        }
+        logging.log_compass = log_compass;
+        logging.log_gps = log_gps;
+        logging.log_baro = log_baro;
+        logging.log_imu = log_imu;
+    }
+
+    // applied once all the cores have run, so that they all used the same
+    // setting on this frame, see calcGpsGoodToAlign()
+    if (gpsNoVertVel) {
+        gpsNoVertVel = false;
+        _fusionModeGPS.set(1);
+        GCS_MAVLINK::send_statustext_all(MAV_SEVERITY_WARNING, "EK2: Changed EK2_GPS_TYPE to 1");
+    }
+
     // If the current core selected has a bad error score or is unhealthy, switch to a healthy core with the lowest fault score
     // Don't start running the check until the primary core has started returned healthy for at least 10 seconds to avoid switching
     // due to initial alignment fluctuations and race conditions
@@ -736,6 +810,69 @@ void NavEKF2::UpdateFilter(void)
     check_log_write();
 }
 
+#if EK2_CORE_THREADS
+/*
+  start a thread for each core but the first one. The cores only share
+  read-only data while they predict and fuse, so running them concurrently
+  gives the same results as running them in turn
+ */
+void NavEKF2::start_core_threads(void)
+{
+    core_threads_sem = hal.util->new_semaphore();
+    if (core_threads_sem == nullptr) {
+        return;
+    }
+
+    Linux::WorkerThread **threads = new Linux::WorkerThread *[num_cores-1] {};
+    if (threads == nullptr) {
+        return;
+    }
+
+    for (uint8_t i=1; i<num_cores; i++) {
+        threads[i-1] = new Linux::WorkerThread(FUNCTOR_BIND(&core[i], &NavEKF2_core::UpdateFilterStates, void));
+        if (threads[i-1] == nullptr) {
+            for (uint8_t j=1; j<i; j++) {
+                delete threads[j-1];
+            }
+            delete[] threads;
+            return;
+        }
+    }
+
+    for (uint8_t i=1; i<num_cores; i++) {
+        char name[16];
+        int prio = EK2_CORE_THREAD_PRIO;
+        int cpu = -1;
+
+        snprintf(name, sizeof(name), "ap-ekf2-%u", (unsigned)i);
+        Linux::Scheduler::from(hal.scheduler)->get_thread_params(name, prio, cpu);
+        threads[i-1]->set_cpu_affinity(cpu);
+        threads[i-1]->start(name, SCHED_FIFO, prio);
+    }
+
+    core_threads = threads;
+}
+#endif
+
+void NavEKF2::send_status_text(MAV_SEVERITY severity, const char *fmt, ...) const
+{
+    char text[MAVLINK_MSG_STATUSTEXT_FIELD_TEXT_LEN+1] {};
+    va_list arg_list;
+    va_start(arg_list, fmt);
+    hal.util->vsnprintf(text, sizeof(text), fmt, arg_list);
+    va_end(arg_list);
+
+#if EK2_CORE_THREADS
+    if (core_threads_sem != nullptr && core_threads_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        GCS_MAVLINK::send_statustext_all(severity, "%s", text);
+        core_threads_sem->give();
+        return;
+    }
+#endif
+
+    GCS_MAVLINK::send_statustext_all(severity, "%s", text);
+}
+
 // Check basic filter health metrics and return a consolidated health status
 bool NavEKF2::healthy(void) const
 {
@@ -28,9 +28,20 @@
 #include <AP_Compass/AP_Compass.h>
 #include <AP_RangeFinder/AP_RangeFinder.h>
 
+#include <atomic>
+
 class NavEKF3_core;
 class AP_AHRS;
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define EK3_CORE_THREADS 1
+namespace Linux {
+class WorkerThread;
+}
+#else
+#define EK3_CORE_THREADS 0
+#endif
+
 class NavEKF3
 {
 public:
@@ -357,6 +368,7 @@ private:
     AP_Int8  _rngBcnDelay_ms;       // effective average delay of range beacon measurements rel to IMU (msec)
     AP_Float _useRngSwSpd;          // Maximum horizontal ground speed to use range finder as the primary height source (m/s)
     AP_Float _accBiasLim;           // Accelerometer bias limit (m/s/s)
+    AP_Int8 _coreThreads;           // 1 to run the cores concurrently on their own threads
 
     // Tuning parameters
     const float gpsNEVelVarAccScale;    // Scale factor applied to NE velocity measurement variance due to manoeuvre acceleration
@@ -397,6 +409,23 @@ private:
     // time at start of current filter update
     uint64_t imuSampleTime_us;
 
+    // set by a core when the GPS has a 3D fix but no vertical velocity,
+    // so that the frontend switches to EK3_GPS_TYPE 1 after all the cores
+    // have run with the same setting
+    std::atomic<bool> gpsNoVertVel {false};
+
+#if EK3_CORE_THREADS
+    // threads running UpdateFilterStates() of all the cores but the first
+    // one, which runs on the caller thread
+    Linux::WorkerThread **core_threads = nullptr;
+    AP_HAL::Semaphore *core_threads_sem = nullptr;
+    void start_core_threads(void);
+#endif
+
+    // send a status text from a core, serialised when the cores run on
+    // their own threads
+    void send_status_text(MAV_SEVERITY severity, const char *fmt, ...) const FMT_PRINTF(3, 4);
+
     struct {
         uint32_t last_function_call;  // last time getLastYawYawResetAngle was called
         bool core_changed;            // true when a core change happened and hasn't been consumed, false otherwise
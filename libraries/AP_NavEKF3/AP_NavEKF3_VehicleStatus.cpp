@@ -87,8 +87,7 @@ bool NavEKF3_core::calcGpsGoodToAlign(void)
         // EK2_GPS_TYPE=0 then change it to 1. It means the GPS is not
         // capable of giving a vertical velocity
         if (_ahrs->get_gps().status() >= AP_GPS::GPS_OK_FIX_3D) {
-            frontend->_fusionModeGPS.set(1);
-            GCS_MAVLINK::send_statustext_all(MAV_SEVERITY_WARNING, "EK2: Changed EK2_GPS_TYPE to 1");
+            frontend->gpsNoVertVel = true;
         }
     } else {
         gpsVertVelFail = false;
@@ -172,6 +172,7 @@ void NavEKF3_core::InitialiseVariables()
     posTimeout = true;
     velTimeout = true;
     memset(&faultStatus, 0, sizeof(faultStatus));
+    memset(&logFlags, 0, sizeof(logFlags));
     hgtRate = 0.0f;
     mag_state.q0 = 1;
     mag_state.DCM.identity();
@@ -451,18 +452,33 @@ void NavEKF3_core::CovarianceInit()
 ********************************************************/
 // Update Filter States - this should be called whenever new IMU data is available
 void NavEKF3_core::UpdateFilter(bool predict)
+{
+    if (!UpdateFilterInputs(predict)) {
+        return;
+    }
+
+    UpdateFilterStates();
+}
+
+/*
+  first part of UpdateFilter(): read the IMU data and decide whether the
+  states are predicted on this frame. The decision for the next core depends
+  on the result, so this runs for each core in turn. Returns false if the
+  states are not initialised and there is nothing else to do
+*/
+bool NavEKF3_core::UpdateFilterInputs(bool predict)
 {
     // Set the flag to indicate to the filter that the front-end has given permission for a new state prediction cycle to be started
     startPredictEnabled = predict;
 
     // don't run filter updates if states have not been initialised
     if (!statesInitialised) {
-        return;
+        return false;
     }
 
     // start the timer used for load measurement
 #if EK2_DISABLE_INTERRUPTS
-    irqstate_t istate = irqsave();
+    filterIrqState = irqsave();
 #endif
     hal.util->perf_begin(_perf_UpdateFilter);
 
@@ -477,6 +493,15 @@ void NavEKF3_core::UpdateFilter(bool predict)
     // read IMU data as delta angles and velocities
     readIMUData();
 
+    return true;
+}
+
+/*
+  second part of UpdateFilter(): predict and fuse. This only changes the
+  state of this core, so the cores can run it concurrently
+*/
+void NavEKF3_core::UpdateFilterStates()
+{
     // Run the EKF equations to estimate at the fusion time horizon if new IMU data is available in the buffer
     if (runUpdates) {
         // Predict states using IMU data from the delayed time horizon
@@ -513,10 +538,19 @@ void NavEKF3_core::UpdateFilter(bool predict)
     // stop the timer used for load measurement
     hal.util->perf_end(_perf_UpdateFilter);
 #if EK2_DISABLE_INTERRUPTS
-    irqrestore(istate);
+    irqrestore(filterIrqState);
 #endif
 }
 
+void NavEKF3_core::collectLogFlags(bool &log_compass, bool &log_gps, bool &log_baro, bool &log_imu)
+{
+    log_compass |= logFlags.log_compass;
+    log_gps |= logFlags.log_gps;
+    log_baro |= logFlags.log_baro;
+    log_imu |= logFlags.log_imu;
+    memset(&logFlags, 0, sizeof(logFlags));
+}
+
 void NavEKF3_core::correctDeltaAngle(Vector3f &delAng, float delAngDT)
 {
     delAng -= stateStruct.gyro_bias * (delAngDT / dtEkfAvg);
@@ -77,6 +77,15 @@ public:
     // The predict flag is set true when a new prediction cycle can be started
     void UpdateFilter(bool predict);
 
+    // the two parts of UpdateFilter(), for the frontend to run the second
+    // one of all the cores concurrently
+    bool UpdateFilterInputs(bool predict);
+    void UpdateFilterStates();
+
+    // add the sensor data read since the last call to the frontend
+    // logging flags. Called by the frontend once all the cores have run
+    void collectLogFlags(bool &log_compass, bool &log_gps, bool &log_baro, bool &log_imu);
+
     // Check basic filter health metrics and return a consolidated health status
     bool healthy(void) const;
 
@@ -1127,6 +1136,20 @@ private:
     AP_HAL::Util::perf_counter_t  _perf_FuseOptFlow;
     AP_HAL::Util::perf_counter_t  _perf_test[10];
 
+#if EK2_DISABLE_INTERRUPTS
+    // interrupt state saved between the two parts of UpdateFilter()
+    irqstate_t filterIrqState;
+#endif
+
+    // sensor data read by this core to be logged by the frontend. Kept
+    // per core as the cores may run concurrently
+    struct {
+        bool log_compass;
+        bool log_gps;
+        bool log_baro;
+        bool log_imu;
+    } logFlags;
+
     // should we assume zero sideslip?
     bool assume_zero_sideslip(void) const;
 
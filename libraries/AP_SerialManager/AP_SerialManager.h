@@ -69,6 +69,11 @@
 #define AP_SERIALMANAGER_ULANDING_BUFSIZE_RX     128
 #define AP_SERIALMANAGER_ULANDING_BUFSIZE_TX     128
 
+// GPS raw data pass-through, mostly output so we want a large tx buffer.
+// The baud rate is the SERIALn_BAUD of the port
+#define AP_SERIALMANAGER_GPS_RAW_BUFSIZE_RX     16
+#define AP_SERIALMANAGER_GPS_RAW_BUFSIZE_TX     1024
+
 
 class AP_SerialManager {
 
@@ -89,7 +94,8 @@ public:
         SerialProtocol_FrSky_SPort_Passthrough = 10, // FrSky SPort Passthrough (OpenTX) protocol (X-receivers)
         SerialProtocol_Lidar360 = 11,
         SerialProtocol_Aerotenna_uLanding      = 12, // Ulanding support
-        SerialProtocol_Beacon = 13
+        SerialProtocol_Beacon = 13,
+        SerialProtocol_GPS_Raw = 14                  // copy of the raw data stream from the GPS, for post processing
     };
 
     // Constructor
@@ -39,6 +39,13 @@ const AP_Param::GroupInfo DataFlash_Class::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("_FILE_DSRMROT",  4, DataFlash_Class, _params.file_disarm_rot,       0),
 
+    // @Param: _FILE_COMPRESS
+    // @DisplayName: Compress log files
+    // @Description: When set, log files are compressed as they are written, which makes them smaller and reduces the write bandwidth needed. Compressed logs are decompressed when downloaded and can be read by Replay. Only supported on Linux boards and SITL. Takes effect on the next log file
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("_FILE_COMPRESS",  5, DataFlash_Class, _params.file_compress,       0),
+
     AP_GROUPEND
 };
 
@@ -108,6 +115,10 @@ void DataFlash_Class::WriteCriticalBlock(const void *pBuffer, uint16_t size) {
     FOR_EACH_BACKEND(WriteCriticalBlock(pBuffer, size));
 }
 
+void DataFlash_Class::WriteBulkBlock(const void *pBuffer, uint16_t size) {
+    FOR_EACH_BACKEND(WriteBulkBlock(pBuffer, size));
+}
+
 void DataFlash_Class::WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) {
     FOR_EACH_BACKEND(WritePrioritisedBlock(pBuffer, size, is_critical));
 }
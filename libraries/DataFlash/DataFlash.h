@@ -37,6 +37,10 @@ enum DataFlash_Backend_Type {
     DATAFLASH_BACKEND_BOTH = 3,
 };
 
+// returned by get_log_data() when the data isn't read yet, the caller
+// should ask again later
+#define DATAFLASH_LOG_DATA_PENDING -2
+
 // fwd declarations to avoid include errors
 class AC_AttitudeControl;
 class AC_PosControl;
@@ -87,6 +91,10 @@ public:
     void WriteBlock(const void *pBuffer, uint16_t size);
     /* Write an *important* block of data at current offset */
     void WriteCriticalBlock(const void *pBuffer, uint16_t size);
+    /* Write a block of low-priority bulk data (e.g. raw GNSS streams),
+     * dropped before any regular message when the backend is short of
+     * buffer space */
+    void WriteBulkBlock(const void *pBuffer, uint16_t size);
 
     // high level interface
     uint16_t find_last_log() const;
@@ -194,6 +202,7 @@ public:
         AP_Int8 file_disarm_rot;
         AP_Int8 log_disarmed;
         AP_Int8 log_replay;
+        AP_Int8 file_compress;
     } _params;
 
     const struct LogStructure *structure(uint16_t num) const;
@@ -35,6 +35,12 @@ public:
         return WritePrioritisedBlock(pBuffer, size, true);
     }
 
+    // low-priority bulk data; backends with a write buffer should
+    // drop it well before they start dropping regular messages
+    virtual bool WriteBulkBlock(const void *pBuffer, uint16_t size) {
+        return WritePrioritisedBlock(pBuffer, size, false);
+    }
+
     virtual bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) = 0;
 
     // high level interface
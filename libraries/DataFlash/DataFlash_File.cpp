@@ -41,6 +41,14 @@ extern const AP_HAL::HAL& hal;
 #define MAX_LOG_FILES 500U
 #define DATAFLASH_PAGE_SIZE 1024UL
 
+#if DATAFLASH_FILE_READAHEAD
+#define DATAFLASH_FILE_READAHEAD_SIZE  65536U
+#define DATAFLASH_FILE_READAHEAD_CHUNK 4096U
+#endif
+
+#if DATAFLASH_FILE_COMPRESSION
+#endif
+
 /*
   constructor
  */
@@ -97,6 +105,14 @@ void DataFlash_File::Init()
         return;
     }
 
+#if DATAFLASH_FILE_READAHEAD
+    _readahead_sem = hal.util->new_semaphore();
+    if (_readahead_sem == nullptr) {
+        AP_HAL::panic("Failed to create DataFlash_File semaphore");
+        return;
+    }
+#endif
+
 #if CONFIG_HAL_BOARD == HAL_BOARD_PX4 || CONFIG_HAL_BOARD == HAL_BOARD_VRBRAIN
     // try to cope with an existing lowercase log directory
     // name. NuttX does not handle case insensitive VFAT well
@@ -148,6 +164,14 @@ void DataFlash_File::Init()
 
     hal.console->printf("DataFlash_File: buffer size=%u\n", (unsigned)bufsize);
 
+#if DATAFLASH_FILE_COMPRESSION
+    // without it the log sizes are found when listing the logs
+    _raw_sizes = new log_raw_size[MAX_LOG_FILES + 1];
+    if (_raw_sizes != nullptr) {
+        memset(_raw_sizes, 0, sizeof(log_raw_size) * (MAX_LOG_FILES + 1));
+    }
+#endif
+
     _initialised = true;
     hal.scheduler->register_io_process(FUNCTOR_BIND_MEMBER(&DataFlash_File::_io_timer, void));
 }
@@ -521,6 +545,24 @@ bool DataFlash_File::WritePrioritisedBlock(const void *pBuffer, uint16_t size, b
     return true;
 }
 
+/*
+  write a block of bulk data, keeping half of the write buffer free for
+  regular messages so high rate logging isn't starved by it
+*/
+bool DataFlash_File::WriteBulkBlock(const void *pBuffer, uint16_t size)
+{
+    if (_write_fd == -1 || !_initialised) {
+        return false;
+    }
+
+    if (_writebuf.space() < bulk_message_reserved_space() + size) {
+        _dropped++;
+        return false;
+    }
+
+    return WritePrioritisedBlock(pBuffer, size, false);
+}
+
 /*
   read a packet. The header bytes have already been read.
 */
@@ -654,6 +696,10 @@ int16_t DataFlash_File::get_log_data(const uint16_t list_entry, const uint16_t p
         return -1;
     }
 
+#if DATAFLASH_FILE_READAHEAD
+    return _get_log_data_readahead(log_num, page * (uint32_t)DATAFLASH_PAGE_SIZE + offset, len, data);
+#else
+
     if (_read_fd != -1 && log_num != _read_fd_log_num) {
         ::close(_read_fd);
         _read_fd = -1;
@@ -719,8 +765,298 @@ int16_t DataFlash_File::get_log_data(const uint16_t list_entry, const uint16_t p
         _read_offset += ret;
     }
     return ret;
+#endif // DATAFLASH_FILE_READAHEAD
+}
+
+#if DATAFLASH_FILE_COMPRESSION
+static_assert(DATAFLASH_FILE_READAHEAD_CHUNK >= LOG_COMPRESSED_FRAME_MAX,
+              "read-ahead chunk must hold a decompressed frame");
+
+// allocate the compressor on the first compressed log
+bool DataFlash_File::_compression_alloc(void)
+{
+    if (_compressor == nullptr) {
+        _compressor = new LogCompressor;
+        _write_frame = new uint8_t[LOG_COMPRESSED_FRAME_SIZE_MAX];
+        if (_compressor == nullptr || _write_frame == nullptr) {
+            delete _compressor;
+            delete[] _write_frame;
+            _compressor = nullptr;
+            _write_frame = nullptr;
+            hal.console->printf("Out of memory for log compression\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+  compress up to len bytes of data into a frame and write it out from the
+  IO thread. Frames are written whole. Returns the number of bytes of
+  data used, or -1 on error
+ */
+ssize_t DataFlash_File::_io_write_frame(const uint8_t *data, uint32_t len)
+{
+    len = MIN(len, (uint32_t)LOG_COMPRESSED_FRAME_MAX);
+    const uint16_t frame_len = _compressor->compress_frame(data, len, _write_offset, _write_frame);
+
+    uint16_t written = 0;
+    while (written < frame_len) {
+        const ssize_t n = ::write(_write_fd, &_write_frame[written], frame_len - written);
+        if (n <= 0) {
+            return -1;
+        }
+        written += n;
+    }
+    return len;
+}
+
+/*
+  find the uncompressed size of a compressed log from the last complete
+  frame near the end of the file. Other logs are not compressed, so
+  their size is the file size
+ */
+uint32_t DataFlash_File::_get_log_raw_size(const uint16_t log_num, const uint32_t size) const
+{
+    char *fname = _log_file_name(log_num);
+    if (fname == nullptr) {
+        return size;
+    }
+    int fd = ::open(fname, O_RDONLY|O_CLOEXEC);
+    free(fname);
+    if (fd == -1) {
+        return size;
+    }
+    const uint32_t raw_size = log_file_compressed(fd) ? log_file_raw_size(fd, size) : size;
+    ::close(fd);
+    return raw_size;
+}
+
+// cache the uncompressed size of a log of the given file size
+void DataFlash_File::_set_log_raw_size(const uint16_t log_num, const uint32_t size, const uint32_t raw_size)
+{
+    if (_raw_sizes == nullptr || log_num > MAX_LOG_FILES ||
+        !_readahead_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
+    _raw_sizes[log_num].file_size = size;
+    _raw_sizes[log_num].raw_size = raw_size;
+    _readahead_sem->give();
+}
+
+/*
+  uncompressed size of a log for the log list, from the cache when it is
+  up to date. The IO thread fills it soon after boot and for each log
+  closed, so the file is only read here if the list is asked for before
+ */
+uint32_t DataFlash_File::_log_raw_size(const uint16_t log_num)
+{
+    if (_write_fd != -1 && _write_compressed && log_num == _write_log_num) {
+        return _write_offset;
+    }
+    const uint32_t size = _get_log_size(log_num);
+    if (size == 0) {
+        return 0;
+    }
+    if (_raw_sizes != nullptr && log_num <= MAX_LOG_FILES && _readahead_sem->take(1)) {
+        const struct log_raw_size cached = _raw_sizes[log_num];
+        _readahead_sem->give();
+        if (cached.file_size == size) {
+            return cached.raw_size;
+        }
+    }
+    const uint32_t raw_size = _get_log_raw_size(log_num, size);
+    _set_log_raw_size(log_num, size, raw_size);
+    return raw_size;
+}
+
+/*
+  find the uncompressed size of one log from the IO thread: the one just
+  closed if any, else the next of all the logs, once after boot
+ */
+void DataFlash_File::_io_raw_sizes(void)
+{
+    if (_raw_sizes == nullptr || !_readahead_sem->take(1)) {
+        return;
+    }
+    uint16_t log_num = _raw_sizes_closed_log;
+    _raw_sizes_closed_log = 0;
+    if (log_num == 0 && _raw_sizes_next_log <= MAX_LOG_FILES) {
+        log_num = _raw_sizes_next_log++;
+    }
+    _readahead_sem->give();
+
+    if (log_num == 0) {
+        return;
+    }
+    const uint32_t size = _get_log_size(log_num);
+    if (size != 0) {
+        _set_log_raw_size(log_num, size, _get_log_raw_size(log_num, size));
+    }
+}
+#endif // DATAFLASH_FILE_COMPRESSION
+
+#if DATAFLASH_FILE_READAHEAD
+/*
+  copy log data from the read-ahead buffer. Asking for another log or
+  for another offset than the one following the last read restarts the
+  read-ahead from there
+ */
+int16_t DataFlash_File::_get_log_data_readahead(const uint16_t log_num, const uint32_t ofs, const uint16_t len, uint8_t *data)
+{
+    if (log_num != _readahead_log_num) {
+        stop_logging();
+    }
+
+    if (!_readahead_sem->take(1)) {
+        return DATAFLASH_LOG_DATA_PENDING;
+    }
+
+    if (_readahead_chunk == nullptr) {
+        _readahead_chunk = new uint8_t[DATAFLASH_FILE_READAHEAD_CHUNK];
+        bool allocated = _readahead_chunk != nullptr;
+#if DATAFLASH_FILE_COMPRESSION
+        allocated = allocated && _readahead_frames.init();
+#endif
+        if (!allocated || !_readahead_buf.set_size(DATAFLASH_FILE_READAHEAD_SIZE)) {
+            delete[] _readahead_chunk;
+            _readahead_chunk = nullptr;
+            _readahead_sem->give();
+            return -1;
+        }
+    }
+
+    if (log_num != _readahead_log_num || ofs != _readahead_ofs) {
+        _readahead_log_num = log_num;
+        _readahead_ofs = ofs;
+        _readahead_seq++;
+        _readahead_eof = false;
+        _readahead_error = false;
+        _readahead_buf.clear();
+        _readahead_sem->give();
+        return DATAFLASH_LOG_DATA_PENDING;
+    }
+
+    int16_t ret;
+    if (_readahead_error) {
+        ret = -1;
+    } else if (_readahead_buf.available() < len && !_readahead_eof) {
+        // a short read means the end of the log to the caller
+        ret = DATAFLASH_LOG_DATA_PENDING;
+    } else {
+        ret = _readahead_buf.read(data, len);
+        _readahead_ofs += ret;
+    }
+
+    _readahead_sem->give();
+    return ret;
+}
+
+// stop the read-ahead, the IO thread closes the file on its next run
+void DataFlash_File::_stop_readahead(void)
+{
+    if (!_readahead_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+        return;
+    }
+    _readahead_log_num = 0;
+    _readahead_seq++;
+    _readahead_buf.clear();
+    _readahead_sem->give();
 }
 
+/*
+  fill the read-ahead buffer from the IO thread. The reads are aligned on
+  DATAFLASH_FILE_READAHEAD_CHUNK so that the filesystem only ever reads
+  whole blocks, and the file is only accessed with the semaphore released
+ */
+void DataFlash_File::_io_readahead(void)
+{
+    for (uint32_t i = 0; i < DATAFLASH_FILE_READAHEAD_SIZE / DATAFLASH_FILE_READAHEAD_CHUNK; i++) {
+        if (!_readahead_sem->take(1)) {
+            return;
+        }
+        const uint16_t log_num = _readahead_log_num;
+        const uint32_t seq = _readahead_seq;
+        const uint32_t ofs = _readahead_ofs + _readahead_buf.available();
+        const uint32_t space = _readahead_buf.space();
+        const bool done = _readahead_eof || _readahead_error;
+        _readahead_sem->give();
+
+        if (log_num == 0 && _readahead_fd != -1) {
+            ::close(_readahead_fd);
+            _readahead_fd = -1;
+        }
+        if (log_num == 0 || done) {
+            return;
+        }
+
+        if (_readahead_fd != -1 && _readahead_fd_log_num != log_num) {
+            ::close(_readahead_fd);
+            _readahead_fd = -1;
+        }
+        if (_readahead_fd == -1) {
+            char *fname = _log_file_name(log_num);
+            if (fname != nullptr) {
+                _readahead_fd = ::open(fname, O_RDONLY|O_CLOEXEC);
+                free(fname);
+            }
+            _readahead_fd_log_num = log_num;
+            _readahead_fd_ofs = 0;
+#if DATAFLASH_FILE_COMPRESSION
+            _readahead_fd_compressed = _readahead_fd != -1 && log_file_compressed(_readahead_fd);
+            _readahead_frames.reset(_readahead_fd);
+#endif
+        }
+
+        uint32_t len = DATAFLASH_FILE_READAHEAD_CHUNK - ofs % DATAFLASH_FILE_READAHEAD_CHUNK;
+#if DATAFLASH_FILE_COMPRESSION
+        if (_readahead_fd_compressed) {
+            // the rest of a frame can be up to a whole frame
+            len = LOG_COMPRESSED_FRAME_MAX;
+        }
+#endif
+        if (space < len) {
+            return;
+        }
+
+        ssize_t nread = -1;
+        const uint8_t *data = _readahead_chunk;
+#if DATAFLASH_FILE_COMPRESSION
+        if (_readahead_fd != -1 && _readahead_fd_compressed) {
+            nread = _readahead_frames.read(ofs, _readahead_chunk, data);
+        } else
+#endif
+        if (_readahead_fd != -1) {
+            if (_readahead_fd_ofs != ofs && ::lseek(_readahead_fd, ofs, SEEK_SET) == (off_t)-1) {
+                ::close(_readahead_fd);
+                _readahead_fd = -1;
+            } else {
+                _readahead_fd_ofs = ofs;
+                nread = ::read(_readahead_fd, _readahead_chunk, len);
+                if (nread > 0) {
+                    _readahead_fd_ofs += nread;
+                }
+            }
+        }
+
+        if (!_readahead_sem->take(1)) {
+            return;
+        }
+        // drop the data if the read-ahead restarted meanwhile
+        if (seq == _readahead_seq) {
+            if (nread < 0) {
+                _readahead_error = true;
+            } else if (nread == 0) {
+                _readahead_eof = true;
+            } else {
+                _readahead_buf.write(data, nread);
+            }
+        }
+        _readahead_sem->give();
+    }
+}
+#endif // DATAFLASH_FILE_READAHEAD
+
 /*
   find size and date of a log
  */
@@ -734,7 +1070,12 @@ void DataFlash_File::get_log_info(const uint16_t list_entry, uint32_t &size, uin
         return;
     }
 
+#if DATAFLASH_FILE_COMPRESSION
+    // downloads are of the uncompressed log
+    size = _log_raw_size(log_num);
+#else
     size = _get_log_size(log_num);
+#endif
     time_utc = _get_log_time(log_num);
 }
 
@@ -775,6 +1116,13 @@ void DataFlash_File::stop_logging(void)
         _write_fd = -1;
         log_write_started = false;
         ::close(fd);
+#if DATAFLASH_FILE_COMPRESSION
+        if (_write_compressed && _readahead_sem->take(HAL_SEMAPHORE_BLOCK_FOREVER)) {
+            // the IO thread finds its size for the log list
+            _raw_sizes_closed_log = _write_log_num;
+            _readahead_sem->give();
+        }
+#endif
     }
 }
 
@@ -798,6 +1146,12 @@ uint16_t DataFlash_File::start_new_log(void)
         ::close(_read_fd);
         _read_fd = -1;
     }
+#if DATAFLASH_FILE_READAHEAD
+    _stop_readahead();
+#endif
+#if DATAFLASH_FILE_COMPRESSION
+    _write_compressed = _front._params.file_compress != 0 && _compression_alloc();
+#endif
 
     if (disk_space_avail() < _free_space_min_avail) {
         hal.console->printf("Out of space for logging\n");
@@ -833,6 +1187,9 @@ uint16_t DataFlash_File::start_new_log(void)
     }
     free(fname);
     _write_offset = 0;
+#if DATAFLASH_FILE_COMPRESSION
+    _write_log_num = log_num;
+#endif
     _writebuf.clear();
     log_write_started = true;
 
@@ -1032,6 +1389,18 @@ void DataFlash_File::_io_timer(void)
 {
     uint32_t tnow = AP_HAL::millis();
     _io_timer_heartbeat = tnow;
+
+#if DATAFLASH_FILE_READAHEAD
+    if (_initialised) {
+        _io_readahead();
+    }
+#endif
+#if DATAFLASH_FILE_COMPRESSION
+    if (_initialised) {
+        _io_raw_sizes();
+    }
+#endif
+
     if (_write_fd == -1 || !_initialised || _open_error) {
         return;
     }
@@ -1068,15 +1437,23 @@ void DataFlash_File::_io_timer(void)
     const uint8_t *head = _writebuf.readptr(size);
     nbytes = MIN(nbytes, size);
 
-    // try to align writes on a 512 byte boundary to avoid filesystem reads
-    if ((nbytes + _write_offset) % 512 != 0) {
-        uint32_t ofs = (nbytes + _write_offset) % 512;
-        if (ofs < nbytes) {
-            nbytes -= ofs;
+    ssize_t nwritten;
+#if DATAFLASH_FILE_COMPRESSION
+    if (_write_compressed) {
+        nwritten = _io_write_frame(head, nbytes);
+    } else
+#endif
+    {
+        // try to align writes on a 512 byte boundary to avoid filesystem reads
+        if ((nbytes + _write_offset) % 512 != 0) {
+            uint32_t ofs = (nbytes + _write_offset) % 512;
+            if (ofs < nbytes) {
+                nbytes -= ofs;
+            }
         }
-    }
 
-    ssize_t nwritten = ::write(_write_fd, head, nbytes);
+        nwritten = ::write(_write_fd, head, nbytes);
+    }
     if (nwritten <= 0) {
         hal.util->perf_count(_perf_errors);
         close(_write_fd);
@@ -23,6 +23,26 @@
 #define DATAFLASH_FILE_MINIMAL 0
 #endif
 
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+/*
+  log downloads are read ahead by the IO thread, so that get_log_data()
+  only copies from memory and the download rate is set by the link
+ */
+#define DATAFLASH_FILE_READAHEAD 1
+#else
+#define DATAFLASH_FILE_READAHEAD 0
+#endif
+
+/*
+  logs may be compressed as they are written, see LogCompression.h. This
+  needs the read-ahead, which decompresses them for downloads
+ */
+#define DATAFLASH_FILE_COMPRESSION DATAFLASH_FILE_READAHEAD
+
+#if DATAFLASH_FILE_COMPRESSION
+#include "LogCompression.h"
+#endif
+
 class DataFlash_File : public DataFlash_Backend
 {
 public:
@@ -44,6 +64,7 @@ public:
 
     /* Write a block of data at current offset */
     bool WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical);
+    bool WriteBulkBlock(const void *pBuffer, uint16_t size) override;
     uint32_t bufferspace_available();
 
     // high level interface
@@ -126,6 +147,61 @@ private:
 
     void _io_timer(void);
 
+#if DATAFLASH_FILE_READAHEAD
+    // read-ahead of the log being downloaded. The fields shared with the
+    // IO thread are protected by _readahead_sem
+    AP_HAL::Semaphore *_readahead_sem = nullptr;
+    ByteBuffer _readahead_buf{0};
+    uint8_t *_readahead_chunk = nullptr;
+    uint16_t _readahead_log_num = 0;    // log being read ahead, 0 for none
+    uint32_t _readahead_ofs = 0;        // offset in the log of the next byte in _readahead_buf
+    uint32_t _readahead_seq = 0;        // incremented each time the read-ahead restarts
+    bool _readahead_eof = false;
+    bool _readahead_error = false;
+
+    // only used by the IO thread
+    int _readahead_fd = -1;
+    uint16_t _readahead_fd_log_num = 0;
+    uint32_t _readahead_fd_ofs = 0;
+
+    int16_t _get_log_data_readahead(uint16_t log_num, uint32_t ofs, uint16_t len, uint8_t *data);
+    void _stop_readahead(void);
+    void _io_readahead(void);
+#endif
+
+#if DATAFLASH_FILE_COMPRESSION
+    // compression of the log being written, by the IO thread. When
+    // compressing, _write_offset counts uncompressed bytes
+    LogCompressor *_compressor = nullptr;
+    uint8_t *_write_frame = nullptr;
+    bool _write_compressed = false;
+
+    uint16_t _write_log_num = 0;
+
+    // only used by the IO thread, for reading ahead a compressed log
+    LogFrameReader _readahead_frames;
+    bool _readahead_fd_compressed = false;
+
+    // uncompressed size of each log by log number, valid while the file
+    // has the same size. Filled by the IO thread and when a log is
+    // closed, so that listing the logs doesn't read them. Protected by
+    // _readahead_sem
+    struct log_raw_size {
+        uint32_t file_size;
+        uint32_t raw_size;
+    };
+    struct log_raw_size *_raw_sizes = nullptr;
+    uint16_t _raw_sizes_next_log = 1;       // next log looked at by the IO thread
+    uint16_t _raw_sizes_closed_log = 0;     // log closed since, 0 for none
+
+    bool _compression_alloc(void);
+    ssize_t _io_write_frame(const uint8_t *data, uint32_t len);
+    void _io_raw_sizes(void);
+    uint32_t _get_log_raw_size(uint16_t log_num, uint32_t size) const;
+    uint32_t _log_raw_size(uint16_t log_num);
+    void _set_log_raw_size(uint16_t log_num, uint32_t size, uint32_t raw_size);
+#endif
+
     uint32_t critical_message_reserved_space() const {
         // possibly make this a proportional to buffer size?
         uint32_t ret = 1024;
@@ -135,6 +211,10 @@ private:
         }
         return ret;
     };
+    uint32_t bulk_message_reserved_space() const {
+        // bulk data may only use the first half of the buffer
+        return _writebuf.get_size() / 2;
+    };
     uint32_t non_messagewriter_message_reserved_space() const {
         // possibly make this a proportional to buffer size?
         uint32_t ret = 1024;
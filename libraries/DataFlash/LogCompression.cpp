@@ -0,0 +1,511 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  compression of DataFlash log files, see LogCompression.h
+
+  The data of a frame is a sequence of LZ4 block sequences: a token
+  holding the literal length in its high nibble and the match length
+  minus 4 in its low nibble, each extended by bytes of 255 while the
+  nibble is 15, followed by the literals and a 2 byte little endian
+  match offset. The last sequence only has literals
+ */
+
+#include "LogCompression.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/edc.h>
+
+#define LOG_COMPRESS_MIN_MATCH 4
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// write the extension bytes of a literal or match length
+static uint8_t *write_length(uint8_t *op, const uint8_t *oend, uint32_t n)
+{
+    while (n >= 255) {
+        if (op >= oend) {
+            return nullptr;
+        }
+        *op++ = 255;
+        n -= 255;
+    }
+    if (op >= oend) {
+        return nullptr;
+    }
+    *op++ = n;
+    return op;
+}
+
+/*
+  write a sequence of lit_len literals followed by a match of match_len
+  bytes at offset back, or no match when match_len is 0. Returns nullptr
+  if dst is full
+ */
+static uint8_t *write_sequence(uint8_t *op, const uint8_t *oend,
+                               const uint8_t *lit, uint32_t lit_len,
+                               uint16_t offset, uint32_t match_len)
+{
+    if (op >= oend) {
+        return nullptr;
+    }
+    uint8_t *token = op++;
+    *token = (lit_len >= 15 ? 15 : lit_len) << 4;
+    if (lit_len >= 15) {
+        op = write_length(op, oend, lit_len - 15);
+        if (op == nullptr) {
+            return nullptr;
+        }
+    }
+    if ((uint32_t)(oend - op) < lit_len) {
+        return nullptr;
+    }
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+
+    if (match_len == 0) {
+        return op;
+    }
+    if (oend - op < 2) {
+        return nullptr;
+    }
+    *op++ = offset & 0xFF;
+    *op++ = offset >> 8;
+    const uint32_t m = match_len - LOG_COMPRESS_MIN_MATCH;
+    *token |= m >= 15 ? 15 : m;
+    if (m >= 15) {
+        op = write_length(op, oend, m - 15);
+    }
+    return op;
+}
+
+uint16_t LogCompressor::compress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t dst_len)
+{
+    memset(_hashtable, 0, sizeof(_hashtable));
+
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *const end = src + len;
+    uint8_t *op = dst;
+    const uint8_t *const oend = dst + dst_len;
+
+    while (end - ip >= LOG_COMPRESS_MIN_MATCH) {
+        const uint32_t seq = read32(ip);
+        const uint32_t h = (seq * 2654435761U) >> (32 - LOG_COMPRESS_HASH_BITS);
+        const uint8_t *ref = src + _hashtable[h];
+        _hashtable[h] = ip - src;
+
+        if (ref >= ip || read32(ref) != seq) {
+            // skip faster through data which doesn't compress
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        const uint8_t *mp = ip + LOG_COMPRESS_MIN_MATCH;
+        const uint8_t *rp = ref + LOG_COMPRESS_MIN_MATCH;
+        while (mp < end && *mp == *rp) {
+            mp++;
+            rp++;
+        }
+
+        op = write_sequence(op, oend, anchor, ip - anchor, ip - ref, mp - ip);
+        if (op == nullptr) {
+            return 0;
+        }
+        ip = mp;
+        anchor = ip;
+    }
+
+    op = write_sequence(op, oend, anchor, end - anchor, 0, 0);
+    if (op == nullptr) {
+        return 0;
+    }
+    return op - dst;
+}
+
+int32_t log_decompress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t dst_len)
+{
+    const uint8_t *ip = src;
+    const uint8_t *const iend = src + len;
+    uint8_t *op = dst;
+    const uint8_t *const oend = dst + dst_len;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        uint32_t lit_len = token >> 4;
+        if (lit_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                lit_len += b;
+            } while (b == 255);
+        }
+        if (lit_len > (uint32_t)(iend - ip) || lit_len > (uint32_t)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        if (ip == iend) {
+            // the last sequence has no match
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        const uint16_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - dst) {
+            return -1;
+        }
+
+        uint32_t match_len = token & 0x0F;
+        if (match_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                match_len += b;
+            } while (b == 255);
+        }
+        match_len += LOG_COMPRESS_MIN_MATCH;
+        if (match_len > (uint32_t)(oend - op)) {
+            return -1;
+        }
+
+        // the match may overlap the bytes being written
+        const uint8_t *ref = op - offset;
+        while (match_len--) {
+            *op++ = *ref++;
+        }
+    }
+
+    return op - dst;
+}
+
+// crc of a frame, over the header fields after the head bytes and the data
+static uint16_t frame_crc(const struct log_compressed_frame &hdr, const uint8_t *data)
+{
+    const uint8_t *h = (const uint8_t *)&hdr;
+    uint16_t crc = crc16_ccitt(&h[offsetof(struct log_compressed_frame, raw_len)],
+                               offsetof(struct log_compressed_frame, crc) - offsetof(struct log_compressed_frame, raw_len),
+                               0);
+    return crc16_ccitt(data, hdr.data_len, crc);
+}
+
+uint16_t LogCompressor::compress_frame(const uint8_t *raw, uint16_t len, uint32_t raw_ofs, uint8_t *frame)
+{
+    struct log_compressed_frame hdr;
+    uint8_t *data = frame + sizeof(hdr);
+
+    if (len > LOG_COMPRESSED_FRAME_MAX) {
+        len = LOG_COMPRESSED_FRAME_MAX;
+    }
+
+    // the data is stored as is unless compressing makes it smaller
+    uint16_t data_len = len > 0 ? compress(raw, len, data, len - 1) : 0;
+    if (data_len == 0) {
+        memcpy(data, raw, len);
+        data_len = len;
+    }
+
+    hdr.head1 = HEAD_BYTE1;
+    hdr.head2 = LOG_COMPRESSED_HEAD_BYTE2;
+    hdr.raw_len = len;
+    hdr.data_len = data_len;
+    hdr.raw_ofs = raw_ofs;
+    hdr.crc = frame_crc(hdr, data);
+    memcpy(frame, &hdr, sizeof(hdr));
+
+    return sizeof(hdr) + data_len;
+}
+
+bool log_frame_header_valid(const struct log_compressed_frame &hdr)
+{
+    return hdr.head1 == HEAD_BYTE1 &&
+        hdr.head2 == LOG_COMPRESSED_HEAD_BYTE2 &&
+        hdr.raw_len <= LOG_COMPRESSED_FRAME_MAX &&
+        hdr.data_len <= hdr.raw_len;
+}
+
+bool log_frame_valid(const uint8_t *frame, uint32_t frame_len)
+{
+    struct log_compressed_frame hdr;
+    if (frame_len < sizeof(hdr)) {
+        return false;
+    }
+    memcpy(&hdr, frame, sizeof(hdr));
+    if (!log_frame_header_valid(hdr) || frame_len < sizeof(hdr) + hdr.data_len) {
+        return false;
+    }
+    return frame_crc(hdr, frame + sizeof(hdr)) == hdr.crc;
+}
+
+int16_t log_decompress_frame(const uint8_t *frame, uint16_t frame_len, uint8_t *raw)
+{
+    if (!log_frame_valid(frame, frame_len)) {
+        return -1;
+    }
+
+    struct log_compressed_frame hdr;
+    memcpy(&hdr, frame, sizeof(hdr));
+    const uint8_t *data = frame + sizeof(hdr);
+
+    if (hdr.data_len == hdr.raw_len) {
+        memcpy(raw, data, hdr.raw_len);
+        return hdr.raw_len;
+    }
+    if (log_decompress(data, hdr.data_len, raw, hdr.raw_len) != hdr.raw_len) {
+        return -1;
+    }
+    return hdr.raw_len;
+}
+
+LogFrameReader::~LogFrameReader()
+{
+    delete[] _frame;
+    delete[] _index;
+}
+
+bool LogFrameReader::init(void)
+{
+    if (_frame == nullptr) {
+        _frame = new uint8_t[LOG_COMPRESSED_FRAME_SIZE_MAX];
+    }
+    if (_index == nullptr) {
+        _index = new index_entry[LOG_FRAME_INDEX_SIZE];
+    }
+    return _frame != nullptr && _index != nullptr;
+}
+
+void LogFrameReader::reset(int fd)
+{
+    _fd = fd;
+    _file_ofs = 0;
+    _raw_ofs = 0;
+    _resynced = false;
+    _last = {};
+    _index_count = 0;
+    _index_stride = LOG_FRAME_INDEX_STRIDE;
+}
+
+/*
+  move the walk through the frames to the last indexed frame at or
+  before offset ofs of the uncompressed log, when ofs is behind the walk
+  or that frame is ahead of it
+ */
+void LogFrameReader::_seek(uint32_t ofs)
+{
+    uint16_t lo = 0;
+    uint16_t hi = _index_count;
+    while (lo < hi) {
+        const uint16_t mid = (lo + hi) / 2;
+        if (_index[mid].raw_ofs <= ofs) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    struct index_entry entry {};
+    if (lo > 0) {
+        entry = _index[lo - 1];
+    }
+    if (ofs < _raw_ofs || entry.raw_ofs > _raw_ofs) {
+        _file_ofs = entry.file_ofs;
+        _raw_ofs = entry.raw_ofs;
+        _resynced = false;
+        _last = entry;
+    }
+}
+
+// index the frame at file_ofs if far enough from the last one indexed
+void LogFrameReader::_index_add(uint32_t raw_ofs, uint32_t file_ofs)
+{
+    if (_index_count > 0) {
+        const uint32_t last = _index[_index_count - 1].raw_ofs;
+        if (raw_ofs < last || raw_ofs - last < _index_stride) {
+            return;
+        }
+    }
+    if (_index_count == LOG_FRAME_INDEX_SIZE) {
+        // keep every other entry. The new one is still a stride away
+        for (uint16_t i = 1; i < LOG_FRAME_INDEX_SIZE / 2; i++) {
+            _index[i] = _index[2 * i];
+        }
+        _index_count = LOG_FRAME_INDEX_SIZE / 2;
+        _index_stride *= 2;
+    }
+    _index[_index_count].raw_ofs = raw_ofs;
+    _index[_index_count].file_ofs = file_ofs;
+    _index_count++;
+}
+
+/*
+  true if a whole valid frame, not behind the walk through the frames,
+  starts at offset file_ofs
+ */
+bool LogFrameReader::_frame_valid(uint32_t file_ofs)
+{
+    struct log_compressed_frame hdr;
+    if (::pread(_fd, &hdr, sizeof(hdr), file_ofs) != sizeof(hdr) ||
+        !log_frame_header_valid(hdr) || hdr.raw_ofs < _raw_ofs) {
+        return false;
+    }
+    const uint32_t frame_len = sizeof(hdr) + hdr.data_len;
+    return ::pread(_fd, _frame, frame_len, file_ofs) == (ssize_t)frame_len &&
+        log_frame_valid(_frame, frame_len);
+}
+
+/*
+  find the next valid frame after a damaged one. The header of the last
+  frame walked through may be wrong too, as its data wasn't read when
+  skipping it, so the walk goes back to it and looks from there. The
+  next valid frame then starts within two frames
+ */
+bool LogFrameReader::_resync(void)
+{
+    _file_ofs = _last.file_ofs;
+    _raw_ofs = _last.raw_ofs;
+
+    uint8_t buf[64];
+    const uint32_t end = _file_ofs + 2 * LOG_COMPRESSED_FRAME_SIZE_MAX;
+    for (uint32_t pos = _file_ofs + 1; pos < end; pos += sizeof(buf) - 1) {
+        const ssize_t n = ::pread(_fd, buf, sizeof(buf), pos);
+        if (n < 2) {
+            return false;
+        }
+        for (ssize_t i = 0; i < n - 1; i++) {
+            if (buf[i] == HEAD_BYTE1 && buf[i+1] == LOG_COMPRESSED_HEAD_BYTE2 &&
+                _frame_valid(pos + i)) {
+                _file_ofs = pos + i;
+                _resynced = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+ssize_t LogFrameReader::read(uint32_t ofs, uint8_t *raw, const uint8_t *&data)
+{
+    _seek(ofs);
+
+    while (true) {
+        struct log_compressed_frame hdr;
+        ssize_t n = ::pread(_fd, &hdr, sizeof(hdr), _file_ofs);
+        if (n < 0) {
+            return -1;
+        }
+        if (n != sizeof(hdr)) {
+            return 0;
+        }
+        if (!log_frame_header_valid(hdr) || hdr.raw_ofs < _raw_ofs ||
+            (hdr.raw_ofs > _raw_ofs && !_resynced)) {
+            if (!_resync()) {
+                return 0;
+            }
+            continue;
+        }
+        if (hdr.raw_ofs > _raw_ofs) {
+            // past the bytes lost with a damaged frame
+            if (ofs < hdr.raw_ofs) {
+                const uint32_t len = MIN(hdr.raw_ofs - ofs, (uint32_t)LOG_COMPRESSED_FRAME_MAX);
+                memset(raw, 0, len);
+                data = raw;
+                return len;
+            }
+            _raw_ofs = hdr.raw_ofs;
+        }
+        _resynced = false;
+        _index_add(hdr.raw_ofs, _file_ofs);
+
+        const uint32_t frame_len = sizeof(hdr) + hdr.data_len;
+        if (ofs >= hdr.raw_ofs + hdr.raw_len) {
+            // only the header is read from frames before ofs
+            _last.raw_ofs = hdr.raw_ofs;
+            _last.file_ofs = _file_ofs;
+            _file_ofs += frame_len;
+            _raw_ofs += hdr.raw_len;
+            continue;
+        }
+
+        n = ::pread(_fd, _frame, frame_len, _file_ofs);
+        if (n < 0) {
+            return -1;
+        }
+        if (log_decompress_frame(_frame, n, raw) != hdr.raw_len) {
+            if (!_resync()) {
+                return 0;
+            }
+            continue;
+        }
+        _last.raw_ofs = hdr.raw_ofs;
+        _last.file_ofs = _file_ofs;
+        _file_ofs += frame_len;
+        _raw_ofs += hdr.raw_len;
+
+        data = &raw[ofs - hdr.raw_ofs];
+        return hdr.raw_len - (ofs - hdr.raw_ofs);
+    }
+}
+
+bool log_file_compressed(int fd)
+{
+    uint8_t head[2];
+    return ::pread(fd, head, sizeof(head), 0) == sizeof(head) &&
+        head[0] == HEAD_BYTE1 && head[1] == LOG_COMPRESSED_HEAD_BYTE2;
+}
+
+uint32_t log_file_raw_size(int fd, uint32_t file_size)
+{
+    // the last frame starts within the last two frames of the file, as
+    // the last one may be incomplete
+    const uint32_t tail_len = MIN(file_size, 2 * LOG_COMPRESSED_FRAME_SIZE_MAX);
+    uint8_t *tail = new uint8_t[tail_len];
+    if (tail == nullptr) {
+        return 0;
+    }
+    const ssize_t n = ::pread(fd, tail, tail_len, file_size - tail_len);
+
+    uint32_t raw_size = 0;
+    for (ssize_t i = n - (ssize_t)sizeof(struct log_compressed_frame); i >= 0; i--) {
+        if (tail[i] != HEAD_BYTE1 || tail[i+1] != LOG_COMPRESSED_HEAD_BYTE2 ||
+            !log_frame_valid(&tail[i], n - i)) {
+            continue;
+        }
+        struct log_compressed_frame hdr;
+        memcpy(&hdr, &tail[i], sizeof(hdr));
+        raw_size = hdr.raw_ofs + hdr.raw_len;
+        break;
+    }
+    delete[] tail;
+    return raw_size;
+}
@@ -0,0 +1,156 @@
+/*
+  compression of DataFlash log files
+
+  A compressed log is a sequence of frames, each holding up to
+  LOG_COMPRESSED_FRAME_MAX bytes of the uncompressed log. Frames are
+  compressed independently with an LZ77 codec using the LZ4 block
+  layout, and carry a checksum, so a log cut short by a crash decodes
+  up to its last complete frame
+ */
+#pragma once
+
+#include <sys/types.h>
+
+#include <AP_Common/AP_Common.h>
+
+#include "LogStructure.h"
+
+// second byte of a frame header, the first being HEAD_BYTE1. Plain logs
+// start with HEAD_BYTE1, HEAD_BYTE2 so readers can tell them apart
+#define LOG_COMPRESSED_HEAD_BYTE2 0x96
+
+// maximum uncompressed bytes in a frame
+#define LOG_COMPRESSED_FRAME_MAX 4096
+
+// size of the compressor hash table, as a power of 2
+#define LOG_COMPRESS_HASH_BITS 12
+
+// entries of the frame index of LogFrameReader, and their initial
+// spacing in uncompressed bytes
+#define LOG_FRAME_INDEX_SIZE   256U
+#define LOG_FRAME_INDEX_STRIDE (16U * LOG_COMPRESSED_FRAME_MAX)
+
+struct PACKED log_compressed_frame {
+    uint8_t head1;
+    uint8_t head2;
+    uint16_t raw_len;   // uncompressed length
+    uint16_t data_len;  // bytes following the header, equal to raw_len when stored uncompressed
+    uint32_t raw_ofs;   // offset of the frame in the uncompressed log
+    uint16_t crc;       // crc16_ccitt of the rest of the header and the data
+};
+
+// maximum size of a frame, with its header
+#define LOG_COMPRESSED_FRAME_SIZE_MAX (sizeof(struct log_compressed_frame) + LOG_COMPRESSED_FRAME_MAX)
+
+class LogCompressor {
+public:
+    /*
+      build a frame in frame, of size at least
+      LOG_COMPRESSED_FRAME_SIZE_MAX, from len bytes of raw data at
+      raw_ofs in the log. Returns the size of the frame
+     */
+    uint16_t compress_frame(const uint8_t *raw, uint16_t len, uint32_t raw_ofs, uint8_t *frame);
+
+    /*
+      compress len bytes of src into dst, which has room for dst_len
+      bytes. Returns the compressed length, or 0 if it would not fit
+     */
+    uint16_t compress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t dst_len);
+
+private:
+    uint16_t _hashtable[1U << LOG_COMPRESS_HASH_BITS];
+};
+
+/*
+  check a frame header, returning false if it can't be the start of a
+  frame
+ */
+bool log_frame_header_valid(const struct log_compressed_frame &hdr);
+
+/*
+  check that frame_len bytes of frame start with a complete frame with
+  a valid crc
+ */
+bool log_frame_valid(const uint8_t *frame, uint32_t frame_len);
+
+/*
+  check the crc of a frame and decompress it into raw, of size at least
+  LOG_COMPRESSED_FRAME_MAX. Returns the uncompressed length, or -1 if the
+  frame is corrupt
+ */
+int16_t log_decompress_frame(const uint8_t *frame, uint16_t frame_len, uint8_t *raw);
+
+/*
+  decompress len bytes of src into dst, which has room for dst_len
+  bytes. Returns the uncompressed length, or -1 if src is corrupt
+ */
+int32_t log_decompress(const uint8_t *src, uint16_t len, uint8_t *dst, uint16_t dst_len);
+
+/*
+  reader of a compressed log file by offset in the uncompressed log.
+
+  The frames are walked through reading only their headers until the
+  one holding the offset. A sparse index of the frames is built on the
+  way, one entry per stride of uncompressed data, the stride doubling
+  each time the index fills up, so that seeking back resumes from a
+  nearby frame rather than from the start of the file.
+
+  The log goes on at the next valid frame after a damaged one, the bytes
+  lost with it reading as zeros so that the offsets still match the size
+  of the log. A damaged frame with none after it ends the log, as left
+  by a crash while writing it
+ */
+class LogFrameReader {
+public:
+    ~LogFrameReader();
+
+    // allocate the buffers, returning false if out of memory
+    bool init(void);
+
+    // start reading the compressed log open on fd
+    void reset(int fd);
+
+    /*
+      decompress the frame holding the byte at offset ofs of the
+      uncompressed log into raw, of size at least
+      LOG_COMPRESSED_FRAME_MAX. data is set to point at that byte.
+      Returns the number of bytes from there to the end of the frame, 0
+      at the end of the log or -1 on error
+     */
+    ssize_t read(uint32_t ofs, uint8_t *raw, const uint8_t *&data);
+
+private:
+    struct index_entry {
+        uint32_t raw_ofs;
+        uint32_t file_ofs;
+    };
+
+    void _seek(uint32_t ofs);
+    void _index_add(uint32_t raw_ofs, uint32_t file_ofs);
+    bool _frame_valid(uint32_t file_ofs);
+    bool _resync(void);
+
+    int _fd = -1;
+    uint8_t *_frame = nullptr;
+    struct index_entry *_index = nullptr;
+    uint16_t _index_count = 0;
+    uint32_t _index_stride = 0;
+
+    uint32_t _file_ofs = 0;     // file offset of the next frame
+    uint32_t _raw_ofs = 0;      // offset in the uncompressed log of the next frame
+    bool _resynced = false;     // the next frame was found past a damaged one
+
+    // last frame walked through, only its header was checked when
+    // skipping it: the next valid frame is looked for from there
+    struct index_entry _last {};
+};
+
+// true if the log open on fd was written compressed
+bool log_file_compressed(int fd);
+
+/*
+  uncompressed size of the compressed log open on fd, of file_size
+  bytes, from the last complete frame near the end of the file. Returns
+  0 if there is none
+ */
+uint32_t log_file_raw_size(int fd, uint32_t file_size);
@@ -592,6 +592,18 @@ struct PACKED log_GPS_RAWS {
     uint8_t trkStat;
 };
 
+// chunk of the raw data stream received from a GPS, for post processing.
+// The bytes are held in integer fields, as tools cut char fields at the
+// first nul: byte n of the chunk is byte n%8 of field n/8, little endian
+struct PACKED log_GPS_RAWD {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t instance;
+    uint16_t seq;
+    uint8_t len;
+    uint64_t data[8];
+};
+
 struct PACKED log_GPS_SBF_EVENT {  
 	LOG_PACKET_HEADER; 
 	uint64_t time_us;
@@ -891,6 +903,8 @@ Format characters in the format string for binary log messages
       "GRXH", "QdHbBB", "TimeUS,rcvTime,week,leapS,numMeas,recStat" }, \
     { LOG_GPS_RAWS_MSG, sizeof(log_GPS_RAWS), \
       "GRXS", "QddfBBBHBBBBB", "TimeUS,prMes,cpMes,doMes,gnss,sv,freq,lock,cno,prD,cpD,doD,trk" }, \
+    { LOG_GPS_RAWD_MSG, sizeof(log_GPS_RAWD), \
+      "GRWD", "QBHBQQQQQQQQ", "TimeUS,I,Seq,Len,D0,D1,D2,D3,D4,D5,D6,D7" }, \
     { LOG_GPS_SBF_EVENT_MSG, sizeof(log_GPS_SBF_EVENT), \
       "SBFE", "QIHBBdddfffff", "TimeUS,TOW,WN,Mode,Err,Lat,Lng,Height,Undul,Vn,Ve,Vu,COG" }, \
     { LOG_ESC1_MSG, sizeof(log_Esc), \
@@ -1082,6 +1096,7 @@ enum LogMessages {
     LOG_GIMBAL3_MSG,
     LOG_RATE_MSG,
     LOG_RALLY_MSG,
+    LOG_GPS_RAWD_MSG,
 };
 
 enum LogOriginType {
@@ -0,0 +1,146 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gbenchmark.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <AP_Math/AP_Math.h>
+#include <DataFlash/LogCompression.h>
+
+#define LOG_SIZE (256 * 1024)
+
+/*
+ * A log of two IMUs and the attitude at 400Hz, with sensor noise in the
+ * low bits of the readings as in real logs
+ */
+struct log_input {
+    uint8_t raw[LOG_SIZE];
+    uint32_t len = 0;
+
+    template <typename T>
+    void add(const T &pkt)
+    {
+        if (len + sizeof(pkt) <= LOG_SIZE) {
+            memcpy(&raw[len], &pkt, sizeof(pkt));
+            len += sizeof(pkt);
+        }
+    }
+
+    log_input()
+    {
+        uint32_t seed = 1;
+        uint64_t time_us = 0;
+        while (len < LOG_SIZE - 128) {
+            time_us += 2500;
+            const float t = time_us * 1.0e-6f;
+
+            for (uint8_t i = 0; i < 2; i++) {
+                struct log_IMU imu {};
+                imu.head1 = HEAD_BYTE1;
+                imu.head2 = HEAD_BYTE2;
+                imu.msgid = i == 0 ? LOG_IMU_MSG : LOG_IMU2_MSG;
+                imu.time_us = time_us;
+                seed = seed * 1103515245 + 12345;
+                const float noise = ((seed >> 16) & 0xFF) * 1.0e-4f;
+                imu.gyro_x = 0.1f * sinf(t) + noise;
+                imu.gyro_y = 0.1f * cosf(t) - noise;
+                imu.gyro_z = 0.01f + noise;
+                imu.accel_x = 0.5f * sinf(t) + 10 * noise;
+                imu.accel_y = 0.5f * cosf(t) - 10 * noise;
+                imu.accel_z = -9.8f + 10 * noise;
+                imu.temperature = 45.0f;
+                imu.gyro_health = 1;
+                imu.accel_health = 1;
+                add(imu);
+            }
+
+            struct log_Attitude att {};
+            att.head1 = HEAD_BYTE1;
+            att.head2 = HEAD_BYTE2;
+            att.msgid = LOG_ATTITUDE_MSG;
+            att.time_us = time_us;
+            att.roll = 500 * sinf(t);
+            att.control_roll = att.roll + 10;
+            att.pitch = 500 * cosf(t);
+            att.control_pitch = att.pitch - 10;
+            att.yaw = 9000;
+            att.control_yaw = 9000;
+            add(att);
+        }
+    }
+};
+
+static const log_input input;
+
+static void set_ratio_label(benchmark::State& state, uint32_t compressed_len)
+{
+    char label[32];
+    snprintf(label, sizeof(label), "ratio %.2f", input.len / (float)compressed_len);
+    state.SetLabel(label);
+}
+
+static void BM_LogCompress(benchmark::State& state)
+{
+    LogCompressor compressor;
+    uint8_t frame[LOG_COMPRESSED_FRAME_SIZE_MAX];
+    uint32_t compressed_len = 0;
+
+    while (state.KeepRunning()) {
+        compressed_len = 0;
+        for (uint32_t ofs = 0; ofs < input.len; ofs += LOG_COMPRESSED_FRAME_MAX) {
+            const uint16_t len = MIN(input.len - ofs, (uint32_t)LOG_COMPRESSED_FRAME_MAX);
+            compressed_len += compressor.compress_frame(&input.raw[ofs], len, ofs, frame);
+            gbenchmark_escape(frame);
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * input.len);
+    set_ratio_label(state, compressed_len);
+}
+
+static void BM_LogDecompress(benchmark::State& state)
+{
+    static LogCompressor compressor;
+    static uint8_t frames[LOG_SIZE + LOG_SIZE / LOG_COMPRESSED_FRAME_MAX * sizeof(struct log_compressed_frame) + LOG_COMPRESSED_FRAME_SIZE_MAX];
+    uint16_t frame_len[LOG_SIZE / LOG_COMPRESSED_FRAME_MAX + 1];
+    uint16_t num_frames = 0;
+    uint32_t compressed_len = 0;
+
+    for (uint32_t ofs = 0; ofs < input.len; ofs += LOG_COMPRESSED_FRAME_MAX) {
+        const uint16_t len = MIN(input.len - ofs, (uint32_t)LOG_COMPRESSED_FRAME_MAX);
+        frame_len[num_frames] = compressor.compress_frame(&input.raw[ofs], len, ofs, &frames[compressed_len]);
+        compressed_len += frame_len[num_frames++];
+    }
+
+    uint8_t raw[LOG_COMPRESSED_FRAME_MAX];
+    while (state.KeepRunning()) {
+        const uint8_t *frame = frames;
+        for (uint16_t i = 0; i < num_frames; i++) {
+            int16_t ret = log_decompress_frame(frame, frame_len[i], raw);
+            gbenchmark_escape(&ret);
+            gbenchmark_escape(raw);
+            frame += frame_len[i];
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * input.len);
+    set_ratio_label(state, compressed_len);
+}
+
+BENCHMARK(BM_LogCompress);
+BENCHMARK(BM_LogDecompress);
+
+BENCHMARK_MAIN()
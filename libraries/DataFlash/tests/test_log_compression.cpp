@@ -0,0 +1,298 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <AP_Math/AP_Math.h>
+#include <DataFlash/LogCompression.h>
+
+static LogCompressor compressor;
+
+// a buffer of IMU messages with slowly changing values
+static void fill_log(uint8_t *buf, uint16_t len)
+{
+    struct log_IMU pkt {};
+    pkt.head1 = HEAD_BYTE1;
+    pkt.head2 = HEAD_BYTE2;
+    pkt.msgid = 1;
+    for (uint16_t i = 0; i < len; i += sizeof(pkt)) {
+        pkt.time_us += 2500;
+        pkt.gyro_x = 0.01f * (i % 17);
+        pkt.accel_z = -9.8f + 0.001f * (i % 5);
+        memcpy(&buf[i], &pkt, MIN(sizeof(pkt), (size_t)(len - i)));
+    }
+}
+
+// a buffer which doesn't compress
+static void fill_random(uint8_t *buf, uint16_t len)
+{
+    uint32_t x = 0x12345678;
+    for (uint16_t i = 0; i < len; i++) {
+        x = x * 1103515245 + 12345;
+        buf[i] = x >> 24;
+    }
+}
+
+static void check_round_trip(const uint8_t *raw, uint16_t len)
+{
+    uint8_t frame[LOG_COMPRESSED_FRAME_SIZE_MAX];
+    uint8_t out[LOG_COMPRESSED_FRAME_MAX];
+
+    const uint16_t frame_len = compressor.compress_frame(raw, len, 1234, frame);
+    EXPECT_LE(frame_len, LOG_COMPRESSED_FRAME_SIZE_MAX);
+
+    struct log_compressed_frame hdr;
+    memcpy(&hdr, frame, sizeof(hdr));
+    EXPECT_TRUE(log_frame_header_valid(hdr));
+    EXPECT_EQ(len, hdr.raw_len);
+    EXPECT_EQ(1234U, hdr.raw_ofs);
+
+    EXPECT_EQ(len, log_decompress_frame(frame, frame_len, out));
+    EXPECT_EQ(0, memcmp(raw, out, len));
+}
+
+TEST(LogCompression, round_trip)
+{
+    uint8_t raw[LOG_COMPRESSED_FRAME_MAX];
+
+    fill_log(raw, sizeof(raw));
+    for (uint16_t len : {0, 1, 4, 15, 100, 1000, 4096}) {
+        check_round_trip(raw, len);
+    }
+
+    fill_random(raw, sizeof(raw));
+    for (uint16_t len : {0, 1, 4, 15, 100, 1000, 4096}) {
+        check_round_trip(raw, len);
+    }
+
+    // long runs need extended lengths
+    memset(raw, 0, sizeof(raw));
+    check_round_trip(raw, sizeof(raw));
+}
+
+TEST(LogCompression, ratio)
+{
+    uint8_t raw[LOG_COMPRESSED_FRAME_MAX];
+    uint8_t frame[LOG_COMPRESSED_FRAME_SIZE_MAX];
+
+    fill_log(raw, sizeof(raw));
+    EXPECT_LT(compressor.compress_frame(raw, sizeof(raw), 0, frame), sizeof(raw) / 2);
+
+    // incompressible data is stored with only the header added
+    fill_random(raw, sizeof(raw));
+    EXPECT_EQ(sizeof(raw) + sizeof(struct log_compressed_frame),
+              compressor.compress_frame(raw, sizeof(raw), 0, frame));
+}
+
+TEST(LogCompression, corrupt)
+{
+    uint8_t raw[LOG_COMPRESSED_FRAME_MAX];
+    uint8_t frame[LOG_COMPRESSED_FRAME_SIZE_MAX];
+    uint8_t out[LOG_COMPRESSED_FRAME_MAX];
+
+    fill_log(raw, sizeof(raw));
+    const uint16_t frame_len = compressor.compress_frame(raw, sizeof(raw), 0, frame);
+
+    // a frame cut short by a crash
+    EXPECT_EQ(-1, log_decompress_frame(frame, frame_len - 1, out));
+    EXPECT_EQ(-1, log_decompress_frame(frame, 4, out));
+
+    // a damaged frame
+    frame[frame_len / 2] ^= 0x10;
+    EXPECT_EQ(-1, log_decompress_frame(frame, frame_len, out));
+
+    // damaged data never writes past the output
+    for (uint16_t i = 0; i < 1000; i++) {
+        fill_random(frame, sizeof(frame));
+        frame[i % 64] = i;
+        EXPECT_GE(100, log_decompress(frame, 64 + i, out, 100));
+    }
+}
+
+/*
+  a compressed log of frames of frame_raw bytes each, in a temporary file
+ */
+class TestLog {
+public:
+    TestLog(uint16_t nframes, uint16_t frame_raw)
+        : raw(nframes * frame_raw)
+    {
+        file = tmpfile();
+        fd = fileno(file);
+        fill_log(raw.data(), raw.size());
+
+        uint8_t frame[LOG_COMPRESSED_FRAME_SIZE_MAX];
+        for (uint32_t ofs = 0; ofs < raw.size(); ofs += frame_raw) {
+            const uint16_t len = compressor.compress_frame(&raw[ofs], frame_raw, ofs, frame);
+            frame_ofs.push_back(size);
+            EXPECT_EQ(len, pwrite(fd, frame, len, size));
+            size += len;
+        }
+    }
+
+    ~TestLog()
+    {
+        fclose(file);
+    }
+
+    // flip a byte of the file
+    void damage(uint32_t ofs)
+    {
+        uint8_t b;
+        EXPECT_EQ(1, pread(fd, &b, 1, ofs));
+        b ^= 0x55;
+        EXPECT_EQ(1, pwrite(fd, &b, 1, ofs));
+    }
+
+    void truncate(uint32_t len)
+    {
+        EXPECT_EQ(0, ftruncate(fd, len));
+        size = len;
+    }
+
+    // read the uncompressed log from ofs to its end
+    std::vector<uint8_t> read(LogFrameReader &reader, uint32_t ofs) const
+    {
+        std::vector<uint8_t> out;
+        uint8_t buf[LOG_COMPRESSED_FRAME_MAX];
+        const uint8_t *data;
+        ssize_t n;
+        while ((n = reader.read(ofs, buf, data)) > 0) {
+            out.insert(out.end(), data, data + n);
+            ofs += n;
+        }
+        EXPECT_EQ(0, n);
+        return out;
+    }
+
+    FILE *file;
+    int fd;
+    std::vector<uint8_t> raw;
+    std::vector<uint32_t> frame_ofs;
+    uint32_t size = 0;
+};
+
+TEST(LogFrameReader, read)
+{
+    TestLog log(10, 1000);
+    LogFrameReader reader;
+    ASSERT_TRUE(reader.init());
+    EXPECT_TRUE(log_file_compressed(log.fd));
+
+    reader.reset(log.fd);
+    EXPECT_EQ(log.raw, log.read(reader, 0));
+    EXPECT_EQ(std::vector<uint8_t>(log.raw.begin() + 4321, log.raw.end()), log.read(reader, 4321));
+}
+
+/*
+  the log goes on after a damaged frame, its bytes reading as zeros
+ */
+TEST(LogFrameReader, resync)
+{
+    TestLog log(10, 1000);
+    LogFrameReader reader;
+    ASSERT_TRUE(reader.init());
+
+    // damaged data in frame 3, a damaged header in frame 6
+    log.damage(log.frame_ofs[3] + 100);
+    log.damage(log.frame_ofs[6]);
+
+    std::vector<uint8_t> expected = log.raw;
+    std::fill(&expected[3000], &expected[4000], 0);
+    std::fill(&expected[6000], &expected[7000], 0);
+
+    reader.reset(log.fd);
+    EXPECT_EQ(expected, log.read(reader, 0));
+
+    // also when starting within or just before a damaged frame
+    reader.reset(log.fd);
+    EXPECT_EQ(std::vector<uint8_t>(expected.begin() + 3500, expected.end()), log.read(reader, 3500));
+    reader.reset(log.fd);
+    EXPECT_EQ(std::vector<uint8_t>(expected.begin() + 5999, expected.end()), log.read(reader, 5999));
+}
+
+/*
+  a log cut short ends at its last complete frame
+ */
+TEST(LogFrameReader, truncated)
+{
+    TestLog log(10, 1000);
+    LogFrameReader reader;
+    ASSERT_TRUE(reader.init());
+
+    log.truncate(log.frame_ofs[9] + 20);
+    reader.reset(log.fd);
+    EXPECT_EQ(std::vector<uint8_t>(log.raw.begin(), log.raw.begin() + 9000), log.read(reader, 0));
+
+    // and also when the frame before the cut is damaged
+    log.damage(log.frame_ofs[8] + 50);
+    reader.reset(log.fd);
+    EXPECT_EQ(std::vector<uint8_t>(log.raw.begin(), log.raw.begin() + 8000), log.read(reader, 0));
+}
+
+/*
+  seeking back into an earlier frame, past the indexed frames
+ */
+TEST(LogFrameReader, seek_back)
+{
+    TestLog log(200, LOG_COMPRESSED_FRAME_MAX);
+    LogFrameReader reader;
+    ASSERT_TRUE(reader.init());
+
+    reader.reset(log.fd);
+    EXPECT_EQ(log.raw, log.read(reader, 0));
+
+    uint8_t buf[LOG_COMPRESSED_FRAME_MAX];
+    const uint8_t *data;
+    for (uint32_t ofs : {150U * LOG_COMPRESSED_FRAME_MAX + 7, 3U, 17U * LOG_COMPRESSED_FRAME_MAX, 100000U, 2U}) {
+        const ssize_t n = reader.read(ofs, buf, data);
+        ASSERT_EQ(LOG_COMPRESSED_FRAME_MAX - ofs % LOG_COMPRESSED_FRAME_MAX, (uint32_t)n);
+        EXPECT_EQ(0, memcmp(&log.raw[ofs], data, n));
+    }
+
+    // back into an earlier frame after a damaged one
+    log.damage(log.frame_ofs[50] + 200);
+    reader.reset(log.fd);
+    EXPECT_EQ(log.raw.size(), log.read(reader, 0).size());
+    const ssize_t n = reader.read(49 * LOG_COMPRESSED_FRAME_MAX, buf, data);
+    ASSERT_EQ(LOG_COMPRESSED_FRAME_MAX, n);
+    EXPECT_EQ(0, memcmp(&log.raw[49 * LOG_COMPRESSED_FRAME_MAX], data, n));
+}
+
+/*
+  the reported size of a compressed log is its uncompressed size, up to
+  its last complete frame
+ */
+TEST(LogFrameReader, raw_size)
+{
+    TestLog log(10, 1000);
+    EXPECT_EQ(10000U, log_file_raw_size(log.fd, log.size));
+
+    log.truncate(log.size - 1);
+    EXPECT_EQ(9000U, log_file_raw_size(log.fd, log.size));
+
+    log.truncate(log.frame_ofs[1]);
+    EXPECT_EQ(1000U, log_file_raw_size(log.fd, log.size));
+
+    log.truncate(5);
+    EXPECT_EQ(0U, log_file_raw_size(log.fd, log.size));
+}
+
+AP_GTEST_MAIN()
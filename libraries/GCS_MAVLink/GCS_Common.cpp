@@ -1665,6 +1665,28 @@ void GCS_MAVLINK::send_home_all(const Location &home)
     }
 }
 
+/*
+  send a NAMED_VALUE_INT on all active channels. The name is truncated
+  to the 10 characters the message has room for
+ */
+void GCS_MAVLINK::send_named_value_int_all(const char *name, int32_t value)
+{
+    char short_name[10] {};
+    strncpy(short_name, name, sizeof(short_name));
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((1U<<i) & mavlink_active) {
+            mavlink_channel_t chan = (mavlink_channel_t)(MAVLINK_COMM_0+i);
+            if (HAVE_PAYLOAD_SPACE(chan, NAMED_VALUE_INT)) {
+                mavlink_msg_named_value_int_send(
+                    chan,
+                    AP_HAL::millis(),
+                    short_name,
+                    value);
+            }
+        }
+    }
+}
+
 /*
   wrapper for sending heartbeat
  */
@@ -56,6 +56,7 @@ void GCS_MAVLINK::handle_log_request_list(mavlink_message_t *msg, DataFlash_Clas
 
     _log_listing = false;
     _log_sending = false;
+    _log_num_data = 0;
 
     _log_num_logs = dataflash.get_num_logs();
     if (_log_num_logs == 0) {
@@ -87,8 +88,9 @@ void GCS_MAVLINK::handle_log_request_data(mavlink_message_t *msg, DataFlash_Clas
     mavlink_msg_log_request_data_decode(msg, &packet);
 
     _log_listing = false;
-    if (!_log_sending || _log_num_data != packet.id) {
+    if (_log_num_data != packet.id) {
         _log_sending = false;
+        _log_num_data = 0;
 
         uint16_t num_logs = dataflash.get_num_logs();
         if (packet.id > num_logs || packet.id < 1) {
@@ -98,21 +100,15 @@ void GCS_MAVLINK::handle_log_request_data(mavlink_message_t *msg, DataFlash_Clas
         uint32_t time_utc, size;
         dataflash.get_log_info(packet.id, size, time_utc);
         _log_num_data = packet.id;
-        _log_data_size = size;
+        _log_window.open(size);
 
         uint16_t end;
         dataflash.get_log_boundaries(packet.id, _log_data_page, end);
     }
 
-    _log_data_offset = packet.ofs;
-    if (_log_data_offset >= _log_data_size) {
-        _log_data_remaining = 0;
-    } else {
-        _log_data_remaining = _log_data_size - _log_data_offset;
-    }
-    if (_log_data_remaining > packet.count) {
-        _log_data_remaining = packet.count;
-    }
+    // requests for data already sent are gaps the GCS has seen, which
+    // are resent while the rest of the log keeps streaming
+    _log_window.request(packet.ofs, packet.count, AP_HAL::millis());
     _log_sending = true;
 
     handle_log_send(dataflash);
@@ -126,6 +122,8 @@ void GCS_MAVLINK::handle_log_request_erase(mavlink_message_t *msg, DataFlash_Cla
     mavlink_log_erase_t packet;
     mavlink_msg_log_erase_decode(msg, &packet);
 
+    _log_sending = false;
+    _log_num_data = 0;
     dataflash.EraseAll();
 }
 
@@ -137,6 +135,7 @@ void GCS_MAVLINK::handle_log_request_end(mavlink_message_t *msg, DataFlash_Class
     mavlink_log_request_end_t packet;
     mavlink_msg_log_request_end_decode(msg, &packet);
     _log_sending = false;
+    _log_num_data = 0;
 }
 
 /**
@@ -151,24 +150,24 @@ void GCS_MAVLINK::handle_log_send(DataFlash_Class &dataflash)
         return;
     }
 
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-    // assume USB speeds in SITL for the purposes of log download
-    const uint8_t num_sends = 40;
-#else
-    uint8_t num_sends = 1;
-    if (chan == MAVLINK_COMM_0 && hal.gpio->usb_connected()) {
-        // when on USB we can send a lot more data
-        num_sends = 250;
-    } else if (have_flow_control()) {
-    #if CONFIG_HAL_BOARD == HAL_BOARD_LINUX
-        num_sends = 80;
-    #else
-        num_sends = 10;
-    #endif
+    // send as many blocks as fit in the space now free in the link's
+    // transmit buffer, so the rate follows the link as it drains it
+    uint16_t num_sends = comm_get_txspace(chan) / (packet_overhead() + MAVLINK_MSG_ID_LOG_DATA_LEN);
+#if CONFIG_HAL_BOARD != HAL_BOARD_SITL
+    if (!have_flow_control() && !(chan == MAVLINK_COMM_0 && hal.gpio->usb_connected())) {
+        // a radio without flow control may not keep up with its serial
+        // port, e.g. at 57600: one block per call, as before
+        num_sends = MIN(num_sends, 1);
     }
 #endif
 
-    for (uint8_t i=0; i<num_sends; i++) {
+    // the window grows up to the most the link took in one call, and
+    // shrinks when the GCS reports loss
+    if (num_sends > _log_window.max_window()) {
+        _log_window.set_max_window(num_sends);
+    }
+    const uint16_t window = MIN(_log_window.window(), num_sends);
+    for (uint16_t i=0; i<window; i++) {
         if (_log_sending) {
             if (!handle_log_send_data(dataflash)) break;
         }
@@ -219,13 +218,18 @@ bool GCS_MAVLINK::handle_log_send_data(DataFlash_Class &dataflash)
     }
 
     int16_t ret = 0;
-    uint32_t len = _log_data_remaining;
+    uint32_t ofs, len;
 	mavlink_log_data_t packet;
 
-    if (len > 90) {
-        len = 90;
+    if (!_log_window.next_block(90, ofs, len)) {
+        _log_sending = false;
+        return false;
+    }
+    ret = dataflash.get_log_data(_log_num_data, _log_data_page, ofs, len, packet.data);
+    if (ret == DATAFLASH_LOG_DATA_PENDING) {
+        // not read from the card yet, try again on the next call
+        return false;
     }
-    ret = dataflash.get_log_data(_log_num_data, _log_data_page, _log_data_offset, len, packet.data);
     if (ret < 0) {
         // report as EOF on error
         ret = 0;
@@ -234,7 +238,7 @@ bool GCS_MAVLINK::handle_log_send_data(DataFlash_Class &dataflash)
         memset(&packet.data[ret], 0, 90-ret);
     }
 
-    packet.ofs = _log_data_offset;
+    packet.ofs = ofs;
     packet.id = _log_num_data;
     packet.count = ret;
     _mav_finalize_message_chan_send(chan, MAVLINK_MSG_ID_LOG_DATA, (const char *)&packet, 
@@ -242,9 +246,8 @@ bool GCS_MAVLINK::handle_log_send_data(DataFlash_Class &dataflash)
                                     MAVLINK_MSG_ID_LOG_DATA_LEN,
                                     MAVLINK_MSG_ID_LOG_DATA_CRC);
 
-    _log_data_offset += len;
-    _log_data_remaining -= len;
-    if (ret < 90 || _log_data_remaining == 0) {
+    _log_window.block_sent(len, ret);
+    if (!_log_window.active()) {
         _log_sending = false;
     }
     return true;
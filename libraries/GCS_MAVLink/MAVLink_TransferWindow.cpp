@@ -0,0 +1,175 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/// @file	MAVLink_TransferWindow.cpp
+/// @brief	windowed sending of a file to the GCS in blocks
+
+#include "MAVLink_TransferWindow.h"
+
+void MAVLink_TransferWindow::open(uint32_t size)
+{
+    _size = size;
+    _stream_ofs = 0;
+    _stream_remaining = 0;
+    _streaming = false;
+    _num_gaps = 0;
+    _window = _max_window;
+    _sent_since_increase = 0;
+    _had_loss = false;
+}
+
+void MAVLink_TransferWindow::stop(void)
+{
+    _streaming = false;
+    _num_gaps = 0;
+}
+
+void MAVLink_TransferWindow::set_max_window(uint16_t max_window)
+{
+    if (max_window < 1) {
+        max_window = 1;
+    }
+    _max_window = max_window;
+    if (_window > _max_window) {
+        _window = _max_window;
+    }
+}
+
+void MAVLink_TransferWindow::request(uint32_t ofs, uint32_t count, uint32_t now_ms)
+{
+    // clamp the request to the file
+    uint32_t end = _size;
+    if (ofs < _size && count < _size - ofs) {
+        end = ofs + count;
+    }
+    const uint32_t len = end > ofs ? end - ofs : 0;
+
+    if (ofs == 0 && end >= _stream_ofs) {
+        // the GCS started the download over rather than asking for a
+        // gap: that's not loss, start again with the full window
+        _num_gaps = 0;
+        _window = _max_window;
+        _sent_since_increase = 0;
+        _had_loss = false;
+        _stream_ofs = 0;
+        _stream_remaining = len;
+        _streaming = true;
+        return;
+    }
+
+    if (ofs >= _stream_ofs || (!_streaming && end > _stream_ofs)) {
+        // (re)start the stream. Gaps already queued are still wanted
+        _stream_ofs = ofs;
+        _stream_remaining = len;
+        _streaming = true;
+        return;
+    }
+
+    handle_loss(now_ms);
+
+    if (end > _stream_ofs) {
+        // the stream sends the part of the request ahead of it
+        if (end - _stream_ofs > _stream_remaining) {
+            _stream_remaining = end - _stream_ofs;
+        }
+        end = _stream_ofs;
+    }
+    add_gap(ofs, end > ofs ? end - ofs : 0);
+}
+
+bool MAVLink_TransferWindow::next_block(uint32_t block_size, uint32_t &ofs, uint32_t &len) const
+{
+    if (_num_gaps > 0) {
+        ofs = _gaps[0].ofs;
+        len = _gaps[0].len;
+    } else if (_streaming) {
+        ofs = _stream_ofs;
+        len = _stream_remaining;
+    } else {
+        return false;
+    }
+    if (len > block_size) {
+        len = block_size;
+    }
+    return true;
+}
+
+void MAVLink_TransferWindow::block_sent(uint32_t len, uint32_t ret)
+{
+    if (_num_gaps > 0) {
+        struct gap &g = _gaps[0];
+        g.ofs += len;
+        g.len -= len;
+        if (ret < len || g.len == 0) {
+            remove_gap();
+        }
+    } else if (_streaming) {
+        _stream_ofs += len;
+        _stream_remaining -= len;
+        if (ret < len || _stream_remaining == 0) {
+            _streaming = false;
+        }
+    } else {
+        return;
+    }
+
+    // grow the window by a block for each window sent without loss
+    if (++_sent_since_increase >= _window) {
+        _sent_since_increase = 0;
+        if (_window < _max_window) {
+            _window++;
+        }
+    }
+}
+
+void MAVLink_TransferWindow::add_gap(uint32_t ofs, uint32_t len)
+{
+    for (uint8_t i = 0; i < _num_gaps; i++) {
+        const struct gap &g = _gaps[i];
+        if (ofs >= g.ofs && ofs - g.ofs + len <= g.len) {
+            // already queued
+            return;
+        }
+    }
+    if (_num_gaps == MAVLINK_TRANSFER_MAX_GAPS) {
+        // the GCS will ask again
+        return;
+    }
+    _gaps[_num_gaps].ofs = ofs;
+    _gaps[_num_gaps].len = len;
+    _num_gaps++;
+}
+
+void MAVLink_TransferWindow::remove_gap(void)
+{
+    for (uint8_t i = 1; i < _num_gaps; i++) {
+        _gaps[i - 1] = _gaps[i];
+    }
+    _num_gaps--;
+}
+
+void MAVLink_TransferWindow::handle_loss(uint32_t now_ms)
+{
+    _sent_since_increase = 0;
+    if (_had_loss && now_ms - _last_loss_ms < MAVLINK_TRANSFER_LOSS_HOLDOFF_MS) {
+        return;
+    }
+    _had_loss = true;
+    _last_loss_ms = now_ms;
+    _window /= 2;
+    if (_window < 1) {
+        _window = 1;
+    }
+}
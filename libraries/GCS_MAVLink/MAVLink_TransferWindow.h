@@ -0,0 +1,98 @@
+/// @file	MAVLink_TransferWindow.h
+/// @brief	windowed sending of a file to the GCS in blocks
+#pragma once
+
+#include <stdint.h>
+
+// number of gaps which can be waiting to be resent. The GCS asks again
+// for gaps which are dropped when this is full
+#define MAVLINK_TRANSFER_MAX_GAPS 8
+
+// time after a loss during which further losses don't shrink the window
+// again, as the GCS will report a burst of gaps for a single loss event
+#define MAVLINK_TRANSFER_LOSS_HOLDOFF_MS 500
+
+/*
+  object to track the sending of a file to the GCS as a stream of
+  blocks, with the GCS asking again for any gaps it sees.
+
+  Gaps are resent without disturbing the stream, and the number of
+  blocks sent per update is adapted to loss: it halves on each loss
+  event and grows by one block for each window of blocks sent. This
+  holds no MAVLink state so it can be used for any block transport
+ */
+class MAVLink_TransferWindow
+{
+public:
+    MAVLink_TransferWindow(void) {}
+
+    // start on a new file of size bytes, with nothing to send yet
+    void open(uint32_t size);
+
+    // stop sending, keeping the file and window size
+    void stop(void);
+
+    // set the upper limit on blocks per update for the link in use
+    void set_max_window(uint16_t max_window);
+    uint16_t max_window(void) const { return _max_window; }
+
+    /*
+      handle a request from the GCS for count bytes from ofs. A request
+      from the start of the file up to at least the stream position
+      starts the download over with the full window. Other requests
+      behind the stream position are gaps, which are queued to be
+      resent and taken as a sign of loss. Any other request restarts
+      the stream at ofs
+     */
+    void request(uint32_t ofs, uint32_t count, uint32_t now_ms);
+
+    // true while there is anything left to send
+    bool active(void) const { return _streaming || _num_gaps > 0; }
+
+    // number of blocks which may be sent on this update
+    uint16_t window(void) const { return _window; }
+
+    /*
+      get the offset and length of the next block to send, up to
+      block_size bytes. Gaps are sent before the stream. Returns false
+      when there is nothing left to send
+     */
+    bool next_block(uint32_t block_size, uint32_t &ofs, uint32_t &len) const;
+
+    /*
+      mark the block from next_block() as sent, with ret bytes
+      read. A short read means the end of the file was reached
+     */
+    void block_sent(uint32_t len, uint32_t ret);
+
+    // stream position and size of the file
+    uint32_t stream_offset(void) const { return _stream_ofs; }
+    uint32_t size(void) const { return _size; }
+
+private:
+    uint32_t _size;
+
+    // next offset and bytes left of the stream. The stream is kept
+    // going until its last block is sent, which may be empty to tell
+    // the GCS it asked for data past the end of the file
+    uint32_t _stream_ofs;
+    uint32_t _stream_remaining;
+    bool _streaming;
+
+    // gaps waiting to be resent, oldest first
+    struct gap {
+        uint32_t ofs;
+        uint32_t len;
+    } _gaps[MAVLINK_TRANSFER_MAX_GAPS];
+    uint8_t _num_gaps;
+
+    uint16_t _window = 1;
+    uint16_t _max_window = 1;
+    uint16_t _sent_since_increase;
+    uint32_t _last_loss_ms;
+    bool _had_loss;
+
+    void add_gap(uint32_t ofs, uint32_t len);
+    void remove_gap(void);
+    void handle_loss(uint32_t now_ms);
+};
@@ -0,0 +1,159 @@
+/*
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <AP_gtest.h>
+
+#include <GCS_MAVLink/MAVLink_TransferWindow.h>
+
+#define BLOCK_SIZE 90
+
+// send the next block of a file of size bytes, returning its offset
+static uint32_t send_block(MAVLink_TransferWindow &w, uint32_t size, uint32_t &len)
+{
+    uint32_t ofs;
+    EXPECT_TRUE(w.next_block(BLOCK_SIZE, ofs, len));
+    const uint32_t ret = ofs < size ? (size - ofs < len ? size - ofs : len) : 0;
+    w.block_sent(len, ret);
+    return ofs;
+}
+
+TEST(MAVLinkTransferWindow, stream)
+{
+    MAVLink_TransferWindow w;
+    w.set_max_window(10);
+    w.open(1000);
+    EXPECT_FALSE(w.active());
+
+    w.request(0, 0xFFFFFFFF, 0);
+    uint32_t expected_ofs = 0;
+    while (w.active()) {
+        uint32_t len;
+        EXPECT_EQ(expected_ofs, send_block(w, 1000, len));
+        expected_ofs += len;
+    }
+    EXPECT_EQ(1000U, expected_ofs);
+
+    uint32_t ofs, len;
+    EXPECT_FALSE(w.next_block(BLOCK_SIZE, ofs, len));
+}
+
+TEST(MAVLinkTransferWindow, past_end)
+{
+    MAVLink_TransferWindow w;
+    w.open(1000);
+
+    // the GCS gets an empty block for data past the end of the file
+    w.request(2000, 90, 0);
+    EXPECT_TRUE(w.active());
+    uint32_t len;
+    EXPECT_EQ(2000U, send_block(w, 1000, len));
+    EXPECT_EQ(0U, len);
+    EXPECT_FALSE(w.active());
+}
+
+TEST(MAVLinkTransferWindow, gaps)
+{
+    MAVLink_TransferWindow w;
+    w.set_max_window(16);
+    w.open(10000);
+    EXPECT_EQ(16, w.window());
+
+    w.request(0, 0xFFFFFFFF, 0);
+    uint32_t len;
+    for (uint8_t i = 0; i < 20; i++) {
+        send_block(w, 10000, len);
+    }
+    EXPECT_EQ(1800U, w.stream_offset());
+
+    // two gaps reported for the same loss only halve the window once
+    w.request(180, 90, 100);
+    w.request(540, 180, 101);
+    EXPECT_EQ(8, w.window());
+
+    // the gaps are resent first, then the stream carries on
+    EXPECT_EQ(180U, send_block(w, 10000, len));
+    EXPECT_EQ(540U, send_block(w, 10000, len));
+    EXPECT_EQ(630U, send_block(w, 10000, len));
+    EXPECT_EQ(1800U, send_block(w, 10000, len));
+
+    // a gap asked for twice is only resent once
+    w.request(900, 90, 200);
+    w.request(900, 90, 201);
+    EXPECT_EQ(900U, send_block(w, 10000, len));
+    EXPECT_EQ(1890U, send_block(w, 10000, len));
+
+    // a later loss halves the window again
+    w.request(90, 90, 1000);
+    EXPECT_EQ(4, w.window());
+}
+
+TEST(MAVLinkTransferWindow, window_growth)
+{
+    MAVLink_TransferWindow w;
+    w.set_max_window(8);
+    w.open(100000);
+
+    w.request(0, 0xFFFFFFFF, 0);
+    uint32_t len;
+    for (uint8_t i = 0; i < 10; i++) {
+        send_block(w, 100000, len);
+    }
+    w.request(0, 90, 0);
+    EXPECT_EQ(4, w.window());
+
+    // one block is added per window sent without loss
+    uint8_t sent = 0;
+    while (w.window() < 8) {
+        send_block(w, 100000, len);
+        sent++;
+    }
+    EXPECT_EQ(4 + 5 + 6 + 7, sent);
+
+    for (uint8_t i = 0; i < 100; i++) {
+        send_block(w, 100000, len);
+    }
+    EXPECT_EQ(8, w.window());
+
+    // a slower link lowers the limit
+    w.set_max_window(1);
+    EXPECT_EQ(1, w.window());
+}
+
+TEST(MAVLinkTransferWindow, restart)
+{
+    MAVLink_TransferWindow w;
+    w.set_max_window(16);
+    w.open(10000);
+
+    w.request(0, 0xFFFFFFFF, 0);
+    uint32_t len;
+    for (uint8_t i = 0; i < 20; i++) {
+        send_block(w, 10000, len);
+    }
+    w.request(180, 90, 100);
+    EXPECT_EQ(8, w.window());
+
+    // the GCS starting over isn't loss, and drops the queued gaps
+    w.request(0, 10000, 200);
+    EXPECT_EQ(16, w.window());
+    EXPECT_EQ(0U, send_block(w, 10000, len));
+    EXPECT_EQ(90U, send_block(w, 10000, len));
+    EXPECT_EQ(180U, w.stream_offset());
+
+    // and the next loss halves the full window
+    w.request(90, 90, 300);
+    EXPECT_EQ(8, w.window());
+}
+
+AP_GTEST_MAIN()